@@ -3,10 +3,105 @@
  */
 
 #include <erl_nif.h>
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
 #include <string.h>
 #include "ufbx.h"
+#include "ufbx_os.h"
 #include "ufbx_write.h"
 
+// SSE for the CPU skinning kernel, with a portable fallback
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define HAVE_SSE 1
+#endif
+
+// Atoms used as map keys, option names and tags. Interned once in `nif_load`
+// so building a map costs no atom-table lookups per element or keyframe.
+#define NIF_ATOMS(X) \
+    X(ok) X(error) X(true) X(false) X(not_found) \
+    X(dirty_schedulers) X(ascii) \
+    X(ignore_geometry) X(ignore_animation) X(ignore_embedded) \
+    X(mesh_format) X(packed) X(render) X(precision) \
+    X(type) X(components) X(stride) X(count) X(offset) X(f32) X(f64) X(u16) X(u32) \
+    X(version) X(nodes) X(meshes) X(materials) X(textures) X(animations) \
+    X(node_count) X(mesh_count) X(material_count) X(texture_count) X(anim_stack_count) \
+    X(id) X(name) X(parent_id) X(children) X(translation) X(rotation) X(scale) X(mesh_id) \
+    X(positions) X(indices) X(normals) X(texcoords) X(colors) X(tangents) X(vertices) \
+    X(material_ids) X(draw_ranges) X(layout) \
+    X(optimize) X(vertex_cache_size) X(cache_stats) X(cache_size) \
+    X(acmr_before) X(acmr_after) X(atvr_before) X(atvr_after) \
+    X(quantize) X(dequantize) X(encoding) X(linear) X(octahedral) X(bias) \
+    X(u8) X(snorm8) X(snorm16) X(unorm8) X(unorm16) \
+    X(lods) X(ratio) X(generate_tangents) X(mikktspace) \
+    X(generate_missing_normals) X(normalize_normals) X(normalize_tangents) \
+    X(subtrees) X(scene) X(subdivide) X(preview) \
+    X(nurbs_surfaces) X(nurbs_curves) X(nurbs_surface_id) X(nurbs_curve_id) \
+    X(span_subdivision) X(authored) \
+    X(skin) X(joints) X(inverse_bind_matrices) X(joint_indices) X(weights) X(max_influences) X(nil) \
+    X(first) X(last) X(step) \
+    X(blend_channels) X(shapes) X(weight) X(target_weight) \
+    X(vertex_indices) X(position_offsets) X(normal_offsets) \
+    X(frame_rate) X(texture_format) X(rgba16f) X(rgba32f) X(f16) X(width) X(height) \
+    X(normalize) X(min) X(max) \
+    X(load_external_files) X(cache_deformers) X(channel) X(interpretation) X(point_count) X(data) \
+    X(unknown) X(points) X(vertex_position) X(vertex_normal) X(ignore_transform) \
+    X(diffuse_color) X(specular_color) X(emissive_color) X(file_path) \
+    X(creation_time) X(year) X(month) X(day) X(hour) X(minute) X(second) X(microsecond) \
+    X(node_id) X(time) X(keyframes) \
+    X(animation_format) X(channels) X(times) \
+    X(anim_stacks) X(all) X(none) X(bake) \
+    X(trim_start_time) X(resample_rate) X(minimum_sample_rate) X(maximum_sample_rate) \
+    X(bake_transform_props) X(skip_node_transforms) X(no_resample_rotation) \
+    X(ignore_layer_weight_animation) X(max_keyframe_segments) \
+    X(step_handling) X(step_custom_duration) X(step_custom_epsilon) \
+    X(key_reduction_enabled) X(key_reduction_rotation) X(key_reduction_threshold) X(key_reduction_passes) \
+    X(default) X(custom_duration) X(identical_time) X(adjacent_double) X(ignore) \
+    X(thread_pool_size) X(thread_num_tasks) X(thread_memory_limit)
+
+#define DECLARE_ATOM(name) static ERL_NIF_TERM atom_##name;
+NIF_ATOMS(DECLARE_ATOM)
+#undef DECLARE_ATOM
+
+static void init_atoms(ErlNifEnv* env) {
+#define INIT_ATOM(name) atom_##name = enif_make_atom(env, #name);
+    NIF_ATOMS(INIT_ATOM)
+#undef INIT_ATOM
+}
+
+// Whether the heavy NIFs are rescheduled onto the dirty CPU scheduler pool.
+// Configured from the `load_info` map passed by `AriaFbx.Nif.load_nifs/0`.
+static int use_dirty_schedulers = 1;
+
+// Native thread pool shared by all loads, created in `nif_load` and sized from
+// `load_info` (one thread per dirty CPU scheduler by default). ufbx uses it to
+// inflate compressed arrays and parse ASCII arrays in parallel. NULL if disabled.
+static ufbx_os_thread_pool *thread_pool = NULL;
+static size_t thread_num_tasks = 0;     // `ufbx_thread_opts.num_tasks`, 0 = ufbx default
+static size_t thread_memory_limit = 0;  // `ufbx_thread_opts.memory_limit`, 0 = ufbx default
+
+// Helper: Run a NIF body on a dirty CPU scheduler (unless disabled at load time)
+static ERL_NIF_TERM schedule_dirty_cpu(ErlNifEnv* env, const char* name,
+                                       ERL_NIF_TERM (*fp)(ErlNifEnv*, int, const ERL_NIF_TERM[]),
+                                       int argc, const ERL_NIF_TERM argv[]) {
+    if (!use_dirty_schedulers) {
+        return fp(env, argc, argv);
+    }
+    return enif_schedule_nif(env, name, ERL_NIF_DIRTY_JOB_CPU_BOUND, fp, argc, argv);
+}
+
+// Helper: Run a NIF body that mostly waits on file reads on a dirty I/O scheduler
+static ERL_NIF_TERM schedule_dirty_io(ErlNifEnv* env, const char* name,
+                                      ERL_NIF_TERM (*fp)(ErlNifEnv*, int, const ERL_NIF_TERM[]),
+                                      int argc, const ERL_NIF_TERM argv[]) {
+    if (!use_dirty_schedulers) {
+        return fp(env, argc, argv);
+    }
+    return enif_schedule_nif(env, name, ERL_NIF_DIRTY_JOB_IO_BOUND, fp, argc, argv);
+}
+
 // Helper: Convert ufbx_vec3 to Elixir list [x, y, z]
 static ERL_NIF_TERM make_vec3(ErlNifEnv* env, ufbx_vec3 vec) {
     ERL_NIF_TERM x = enif_make_double(env, vec.x);
@@ -24,6 +119,16 @@ static ERL_NIF_TERM make_vec4(ErlNifEnv* env, ufbx_vec4 vec) {
     return enif_make_list4(env, x, y, z, w);
 }
 
+// Helper: Make {:error, reason} with a binary reason
+static ERL_NIF_TERM make_error(ErlNifEnv* env, const char *reason) {
+    ERL_NIF_TERM message;
+    size_t length = strlen(reason);
+    memcpy(enif_make_new_binary(env, length, &message), reason, length);
+    return enif_make_tuple2(env,
+        atom_error,
+        message);
+}
+
 // Helper: Convert ufbx_string to Elixir binary
 static ERL_NIF_TERM make_string(ErlNifEnv* env, ufbx_string str) {
     if (str.length == 0) {
@@ -32,7 +137,7 @@ static ERL_NIF_TERM make_string(ErlNifEnv* env, ufbx_string str) {
     // Allocate binary and copy string data
     ErlNifBinary bin;
     if (!enif_alloc_binary(str.length, &bin)) {
-        return enif_make_atom(env, "error");
+        return atom_error;
     }
     memcpy(bin.data, str.data, str.length);
     ERL_NIF_TERM result = enif_make_binary(env, &bin);
@@ -49,6 +154,17 @@ static ERL_NIF_TERM make_vec3_list(ErlNifEnv* env, ufbx_vec3_list list) {
     return result;
 }
 
+// Helper: Build a map from parallel key/value arrays. Every caller passes
+// distinct atom keys, so a duplicate is a bug here; results are nested in
+// other terms, where a badarg exception term would be invalid.
+static ERL_NIF_TERM make_map(ErlNifEnv* env, ERL_NIF_TERM keys[], ERL_NIF_TERM values[], size_t count) {
+    ERL_NIF_TERM map;
+    int unique = enif_make_map_from_arrays(env, keys, values, count, &map);
+    assert(unique && "make_map: duplicate keys");
+    (void)unique;
+    return map;
+}
+
 // Helper: Convert ufbx_uint32_list to Elixir list
 static ERL_NIF_TERM make_uint32_list(ErlNifEnv* env, ufbx_uint32_list list) {
     ERL_NIF_TERM result = enif_make_list(env, 0);
@@ -59,6 +175,401 @@ static ERL_NIF_TERM make_uint32_list(ErlNifEnv* env, ufbx_uint32_list list) {
     return result;
 }
 
+// Most render mesh LODs generated per mesh
+#define MAX_LODS 8
+
+// `extract_opts.subdivide` values using the mesh's authored levels
+#define SUBDIVIDE_PREVIEW SIZE_MAX
+#define SUBDIVIDE_RENDER (SIZE_MAX - 1)
+
+// Each level quadruples the faces, so requests are capped
+#define MAX_SUBDIVISION_LEVEL 5
+
+// `extract_opts.span_subdivision` value using the surface's authored rate
+#define SPAN_SUBDIVISION_AUTHORED SIZE_MAX
+
+// Segments per NURBS knot span are capped like subdivision levels
+#define MAX_SPAN_SUBDIVISION 64
+
+// Most joint influences kept per skinned vertex
+#define MAX_INFLUENCES 8
+
+// Most frames skinned in one batch, which also keeps vertex animation
+// textures within the row count GPUs commonly sample
+#define MAX_SKIN_FRAMES 16384
+
+// Options controlling how scene data is converted to Elixir terms
+typedef struct extract_opts {
+    int packed;     // Emit vertex data as little-endian binaries instead of nested lists
+    int render;     // Emit triangulated meshes with one interleaved vertex buffer (implies binaries)
+    bool optimize;  // Reorder render meshes for the vertex cache and vertex fetch
+    size_t vertex_cache_size;  // Cache entries assumed by `optimize`
+    bool quantize;  // Pack render mesh vertices as normalized integers
+    bool generate_tangents;  // Compute MikkTSpace tangents for render meshes with UVs
+    size_t subdivide;  // Catmull-Clark levels, or `SUBDIVIDE_PREVIEW` / `SUBDIVIDE_RENDER`
+    size_t span_subdivision;  // NURBS segments per knot span, or `SPAN_SUBDIVISION_AUTHORED`
+    size_t max_influences;    // Joint influences kept per skinned vertex, at most `MAX_INFLUENCES`
+    double lod_ratios[MAX_LODS];  // Triangle ratios of render mesh LODs, decreasing
+    size_t num_lods;
+    int use_f32;    // Packed floats are f32 instead of f64
+    int channels;   // Emit animation as per-node channel binaries instead of keyframe maps
+    ERL_NIF_TERM anim_stacks;  // `:all`, `:none` or a list of stack names/indices to bake
+    ufbx_bake_opts bake;       // Options for `ufbx_bake_anim()`
+    void *owner;    // Resource owning the ufbx data, or NULL. When set, packed
+                    // attributes already in the requested layout alias ufbx memory
+} extract_opts;
+
+// Helper: Look up an option in a keyword list or map
+static int get_opt(ErlNifEnv* env, ERL_NIF_TERM opts, ERL_NIF_TERM key, ERL_NIF_TERM *out) {
+    if (enif_is_map(env, opts)) {
+        return enif_get_map_value(env, opts, key, out);
+    }
+    
+    ERL_NIF_TERM head, tail = opts;
+    while (enif_get_list_cell(env, tail, &head, &tail)) {
+        int arity;
+        const ERL_NIF_TERM *tuple;
+        if (enif_get_tuple(env, head, &arity, &tuple) && arity == 2 && enif_is_identical(tuple[0], key)) {
+            *out = tuple[1];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Helper: Get boolean option, leaving `out` untouched if missing
+static void get_opt_bool(ErlNifEnv* env, ERL_NIF_TERM opts, ERL_NIF_TERM key, bool *out) {
+    ERL_NIF_TERM value;
+    if (get_opt(env, opts, key, &value)) {
+        *out = enif_is_identical(value, atom_true);
+    }
+}
+
+// Helper: Get numeric option (integer or float), leaving `out` untouched if missing
+static void get_opt_double(ErlNifEnv* env, ERL_NIF_TERM opts, ERL_NIF_TERM key, double *out) {
+    ERL_NIF_TERM value;
+    if (get_opt(env, opts, key, &value)) {
+        ErlNifSInt64 integer;
+        if (!enif_get_double(env, value, out) && enif_get_int64(env, value, &integer)) {
+            *out = (double)integer;
+        }
+    }
+}
+
+// Helper: Get non-negative integer option, leaving `out` untouched if missing
+static void get_opt_size(ErlNifEnv* env, ERL_NIF_TERM opts, ERL_NIF_TERM key, size_t *out) {
+    ERL_NIF_TERM value;
+    ErlNifUInt64 integer;
+    if (get_opt(env, opts, key, &value) && enif_get_uint64(env, value, &integer)) {
+        *out = (size_t)integer;
+    }
+}
+
+// Helper: Fill ufbx_load_opts from Elixir options
+static void parse_load_opts(ErlNifEnv* env, ERL_NIF_TERM opts, ufbx_load_opts *load_opts) {
+    get_opt_bool(env, opts, atom_ignore_geometry, &load_opts->ignore_geometry);
+    get_opt_bool(env, opts, atom_ignore_animation, &load_opts->ignore_animation);
+    get_opt_bool(env, opts, atom_ignore_embedded, &load_opts->ignore_embedded);
+    get_opt_bool(env, opts, atom_generate_missing_normals, &load_opts->generate_missing_normals);
+    get_opt_bool(env, opts, atom_normalize_normals, &load_opts->normalize_normals);
+    get_opt_bool(env, opts, atom_normalize_tangents, &load_opts->normalize_tangents);
+    
+    // Only the structure of external geometry caches is loaded, frames are
+    // read on demand. Missing files end up as warnings instead of failing.
+    get_opt_bool(env, opts, atom_load_external_files, &load_opts->load_external_files);
+    load_opts->ignore_missing_external_files = true;
+    
+    if (thread_pool) {
+        ufbx_os_init_ufbx_thread_pool(&load_opts->thread_opts.pool, thread_pool);
+        load_opts->thread_opts.num_tasks = thread_num_tasks;
+        load_opts->thread_opts.memory_limit = thread_memory_limit;
+    }
+    
+    // Nothing will be baked, so don't load the curves either
+    ERL_NIF_TERM value;
+    if (get_opt(env, opts, atom_anim_stacks, &value) &&
+        (enif_is_identical(value, atom_none) || enif_is_empty_list(env, value))) {
+        load_opts->ignore_animation = true;
+    }
+}
+
+// Helper: Fill ufbx_bake_opts from the `:bake` keyword list
+static void parse_bake_opts(ErlNifEnv* env, ERL_NIF_TERM opts, ufbx_bake_opts *bake) {
+    bake->resample_rate = 30.0; // 30 FPS default
+    
+    ERL_NIF_TERM bake_opts;
+    if (!get_opt(env, opts, atom_bake, &bake_opts)) {
+        return;
+    }
+    
+    get_opt_bool(env, bake_opts, atom_trim_start_time, &bake->trim_start_time);
+    get_opt_double(env, bake_opts, atom_resample_rate, &bake->resample_rate);
+    get_opt_double(env, bake_opts, atom_minimum_sample_rate, &bake->minimum_sample_rate);
+    get_opt_double(env, bake_opts, atom_maximum_sample_rate, &bake->maximum_sample_rate);
+    get_opt_bool(env, bake_opts, atom_bake_transform_props, &bake->bake_transform_props);
+    get_opt_bool(env, bake_opts, atom_skip_node_transforms, &bake->skip_node_transforms);
+    get_opt_bool(env, bake_opts, atom_no_resample_rotation, &bake->no_resample_rotation);
+    get_opt_bool(env, bake_opts, atom_ignore_layer_weight_animation, &bake->ignore_layer_weight_animation);
+    get_opt_size(env, bake_opts, atom_max_keyframe_segments, &bake->max_keyframe_segments);
+    get_opt_double(env, bake_opts, atom_step_custom_duration, &bake->step_custom_duration);
+    get_opt_double(env, bake_opts, atom_step_custom_epsilon, &bake->step_custom_epsilon);
+    get_opt_bool(env, bake_opts, atom_key_reduction_enabled, &bake->key_reduction_enabled);
+    get_opt_bool(env, bake_opts, atom_key_reduction_rotation, &bake->key_reduction_rotation);
+    get_opt_double(env, bake_opts, atom_key_reduction_threshold, &bake->key_reduction_threshold);
+    get_opt_size(env, bake_opts, atom_key_reduction_passes, &bake->key_reduction_passes);
+    
+    ERL_NIF_TERM value;
+    if (get_opt(env, bake_opts, atom_step_handling, &value)) {
+        if (enif_is_identical(value, atom_custom_duration)) {
+            bake->step_handling = UFBX_BAKE_STEP_HANDLING_CUSTOM_DURATION;
+        } else if (enif_is_identical(value, atom_identical_time)) {
+            bake->step_handling = UFBX_BAKE_STEP_HANDLING_IDENTICAL_TIME;
+        } else if (enif_is_identical(value, atom_adjacent_double)) {
+            bake->step_handling = UFBX_BAKE_STEP_HANDLING_ADJACENT_DOUBLE;
+        } else if (enif_is_identical(value, atom_ignore)) {
+            bake->step_handling = UFBX_BAKE_STEP_HANDLING_IGNORE;
+        } else {
+            bake->step_handling = UFBX_BAKE_STEP_HANDLING_DEFAULT;
+        }
+    }
+}
+
+// Helper: Parse `lods: [ratio]`, keeping ratios in (0, 1] sorted in decreasing order
+static void parse_lod_ratios(ErlNifEnv* env, ERL_NIF_TERM opts, extract_opts *out) {
+    ERL_NIF_TERM list, head;
+    out->num_lods = 0;
+    if (!get_opt(env, opts, atom_lods, &list)) {
+        return;
+    }
+    while (out->num_lods < MAX_LODS && enif_get_list_cell(env, list, &head, &list)) {
+        double ratio;
+        ErlNifSInt64 integer;
+        if (!enif_get_double(env, head, &ratio)) {
+            if (!enif_get_int64(env, head, &integer)) continue;
+            ratio = (double)integer;
+        }
+        if (!(ratio > 0.0)) continue;
+        if (ratio > 1.0) ratio = 1.0;
+        
+        size_t i = out->num_lods++;
+        for (; i > 0 && out->lod_ratios[i - 1] < ratio; i--) {
+            out->lod_ratios[i] = out->lod_ratios[i - 1];
+        }
+        out->lod_ratios[i] = ratio;
+    }
+}
+
+// Helper: Parse extraction options (`:mesh_format`, `:precision`, `:optimize`,
+// `:vertex_cache_size`, `:quantize`, `:generate_tangents`, `:lods`, `:subdivide`,
+// `:span_subdivision`, `:max_influences`, `:animation_format`, `:anim_stacks`, `:bake`)
+static void parse_extract_opts(ErlNifEnv* env, ERL_NIF_TERM opts, extract_opts *out) {
+    ERL_NIF_TERM value;
+    if (get_opt(env, opts, atom_mesh_format, &value)) {
+        out->packed = enif_is_identical(value, atom_packed);
+        out->render = enif_is_identical(value, atom_render);
+    }
+    if (get_opt(env, opts, atom_precision, &value)) {
+        out->use_f32 = enif_is_identical(value, atom_f32);
+    }
+    if (get_opt(env, opts, atom_animation_format, &value)) {
+        out->channels = enif_is_identical(value, atom_channels);
+    }
+    out->vertex_cache_size = 16;
+    get_opt_bool(env, opts, atom_optimize, &out->optimize);
+    get_opt_bool(env, opts, atom_quantize, &out->quantize);
+    if (get_opt(env, opts, atom_generate_tangents, &value)) {
+        out->generate_tangents = enif_is_identical(value, atom_mikktspace) ||
+            enif_is_identical(value, atom_true);
+    }
+    if (get_opt(env, opts, atom_subdivide, &value)) {
+        if (enif_is_identical(value, atom_preview)) {
+            out->subdivide = SUBDIVIDE_PREVIEW;
+        } else if (enif_is_identical(value, atom_render)) {
+            out->subdivide = SUBDIVIDE_RENDER;
+        } else {
+            get_opt_size(env, opts, atom_subdivide, &out->subdivide);
+        }
+    }
+    out->span_subdivision = 4;
+    if (get_opt(env, opts, atom_span_subdivision, &value)) {
+        if (enif_is_identical(value, atom_authored)) {
+            out->span_subdivision = SPAN_SUBDIVISION_AUTHORED;
+        } else {
+            get_opt_size(env, opts, atom_span_subdivision, &out->span_subdivision);
+        }
+    }
+    get_opt_size(env, opts, atom_vertex_cache_size, &out->vertex_cache_size);
+    if (out->vertex_cache_size < 3) {
+        out->vertex_cache_size = 3;
+    }
+    out->max_influences = 4;
+    get_opt_size(env, opts, atom_max_influences, &out->max_influences);
+    if (out->max_influences < 1) {
+        out->max_influences = 1;
+    } else if (out->max_influences > MAX_INFLUENCES) {
+        out->max_influences = MAX_INFLUENCES;
+    }
+    parse_lod_ratios(env, opts, out);
+    if (!get_opt(env, opts, atom_anim_stacks, &out->anim_stacks)) {
+        out->anim_stacks = atom_all;
+    }
+    parse_bake_opts(env, opts, &out->bake);
+}
+
+// Helper: Store a float or double in little-endian byte order
+static void store_f32_le(unsigned char *dst, float value) {
+    memcpy(dst, &value, sizeof(float));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    unsigned char t;
+    t = dst[0]; dst[0] = dst[3]; dst[3] = t;
+    t = dst[1]; dst[1] = dst[2]; dst[2] = t;
+#endif
+}
+
+static void store_f64_le(unsigned char *dst, double value) {
+    memcpy(dst, &value, sizeof(double));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (int i = 0; i < 4; i++) {
+        unsigned char t = dst[i]; dst[i] = dst[7 - i]; dst[7 - i] = t;
+    }
+#endif
+}
+
+static void store_u16_le(unsigned char *dst, uint16_t value) {
+    dst[0] = (unsigned char)(value);
+    dst[1] = (unsigned char)(value >> 8);
+}
+
+// Helper: Round a float to the nearest IEEE half and store it little-endian.
+// Values below the smallest normal half flush to zero.
+static void store_f16_le(unsigned char *dst, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t magnitude = bits & 0x7fffffffu;
+    uint32_t half = (magnitude - (112u << 23) + (1u << 12)) >> 13;  // Rebias exponent 127 -> 15
+    half = magnitude < (113u << 23) ? 0 : half;
+    half = magnitude >= (143u << 23) ? 0x7c00u : half;  // Infinity
+    half = magnitude > (255u << 23) ? 0x7e00u : half;   // NaN
+    store_u16_le(dst, (uint16_t)(sign | half));
+}
+
+static void store_u32_le(unsigned char *dst, uint32_t value) {
+    dst[0] = (unsigned char)(value);
+    dst[1] = (unsigned char)(value >> 8);
+    dst[2] = (unsigned char)(value >> 16);
+    dst[3] = (unsigned char)(value >> 24);
+}
+
+// Helper: Read little-endian values back, e.g. from packed write input
+static float load_f32_le(const unsigned char *src) {
+    unsigned char b[4];
+    memcpy(b, src, sizeof(b));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    unsigned char t;
+    t = b[0]; b[0] = b[3]; b[3] = t;
+    t = b[1]; b[1] = b[2]; b[2] = t;
+#endif
+    float value;
+    memcpy(&value, b, sizeof(value));
+    return value;
+}
+
+static double load_f64_le(const unsigned char *src) {
+    unsigned char b[8];
+    memcpy(b, src, sizeof(b));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (int i = 0; i < 4; i++) {
+        unsigned char t = b[i]; b[i] = b[7 - i]; b[7 - i] = t;
+    }
+#endif
+    double value;
+    memcpy(&value, b, sizeof(value));
+    return value;
+}
+
+static uint32_t load_u32_le(const unsigned char *src) {
+    return (uint32_t)src[0] | (uint32_t)src[1] << 8 | (uint32_t)src[2] << 16 | (uint32_t)src[3] << 24;
+}
+
+// Helper: Describe a packed attribute: %{type, components, stride, count}
+static ERL_NIF_TERM make_layout(ErlNifEnv* env, ERL_NIF_TERM type, size_t components, size_t elem_size, size_t count) {
+    ERL_NIF_TERM keys[4];
+    ERL_NIF_TERM values[4];
+    keys[0] = atom_type;
+    values[0] = type;
+    keys[1] = atom_components;
+    values[1] = enif_make_uint64(env, components);
+    keys[2] = atom_stride;
+    values[2] = enif_make_uint64(env, components * elem_size);
+    keys[3] = atom_count;
+    values[3] = enif_make_uint64(env, count);
+    
+    return make_map(env, keys, values, 4);
+}
+
+// ufbx arrays can be handed out as-is only if the host stores them little-endian
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define NATIVE_LITTLE_ENDIAN 0
+#else
+#define NATIVE_LITTLE_ENDIAN 1
+#endif
+
+// Helper: Pack `count` elements of `components` reals into a binary
+static ERL_NIF_TERM make_packed_reals(ErlNifEnv* env, const ufbx_real *data, size_t count, size_t components,
+                                      const extract_opts *opts, ERL_NIF_TERM *layout) {
+    size_t num = count * components;
+    size_t elem_size = opts->use_f32 ? sizeof(float) : sizeof(double);
+    *layout = make_layout(env, opts->use_f32 ? atom_f32 : atom_f64, components, elem_size, count);
+    
+    // Zero-copy: the binary points into the scene and keeps the owning resource alive
+    if (opts->owner && NATIVE_LITTLE_ENDIAN && elem_size == sizeof(ufbx_real)) {
+        return enif_make_resource_binary(env, opts->owner, data, num * elem_size);
+    }
+    
+    ERL_NIF_TERM result;
+    unsigned char *dst = enif_make_new_binary(env, num * elem_size, &result);
+    if (opts->use_f32) {
+        for (size_t i = 0; i < num; i++) {
+            store_f32_le(dst + i * sizeof(float), (float)data[i]);
+        }
+    } else {
+        for (size_t i = 0; i < num; i++) {
+            store_f64_le(dst + i * sizeof(double), (double)data[i]);
+        }
+    }
+    return result;
+}
+
+// Helper: Store one sample of `components` reals at `index` in a packed buffer
+static void store_packed_reals(unsigned char *dst, size_t index, const ufbx_real *v, size_t components,
+                               const extract_opts *opts) {
+    for (size_t c = 0; c < components; c++) {
+        if (opts->use_f32) {
+            store_f32_le(dst + (index * components + c) * sizeof(float), (float)v[c]);
+        } else {
+            store_f64_le(dst + (index * components + c) * sizeof(double), (double)v[c]);
+        }
+    }
+}
+
+// Helper: Pack a ufbx_uint32_list into a binary of u32
+static ERL_NIF_TERM make_packed_uint32(ErlNifEnv* env, ufbx_uint32_list list, const extract_opts *opts,
+                                       ERL_NIF_TERM *layout) {
+    if (opts->owner && NATIVE_LITTLE_ENDIAN) {
+        *layout = make_layout(env, atom_u32, 1, sizeof(uint32_t), list.count);
+        return enif_make_resource_binary(env, opts->owner, list.data, list.count * sizeof(uint32_t));
+    }
+    
+    ERL_NIF_TERM result;
+    unsigned char *dst = enif_make_new_binary(env, list.count * sizeof(uint32_t), &result);
+    for (size_t i = 0; i < list.count; i++) {
+        store_u32_le(dst + i * sizeof(uint32_t), list.data[i]);
+    }
+    *layout = make_layout(env, atom_u32, 1, sizeof(uint32_t), list.count);
+    return result;
+}
+
 // Extract node data from ufbx_node to Elixir map
 static ERL_NIF_TERM extract_node(ErlNifEnv* env, ufbx_node *node, uint32_t node_id) {
     ERL_NIF_TERM keys[10];
@@ -66,18 +577,18 @@ static ERL_NIF_TERM extract_node(ErlNifEnv* env, ufbx_node *node, uint32_t node_
     size_t idx = 0;
     
     // id
-    keys[idx] = enif_make_atom(env, "id");
+    keys[idx] = atom_id;
     values[idx] = enif_make_uint(env, node_id);
     idx++;
     
     // name
-    keys[idx] = enif_make_atom(env, "name");
+    keys[idx] = atom_name;
     values[idx] = make_string(env, node->name);
     idx++;
     
     // parent_id (if parent exists, use parent's typed_id)
     if (node->parent) {
-        keys[idx] = enif_make_atom(env, "parent_id");
+        keys[idx] = atom_parent_id;
         values[idx] = enif_make_uint(env, node->parent->typed_id);
         idx++;
     }
@@ -89,18 +600,18 @@ static ERL_NIF_TERM extract_node(ErlNifEnv* env, ufbx_node *node, uint32_t node_
             ERL_NIF_TERM child_id = enif_make_uint(env, node->children.data[i - 1]->typed_id);
             children = enif_make_list_cell(env, child_id, children);
         }
-        keys[idx] = enif_make_atom(env, "children");
+        keys[idx] = atom_children;
         values[idx] = children;
         idx++;
     }
     
     // translation from local_transform
-    keys[idx] = enif_make_atom(env, "translation");
+    keys[idx] = atom_translation;
     values[idx] = make_vec3(env, node->local_transform.translation);
     idx++;
     
     // rotation from local_transform (quaternion)
-    keys[idx] = enif_make_atom(env, "rotation");
+    keys[idx] = atom_rotation;
     ufbx_vec4 rot_vec4;
     rot_vec4.x = node->local_transform.rotation.x;
     rot_vec4.y = node->local_transform.rotation.y;
@@ -110,500 +621,4754 @@ static ERL_NIF_TERM extract_node(ErlNifEnv* env, ufbx_node *node, uint32_t node_
     idx++;
     
     // scale from local_transform
-    keys[idx] = enif_make_atom(env, "scale");
+    keys[idx] = atom_scale;
     values[idx] = make_vec3(env, node->local_transform.scale);
     idx++;
     
     // mesh_id (if mesh exists)
     if (node->mesh) {
-        keys[idx] = enif_make_atom(env, "mesh_id");
+        keys[idx] = atom_mesh_id;
         values[idx] = enif_make_uint(env, node->mesh->typed_id);
         idx++;
     }
     
-    // Build map manually for compatibility
-    ERL_NIF_TERM map = enif_make_new_map(env);
-    for (size_t i = 0; i < idx; i++) {
-        enif_make_map_put(env, map, keys[i], values[i], &map);
+    // nurbs_surface_id / nurbs_curve_id (if the node holds NURBS geometry)
+    if (node->attrib_type == UFBX_ELEMENT_NURBS_SURFACE) {
+        keys[idx] = atom_nurbs_surface_id;
+        values[idx] = enif_make_uint(env, node->attrib->typed_id);
+        idx++;
+    } else if (node->attrib_type == UFBX_ELEMENT_NURBS_CURVE) {
+        keys[idx] = atom_nurbs_curve_id;
+        values[idx] = enif_make_uint(env, node->attrib->typed_id);
+        idx++;
     }
-    return map;
+    
+    return make_map(env, keys, values, idx);
 }
 
-// Extract mesh data from ufbx_mesh to Elixir map
-static ERL_NIF_TERM extract_mesh(ErlNifEnv* env, ufbx_mesh *mesh) {
-    ERL_NIF_TERM keys[10];
-    ERL_NIF_TERM values[10];
-    size_t idx = 0;
-    
-    // id
-    keys[idx] = enif_make_atom(env, "id");
-    values[idx] = enif_make_uint(env, mesh->typed_id);
-    idx++;
-    
-    // name
-    keys[idx] = enif_make_atom(env, "name");
-    values[idx] = make_string(env, mesh->name);
-    idx++;
-    
-    // positions (from vertex_position)
-    if (mesh->vertex_position.exists && mesh->vertex_position.values.count > 0) {
-        ERL_NIF_TERM positions = make_vec3_list(env, mesh->vertex_position.values);
-        keys[idx] = enif_make_atom(env, "positions");
-        values[idx] = positions;
-        idx++;
-        
-        // indices (from vertex_position.indices)
-        if (mesh->vertex_position.indices.count > 0) {
-            ERL_NIF_TERM indices = make_uint32_list(env, mesh->vertex_position.indices);
-            keys[idx] = enif_make_atom(env, "indices");
-            values[idx] = indices;
-            idx++;
-        }
+// ============================================================================
+// Skinning
+// ============================================================================
+
+// Helper: The skin deformer a mesh is extracted with, or NULL if unskinned
+static const ufbx_skin_deformer *mesh_skin(const ufbx_mesh *mesh) {
+    return mesh->skin_deformers.count > 0 ? mesh->skin_deformers.data[0] : NULL;
+}
+
+// Helper: Insert an influence into `count` ones sorted strongest first, keeping
+// at most `max`. Returns the new count.
+static size_t insert_influence(uint32_t *joints, ufbx_real *weights, size_t count, size_t max,
+                               uint32_t joint, ufbx_real weight) {
+    if (!(weight > 0.0f) || (count == max && weight <= weights[max - 1])) {
+        return count;
     }
-    
-    // normals (from vertex_normal)
-    if (mesh->vertex_normal.exists && mesh->vertex_normal.values.count > 0) {
-        ERL_NIF_TERM normals = make_vec3_list(env, mesh->vertex_normal.values);
-        keys[idx] = enif_make_atom(env, "normals");
-        values[idx] = normals;
-        idx++;
+    size_t i = count < max ? count++ : max - 1;
+    for (; i > 0 && weights[i - 1] < weight; i--) {
+        joints[i] = joints[i - 1];
+        weights[i] = weights[i - 1];
     }
-    
-    // texcoords (from vertex_uv)
-    if (mesh->vertex_uv.exists && mesh->vertex_uv.values.count > 0) {
-        ERL_NIF_TERM texcoords = enif_make_list(env, 0);
-        for (size_t i = mesh->vertex_uv.values.count; i > 0; i--) {
-            ufbx_vec2 uv = mesh->vertex_uv.values.data[i - 1];
-            ERL_NIF_TERM u = enif_make_double(env, uv.x);
-            ERL_NIF_TERM v = enif_make_double(env, uv.y);
-            ERL_NIF_TERM uv_vec = enif_make_list2(env, u, v);
-            texcoords = enif_make_list_cell(env, uv_vec, texcoords);
-        }
-        keys[idx] = enif_make_atom(env, "texcoords");
-        values[idx] = texcoords;
-        idx++;
+    joints[i] = joint;
+    weights[i] = weight;
+    return count;
+}
+
+// Helper: Up to `max` strongest joint influences of `vertex` in `mesh`,
+// strongest first and renormalized to sum to one. Subdivided meshes carry
+// their interpolated weights in `subdivision_result`, as the skin deformer
+// indexes the original vertices. Returns the number of influences.
+static size_t skin_influences(const ufbx_mesh *mesh, uint32_t vertex, size_t max,
+                              uint32_t *joints, ufbx_real *weights) {
+    const ufbx_skin_deformer *skin = mesh_skin(mesh);
+    const ufbx_subdivision_result *subdivision = mesh->subdivision_result;
+    size_t count = 0;
+    if (!skin) {
+        return 0;
     }
     
-    // material_ids
-    if (mesh->materials.count > 0) {
-        ERL_NIF_TERM material_ids = enif_make_list(env, 0);
-        for (size_t i = mesh->materials.count; i > 0; i--) {
-            ERL_NIF_TERM mat_id = enif_make_uint(env, mesh->materials.data[i - 1]->typed_id);
-            material_ids = enif_make_list_cell(env, mat_id, material_ids);
+    if (subdivision) {
+        if (vertex >= subdivision->skin_cluster_ranges.count) return 0;
+        ufbx_subdivision_weight_range range = subdivision->skin_cluster_ranges.data[vertex];
+        for (uint32_t i = 0; i < range.num_weights; i++) {
+            ufbx_subdivision_weight w = subdivision->skin_cluster_weights.data[range.weight_begin + i];
+            count = insert_influence(joints, weights, count, max, w.index, w.weight);
+        }
+    } else {
+        if (vertex >= skin->vertices.count) return 0;
+        ufbx_skin_vertex sv = skin->vertices.data[vertex];
+        for (uint32_t i = 0; i < sv.num_weights; i++) {
+            ufbx_skin_weight w = skin->weights.data[sv.weight_begin + i];
+            count = insert_influence(joints, weights, count, max, w.cluster_index, w.weight);
         }
-        keys[idx] = enif_make_atom(env, "material_ids");
-        values[idx] = material_ids;
-        idx++;
     }
     
-    // Build map manually for compatibility
-    ERL_NIF_TERM map = enif_make_new_map(env);
-    for (size_t i = 0; i < idx; i++) {
-        enif_make_map_put(env, map, keys[i], values[i], &map);
+    ufbx_real total = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        total += weights[i];
     }
-    return map;
+    for (size_t i = 0; i < count; i++) {
+        weights[i] /= total;
+    }
+    return count;
 }
 
-// Extract material data from ufbx_material to Elixir map
-static ERL_NIF_TERM extract_material(ErlNifEnv* env, ufbx_material *material) {
-    ERL_NIF_TERM keys[10];
-    ERL_NIF_TERM values[10];
-    size_t idx = 0;
-    
-    // id
-    keys[idx] = enif_make_atom(env, "id");
-    values[idx] = enif_make_uint(env, material->typed_id);
-    idx++;
-    
-    // name
-    keys[idx] = enif_make_atom(env, "name");
-    values[idx] = make_string(env, material->name);
-    idx++;
-    
-    // diffuse_color (from PBR base_color or FBX diffuse)
-    if (material->pbr.base_color.has_value && material->pbr.base_color.value_components >= 3) {
-        ufbx_vec3 color = material->pbr.base_color.value_vec3;
-        keys[idx] = enif_make_atom(env, "diffuse_color");
-        values[idx] = make_vec3(env, color);
-        idx++;
-    } else if (material->fbx.diffuse_color.has_value && material->fbx.diffuse_color.value_components >= 3) {
-        ufbx_vec3 color = material->fbx.diffuse_color.value_vec3;
-        keys[idx] = enif_make_atom(env, "diffuse_color");
-        values[idx] = make_vec3(env, color);
-        idx++;
+// ============================================================================
+// Blend Shapes
+// ============================================================================
+
+// Helper: Whether `mesh` is extracted with blend shapes. Shapes index the
+// original vertices, which subdivision does not preserve.
+static int mesh_has_blend(const ufbx_mesh *mesh) {
+    return mesh->blend_deformers.count > 0 && !mesh->subdivision_evaluated;
+}
+
+// Helper: Number of blend channels over all blend deformers of `mesh`, in
+// the order they are extracted and weighted by `evaluate_blend/3`
+static size_t blend_channel_count(const ufbx_mesh *mesh) {
+    size_t count = 0;
+    for (size_t i = 0; i < mesh->blend_deformers.count; i++) {
+        count += mesh->blend_deformers.data[i]->channels.count;
     }
-    
-    // specular_color (from PBR specular_color or FBX)
-    if (material->pbr.specular_color.has_value && material->pbr.specular_color.value_components >= 3) {
-        ufbx_vec3 color = material->pbr.specular_color.value_vec3;
-        keys[idx] = enif_make_atom(env, "specular_color");
-        values[idx] = make_vec3(env, color);
-        idx++;
-    } else if (material->fbx.specular_color.has_value && material->fbx.specular_color.value_components >= 3) {
-        ufbx_vec3 color = material->fbx.specular_color.value_vec3;
-        keys[idx] = enif_make_atom(env, "specular_color");
-        values[idx] = make_vec3(env, color);
-        idx++;
+    return count;
+}
+
+// Helper: Target weight of keyframe `index` of `channel`, where -1 is the
+// implicit base shape at zero
+static ufbx_real keyframe_target(const ufbx_blend_channel *channel, ptrdiff_t index) {
+    return index >= 0 ? channel->keyframes.data[index].target_weight : 0.0f;
+}
+
+// Helper: Effective weight of every keyframe of `channel` at `weight`: the
+// two keyframes around it (or the base shape) are interpolated linearly, as
+// ufbx does for the channel's animated weight
+static void blend_keyframe_weights(const ufbx_blend_channel *channel, ufbx_real weight, ufbx_real *out) {
+    ptrdiff_t num_keys = (ptrdiff_t)channel->keyframes.count;
+    ptrdiff_t last_negative = -1;
+    for (ptrdiff_t i = 0; i < num_keys; i++) {
+        out[i] = 0.0f;
+        if (channel->keyframes.data[i].target_weight < 0.0f) last_negative = i;
     }
     
-    // emissive_color (from PBR emission_color or FBX)
-    if (material->pbr.emission_color.has_value && material->pbr.emission_color.value_components >= 3) {
-        ufbx_vec3 color = material->pbr.emission_color.value_vec3;
-        keys[idx] = enif_make_atom(env, "emissive_color");
-        values[idx] = make_vec3(env, color);
-        idx++;
-    } else if (material->fbx.emission_color.has_value && material->fbx.emission_color.value_components >= 3) {
-        ufbx_vec3 color = material->fbx.emission_color.value_vec3;
-        keys[idx] = enif_make_atom(env, "emissive_color");
-        values[idx] = make_vec3(env, color);
-        idx++;
+    ptrdiff_t prev = -1, next = -1;
+    if (weight > 0.0f) {
+        if (last_negative >= 0) prev = last_negative;
+        for (ptrdiff_t i = last_negative + 1; i < num_keys; i++) {
+            prev = next;
+            next = i;
+            if (keyframe_target(channel, next) > weight) break;
+        }
+    } else {
+        if (last_negative + 1 < num_keys) prev = last_negative + 1;
+        for (ptrdiff_t i = last_negative; i >= 0; i--) {
+            prev = next;
+            next = i;
+            if (keyframe_target(channel, next) < weight) break;
+        }
     }
     
-    // Build map manually for compatibility
-    ERL_NIF_TERM map = enif_make_new_map(env);
-    for (size_t i = 0; i < idx; i++) {
-        enif_make_map_put(env, map, keys[i], values[i], &map);
+    ufbx_real delta = keyframe_target(channel, next) - keyframe_target(channel, prev);
+    if (delta != 0.0f) {
+        ufbx_real t = (weight - keyframe_target(channel, prev)) / delta;
+        if (prev >= 0) out[prev] = 1.0f - t;
+        if (next >= 0) out[next] = t;
     }
-    return map;
 }
 
-// Extract texture data from ufbx_texture to Elixir map
-static ERL_NIF_TERM extract_texture(ErlNifEnv* env, ufbx_texture *texture) {
-    ERL_NIF_TERM keys[5];
-    ERL_NIF_TERM values[5];
-    size_t idx = 0;
-    
-    // id
-    keys[idx] = enif_make_atom(env, "id");
-    values[idx] = enif_make_uint(env, texture->typed_id);
-    idx++;
-    
-    // name
-    keys[idx] = enif_make_atom(env, "name");
-    values[idx] = make_string(env, texture->name);
+// ============================================================================
+// Render Meshes
+// ============================================================================
+
+// Vertex attributes of a render mesh, interleaved in this order when present.
+// Tangents carry the bitangent handedness in `w`.
+enum {
+    RENDER_POSITION,
+    RENDER_NORMAL,
+    RENDER_TEXCOORD,
+    RENDER_COLOR,
+    RENDER_TANGENT,
+    RENDER_ATTRIBUTE_COUNT
+};
+
+#define RENDER_NO_ATTRIBUTE SIZE_MAX
+
+static const size_t render_attribute_components[RENDER_ATTRIBUTE_COUNT] = { 3, 3, 2, 4, 4 };
+
+// Contiguous range of render mesh indices drawn with one material
+typedef struct render_part {
+    uint32_t material;    // Index into `ufbx_mesh.materials`, may be out of range if it has none
+    size_t index_offset;
+    size_t num_indices;
+} render_part;
+
+// Triangulated mesh where every vertex has a single index shared by all of its
+// attributes, as consumed by GPUs. Triangles are ordered by material part.
+// Built by `build_render_mesh()`.
+typedef struct render_mesh {
+    ufbx_real *vertices;       // `num_vertices * stride` interleaved reals
+    uint32_t *vertex_indices;  // Source vertex (control point) of each vertex, for per-vertex data
+    uint32_t *indices;         // `num_indices` triangle corners
+    render_part *parts;        // Non-empty material parts, in `ufbx_mesh.material_parts` order
+    size_t num_vertices;
+    size_t num_indices;
+    size_t num_parts;
+    size_t stride;             // Reals per vertex
+    size_t offsets[RENDER_ATTRIBUTE_COUNT]; // In reals, `RENDER_NO_ATTRIBUTE` if missing
+} render_mesh;
+
+static void free_render_mesh(render_mesh *rm) {
+    if (rm->vertices) enif_free(rm->vertices);
+    if (rm->vertex_indices) enif_free(rm->vertex_indices);
+    if (rm->indices) enif_free(rm->indices);
+    if (rm->parts) enif_free(rm->parts);
+    memset(rm, 0, sizeof(*rm));
+}
+
+// Helper: Write the attributes of mesh index `ix` to an interleaved vertex.
+// `normals` may differ from the mesh's own, and `generated_tangents` (4 per
+// mesh index, see `generate_mikktspace_tangents()`) replace the file's if given.
+static void write_render_vertex(const ufbx_mesh *mesh, const ufbx_vertex_vec3 *normals,
+                                const float *generated_tangents, const render_mesh *rm, uint32_t ix,
+                                ufbx_real *dst) {
+    ufbx_vec3 position = ufbx_get_vertex_vec3(&mesh->vertex_position, ix);
+    memcpy(dst + rm->offsets[RENDER_POSITION], &position, sizeof(position));
+    
+    ufbx_vec3 normal = { 0 };
+    if (rm->offsets[RENDER_NORMAL] != RENDER_NO_ATTRIBUTE) {
+        normal = ufbx_get_vertex_vec3(normals, ix);
+        memcpy(dst + rm->offsets[RENDER_NORMAL], &normal, sizeof(normal));
+    }
+    if (rm->offsets[RENDER_TEXCOORD] != RENDER_NO_ATTRIBUTE) {
+        ufbx_vec2 uv = ufbx_get_vertex_vec2(&mesh->vertex_uv, ix);
+        memcpy(dst + rm->offsets[RENDER_TEXCOORD], &uv, sizeof(uv));
+    }
+    if (rm->offsets[RENDER_COLOR] != RENDER_NO_ATTRIBUTE) {
+        ufbx_vec4 color = ufbx_get_vertex_vec4(&mesh->vertex_color, ix);
+        memcpy(dst + rm->offsets[RENDER_COLOR], &color, sizeof(color));
+    }
+    if (rm->offsets[RENDER_TANGENT] != RENDER_NO_ATTRIBUTE && generated_tangents) {
+        ufbx_real *tangent = dst + rm->offsets[RENDER_TANGENT];
+        for (int k = 0; k < 4; k++) {
+            tangent[k] = generated_tangents[(size_t)ix * 4 + k];
+        }
+    } else if (rm->offsets[RENDER_TANGENT] != RENDER_NO_ATTRIBUTE) {
+        ufbx_vec3 t = ufbx_get_vertex_vec3(&mesh->vertex_tangent, ix);
+        ufbx_real w = 1.0;
+        if (mesh->vertex_bitangent.exists) {
+            // Handedness: sign of dot(cross(normal, tangent), bitangent)
+            ufbx_vec3 b = ufbx_get_vertex_vec3(&mesh->vertex_bitangent, ix);
+            ufbx_real d = (normal.y * t.z - normal.z * t.y) * b.x
+                        + (normal.z * t.x - normal.x * t.z) * b.y
+                        + (normal.x * t.y - normal.y * t.x) * b.z;
+            if (d < 0.0) w = -1.0;
+        }
+        ufbx_real *tangent = dst + rm->offsets[RENDER_TANGENT];
+        tangent[0] = t.x;
+        tangent[1] = t.y;
+        tangent[2] = t.z;
+        tangent[3] = w;
+    }
+}
+
+// Helper: Free an attribute built by `compute_render_normals()`
+static void free_vertex_vec3(ufbx_vertex_vec3 *attrib) {
+    if (attrib->values.data) enif_free(attrib->values.data);
+    if (attrib->indices.data) enif_free(attrib->indices.data);
+    memset(attrib, 0, sizeof(*attrib));
+}
+
+// Helper: Smooth normals for a mesh without any, from `ufbx_generate_normal_mapping()`
+// (respecting smoothing groups) and `ufbx_compute_normals()`. The result
+// owns `values.data` and `indices.data`. Returns 0 on allocation failure.
+static int compute_render_normals(const ufbx_mesh *mesh, ufbx_vertex_vec3 *normals) {
+    memset(normals, 0, sizeof(*normals));
+    ufbx_topo_edge *topo = (ufbx_topo_edge*)enif_alloc(mesh->num_indices * sizeof(ufbx_topo_edge));
+    uint32_t *indices = (uint32_t*)enif_alloc(mesh->num_indices * sizeof(uint32_t));
+    ufbx_vec3 *values = (ufbx_vec3*)enif_alloc(mesh->num_indices * sizeof(ufbx_vec3));
+    if (!topo || !indices || !values) {
+        if (topo) enif_free(topo);
+        if (indices) enif_free(indices);
+        if (values) enif_free(values);
+        return 0;
+    }
+    
+    ufbx_compute_topology(mesh, topo, mesh->num_indices);
+    size_t num_normals = ufbx_generate_normal_mapping(mesh, topo, mesh->num_indices, indices, mesh->num_indices, false);
+    ufbx_compute_normals(mesh, &mesh->vertex_position, indices, mesh->num_indices, values, num_normals);
+    enif_free(topo);
+    
+    normals->exists = true;
+    normals->values.data = values;
+    normals->values.count = num_normals;
+    normals->indices.data = indices;
+    normals->indices.count = mesh->num_indices;
+    normals->value_reals = 3;
+    return 1;
+}
+
+// MikkTSpace (Mikkelsen, "Simulation of Wrinkled Surfaces Revisited", 2008),
+// ported from the reference `mikktspace.c` with its default 180 degree
+// angular threshold so that normal maps baked by MikkTSpace tools line up.
+// Math is in `float` like the reference, which welds and compares tangent
+// spaces by exact equality.
+
+#define MIKK_DEGENERATE 1u           // Two corners share a position
+#define MIKK_QUAD_ONE_DEGENERATE 2u  // The other triangle of the quad is degenerate
+#define MIKK_GROUP_WITH_ANY 4u       // No usable UV gradient, joins any group
+#define MIKK_ORIENT_PRESERVING 8u    // Positive UV winding
+
+typedef struct mikk_vec3 {
+    float x, y, z;
+} mikk_vec3;
+
+// Corner data MikkTSpace welds on
+typedef struct mikk_vertex {
+    mikk_vec3 position;
+    mikk_vec3 normal;
+    float uv[2];
+} mikk_vertex;
+
+typedef struct mikk_tri {
+    int32_t neighbors[3];  // Triangle across the edge from corner `i` to `i + 1`, -1 if none
+    int32_t groups[3];     // Group of each corner, -1 if none
+    mikk_vec3 os, ot;      // Unit UV gradients (tangent and bitangent directions)
+    float mag_s, mag_t;    // Their magnitudes
+    uint32_t face;         // MikkTSpace face, a quad gives two triangles
+    uint32_t slot;         // First slot of the face
+    uint32_t flags;
+    uint8_t corners[3];    // Face corner of each triangle corner
+} mikk_tri;
+
+// Triangles around a welded vertex connected through edges with the same
+// UV orientation
+typedef struct mikk_group {
+    uint32_t vertex;
+    uint32_t first, count;  // Range in `mikk_context.group_tris`
+    bool orient;
+} mikk_group;
+
+typedef struct mikk_tspace {
+    mikk_vec3 os, ot;
+    float mag_s, mag_t;
+    int counter;  // Subgroups averaged in, the diagonal of a quad gets two
+    bool orient;
+} mikk_tspace;
+
+typedef struct mikk_subgroup {
+    uint32_t first, count;  // Range in `mikk_context.members`
+    mikk_tspace tspace;
+} mikk_subgroup;
+
+typedef struct mikk_edge {
+    uint32_t i0, i1;   // Welded vertices, `i0 < i1`
+    uint32_t a, b;     // The same in the triangle's winding
+    uint32_t tri, edge;
+} mikk_edge;
+
+// Working state of `generate_mikktspace_tangents()`. A slot is a corner of a
+// MikkTSpace face (a triangle, a quad or one triangle of a split ngon).
+typedef struct mikk_context {
+    uint32_t *slot_index;      // Mesh index of each slot
+    mikk_vertex *vertices;     // Slot data, compacted to welded vertices
+    uint32_t *welded;          // Welded vertex of each slot
+    mikk_tspace *tspaces;      // Result of each slot
+    mikk_tri *tris;
+    uint32_t *tri_verts;       // Welded vertex of each triangle corner
+    mikk_edge *edges;
+    mikk_group *groups;
+    uint32_t *group_tris;
+    uint32_t *stack;
+    uint32_t *first_corner;    // First good triangle corner of each welded vertex
+    uint32_t *tri_indices;
+    mikk_subgroup *subgroups;
+    uint32_t *members;         // Triangles of the subgroups, then the candidate
+    size_t members_cap;
+} mikk_context;
+
+static void free_mikk_context(mikk_context *mc) {
+    void *ptrs[] = {
+        mc->slot_index, mc->vertices, mc->welded, mc->tspaces, mc->tris, mc->tri_verts,
+        mc->edges, mc->groups, mc->group_tris, mc->stack, mc->first_corner, mc->tri_indices,
+        mc->subgroups, mc->members,
+    };
+    for (size_t i = 0; i < sizeof(ptrs) / sizeof(*ptrs); i++) {
+        if (ptrs[i]) enif_free(ptrs[i]);
+    }
+    memset(mc, 0, sizeof(*mc));
+}
+
+static mikk_vec3 mikk_add(mikk_vec3 a, mikk_vec3 b) {
+    mikk_vec3 r = { a.x + b.x, a.y + b.y, a.z + b.z };
+    return r;
+}
+
+static mikk_vec3 mikk_sub(mikk_vec3 a, mikk_vec3 b) {
+    mikk_vec3 r = { a.x - b.x, a.y - b.y, a.z - b.z };
+    return r;
+}
+
+static mikk_vec3 mikk_scale(float s, mikk_vec3 v) {
+    mikk_vec3 r = { s * v.x, s * v.y, s * v.z };
+    return r;
+}
+
+static float mikk_dot(mikk_vec3 a, mikk_vec3 b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static float mikk_length(mikk_vec3 v) {
+    return sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+}
+
+static bool mikk_equal(mikk_vec3 a, mikk_vec3 b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static bool mikk_not_zero(float f) {
+    return fabsf(f) > FLT_MIN;
+}
+
+static mikk_vec3 mikk_normalize_not_zero(mikk_vec3 v) {
+    if (mikk_not_zero(v.x) || mikk_not_zero(v.y) || mikk_not_zero(v.z)) {
+        v = mikk_scale(1.0f / mikk_length(v), v);
+    }
+    return v;
+}
+
+// Helper: `v` projected onto the plane of `n` and normalized if not zero
+static mikk_vec3 mikk_project(mikk_vec3 n, mikk_vec3 v) {
+    return mikk_normalize_not_zero(mikk_sub(v, mikk_scale(mikk_dot(n, v), n)));
+}
+
+// Helper: Twice the unsigned UV area of triangle `t`
+static float mikk_uv_area(const mikk_context *mc, size_t t) {
+    const float *t1 = mc->vertices[mc->tri_verts[t * 3 + 0]].uv;
+    const float *t2 = mc->vertices[mc->tri_verts[t * 3 + 1]].uv;
+    const float *t3 = mc->vertices[mc->tri_verts[t * 3 + 2]].uv;
+    float area = (t2[0] - t1[0]) * (t3[1] - t1[1]) - (t2[1] - t1[1]) * (t3[0] - t1[0]);
+    return area < 0.0f ? -area : area;
+}
+
+static int compare_mikk_edges(const void *a, const void *b) {
+    const mikk_edge *ea = (const mikk_edge*)a, *eb = (const mikk_edge*)b;
+    if (ea->i0 != eb->i0) return ea->i0 < eb->i0 ? -1 : 1;
+    if (ea->i1 != eb->i1) return ea->i1 < eb->i1 ? -1 : 1;
+    return (ea->tri > eb->tri) - (ea->tri < eb->tri);
+}
+
+static int compare_uint32s(const void *a, const void *b) {
+    uint32_t ua = *(const uint32_t*)a, ub = *(const uint32_t*)b;
+    return (ua > ub) - (ua < ub);
+}
+
+// Helper: Corner of triangle `t` at welded vertex `vertex`, -1 if none
+static int mikk_tri_corner(const mikk_context *mc, size_t t, uint32_t vertex) {
+    for (int i = 0; i < 3; i++) {
+        if (mc->tri_verts[t * 3 + i] == vertex) return i;
+    }
+    return -1;
+}
+
+// Helper: Add one triangle of MikkTSpace face `face` from its corners `a`, `b`, `c`
+static void mikk_add_tri(mikk_context *mc, size_t t, uint32_t face, uint32_t slot,
+                         uint8_t a, uint8_t b, uint8_t c) {
+    mikk_tri *tri = &mc->tris[t];
+    memset(tri, 0, sizeof(*tri));
+    tri->face = face;
+    tri->slot = slot;
+    tri->corners[0] = a;
+    tri->corners[1] = b;
+    tri->corners[2] = c;
+    mc->tri_verts[t * 3 + 0] = slot + a;
+    mc->tri_verts[t * 3 + 1] = slot + b;
+    mc->tri_verts[t * 3 + 2] = slot + c;
+}
+
+// Helper: UV gradients and orientation of the good triangles, then make both
+// triangles of each quad agree on the orientation
+static void mikk_init_tris(mikk_context *mc, size_t num_tris) {
+    for (size_t t = 0; t < num_tris; t++) {
+        mikk_tri *tri = &mc->tris[t];
+        const mikk_vertex *v1 = &mc->vertices[mc->tri_verts[t * 3 + 0]];
+        const mikk_vertex *v2 = &mc->vertices[mc->tri_verts[t * 3 + 1]];
+        const mikk_vertex *v3 = &mc->vertices[mc->tri_verts[t * 3 + 2]];
+        for (int i = 0; i < 3; i++) {
+            tri->neighbors[i] = -1;
+            tri->groups[i] = -1;
+        }
+        tri->flags |= MIKK_GROUP_WITH_ANY;
+
+        float t21x = v2->uv[0] - v1->uv[0], t21y = v2->uv[1] - v1->uv[1];
+        float t31x = v3->uv[0] - v1->uv[0], t31y = v3->uv[1] - v1->uv[1];
+        mikk_vec3 d1 = mikk_sub(v2->position, v1->position);
+        mikk_vec3 d2 = mikk_sub(v3->position, v1->position);
+        float area = t21x * t31y - t21y * t31x;
+        mikk_vec3 os = mikk_sub(mikk_scale(t31y, d1), mikk_scale(t21y, d2));
+        mikk_vec3 ot = mikk_add(mikk_scale(-t31x, d1), mikk_scale(t21x, d2));
+        if (area > 0.0f) tri->flags |= MIKK_ORIENT_PRESERVING;
+
+        if (mikk_not_zero(area)) {
+            float abs_area = fabsf(area);
+            float len_os = mikk_length(os), len_ot = mikk_length(ot);
+            float sign = (tri->flags & MIKK_ORIENT_PRESERVING) ? 1.0f : -1.0f;
+            if (mikk_not_zero(len_os)) tri->os = mikk_scale(sign / len_os, os);
+            if (mikk_not_zero(len_ot)) tri->ot = mikk_scale(sign / len_ot, ot);
+            tri->mag_s = len_os / abs_area;
+            tri->mag_t = len_ot / abs_area;
+            if (mikk_not_zero(tri->mag_s) && mikk_not_zero(tri->mag_t)) {
+                tri->flags &= ~MIKK_GROUP_WITH_ANY;
+            }
+        }
+    }
+
+    for (size_t t = 0; t + 1 < num_tris; ) {
+        mikk_tri *a = &mc->tris[t], *b = &mc->tris[t + 1];
+        if (a->face != b->face) {
+            t++;
+            continue;
+        }
+        if ((a->flags ^ b->flags) & MIKK_ORIENT_PRESERVING) {
+            bool first = (b->flags & MIKK_GROUP_WITH_ANY) || mikk_uv_area(mc, t) >= mikk_uv_area(mc, t + 1);
+            const mikk_tri *src = first ? a : b;
+            mikk_tri *dst = first ? b : a;
+            dst->flags = (dst->flags & ~MIKK_ORIENT_PRESERVING) | (src->flags & MIKK_ORIENT_PRESERVING);
+        }
+        t += 2;
+    }
+}
+
+// Helper: Pair up the good triangles sharing an edge in opposite directions
+static void mikk_build_neighbors(mikk_context *mc, size_t num_tris) {
+    size_t num_edges = num_tris * 3;
+    for (size_t t = 0; t < num_tris; t++) {
+        for (uint32_t i = 0; i < 3; i++) {
+            mikk_edge *e = &mc->edges[t * 3 + i];
+            e->a = mc->tri_verts[t * 3 + i];
+            e->b = mc->tri_verts[t * 3 + (i + 1) % 3];
+            e->i0 = e->a < e->b ? e->a : e->b;
+            e->i1 = e->a < e->b ? e->b : e->a;
+            e->tri = (uint32_t)t;
+            e->edge = i;
+        }
+    }
+    qsort(mc->edges, num_edges, sizeof(mikk_edge), compare_mikk_edges);
+
+    for (size_t i = 0; i < num_edges; i++) {
+        const mikk_edge *ea = &mc->edges[i];
+        if (mc->tris[ea->tri].neighbors[ea->edge] != -1) continue;
+        for (size_t j = i + 1; j < num_edges; j++) {
+            const mikk_edge *eb = &mc->edges[j];
+            if (eb->i0 != ea->i0 || eb->i1 != ea->i1) break;
+            if (eb->a == ea->b && eb->b == ea->a && mc->tris[eb->tri].neighbors[eb->edge] == -1) {
+                mc->tris[ea->tri].neighbors[ea->edge] = (int32_t)eb->tri;
+                mc->tris[eb->tri].neighbors[eb->edge] = (int32_t)ea->tri;
+                break;
+            }
+        }
+    }
+}
+
+// Helper: Grow group `g` from its first triangle `t` through the edges at its
+// vertex, depth first: left neighbor, then right
+static void mikk_grow_group(mikk_context *mc, uint32_t g, uint32_t t) {
+    mikk_group *group = &mc->groups[g];
+    size_t num_stack = 0;
+    int corner = mikk_tri_corner(mc, t, group->vertex);
+    const mikk_tri *first = &mc->tris[t];
+    if (first->neighbors[corner > 0 ? corner - 1 : 2] >= 0) {
+        mc->stack[num_stack++] = (uint32_t)first->neighbors[corner > 0 ? corner - 1 : 2];
+    }
+    if (first->neighbors[corner] >= 0) {
+        mc->stack[num_stack++] = (uint32_t)first->neighbors[corner];
+    }
+
+    while (num_stack > 0) {
+        uint32_t m = mc->stack[--num_stack];
+        mikk_tri *tri = &mc->tris[m];
+        int i = mikk_tri_corner(mc, m, group->vertex);
+        if (i < 0 || tri->groups[i] != -1) continue;
+        if ((tri->flags & MIKK_GROUP_WITH_ANY) &&
+            tri->groups[0] == -1 && tri->groups[1] == -1 && tri->groups[2] == -1) {
+            // The first group to reach it decides its orientation
+            tri->flags &= ~MIKK_ORIENT_PRESERVING;
+            if (group->orient) tri->flags |= MIKK_ORIENT_PRESERVING;
+        }
+        if (((tri->flags & MIKK_ORIENT_PRESERVING) != 0) != group->orient) continue;
+
+        mc->group_tris[group->first + group->count++] = m;
+        tri->groups[i] = (int32_t)g;
+        if (tri->neighbors[i > 0 ? i - 1 : 2] >= 0) {
+            mc->stack[num_stack++] = (uint32_t)tri->neighbors[i > 0 ? i - 1 : 2];
+        }
+        if (tri->neighbors[i] >= 0) {
+            mc->stack[num_stack++] = (uint32_t)tri->neighbors[i];
+        }
+    }
+}
+
+// Helper: Start a group at every corner of a good triangle with a UV gradient
+// that no group has reached yet. Returns the number of groups.
+static size_t mikk_build_groups(mikk_context *mc, size_t num_tris) {
+    size_t num_groups = 0, offset = 0;
+    for (size_t t = 0; t < num_tris; t++) {
+        for (int i = 0; i < 3; i++) {
+            mikk_tri *tri = &mc->tris[t];
+            if ((tri->flags & MIKK_GROUP_WITH_ANY) || tri->groups[i] != -1) continue;
+            mikk_group *group = &mc->groups[num_groups];
+            group->vertex = mc->tri_verts[t * 3 + i];
+            group->orient = (tri->flags & MIKK_ORIENT_PRESERVING) != 0;
+            group->first = (uint32_t)offset;
+            group->count = 1;
+            mc->group_tris[offset] = (uint32_t)t;
+            tri->groups[i] = (int32_t)num_groups;
+            mikk_grow_group(mc, (uint32_t)num_groups, (uint32_t)t);
+            offset += group->count;
+            num_groups++;
+        }
+    }
+    return num_groups;
+}
+
+// Helper: Tangent space of a subgroup at `vertex`: the projected UV gradients
+// of its triangles weighted by the corner angle
+static mikk_tspace mikk_eval_tspace(const mikk_context *mc, const uint32_t *tris, size_t count,
+                                    uint32_t vertex) {
+    mikk_tspace res = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, 0.0f, 0.0f, 0, false };
+    float angle_sum = 0.0f;
+    for (size_t k = 0; k < count; k++) {
+        const mikk_tri *tri = &mc->tris[tris[k]];
+        if (tri->flags & MIKK_GROUP_WITH_ANY) continue;
+        int i = mikk_tri_corner(mc, tris[k], vertex);
+        if (i < 0) continue;
+
+        const uint32_t *verts = mc->tri_verts + tris[k] * 3;
+        mikk_vec3 n = mc->vertices[verts[i]].normal;
+        mikk_vec3 os = mikk_project(n, tri->os);
+        mikk_vec3 ot = mikk_project(n, tri->ot);
+        mikk_vec3 p0 = mc->vertices[verts[i > 0 ? i - 1 : 2]].position;
+        mikk_vec3 p1 = mc->vertices[verts[i]].position;
+        mikk_vec3 p2 = mc->vertices[verts[i < 2 ? i + 1 : 0]].position;
+        mikk_vec3 v1 = mikk_project(n, mikk_sub(p0, p1));
+        mikk_vec3 v2 = mikk_project(n, mikk_sub(p2, p1));
+        float cos_angle = mikk_dot(v1, v2);
+        cos_angle = cos_angle > 1.0f ? 1.0f : cos_angle < -1.0f ? -1.0f : cos_angle;
+        float angle = (float)acos(cos_angle);
+
+        res.os = mikk_add(res.os, mikk_scale(angle, os));
+        res.ot = mikk_add(res.ot, mikk_scale(angle, ot));
+        res.mag_s += angle * tri->mag_s;
+        res.mag_t += angle * tri->mag_t;
+        angle_sum += angle;
+    }
+    res.os = mikk_normalize_not_zero(res.os);
+    res.ot = mikk_normalize_not_zero(res.ot);
+    if (angle_sum > 0.0f) {
+        res.mag_s /= angle_sum;
+        res.mag_t /= angle_sum;
+    }
+    return res;
+}
+
+// Helper: Accumulate subgroup tangent space `ts` into slot `dst`. The corners
+// on a quad's diagonal get one from each triangle, which are averaged.
+static void mikk_store_tspace(mikk_tspace *dst, const mikk_tspace *ts, bool orient) {
+    if (dst->counter == 1) {
+        if (dst->mag_s != ts->mag_s || dst->mag_t != ts->mag_t ||
+            !mikk_equal(dst->os, ts->os) || !mikk_equal(dst->ot, ts->ot)) {
+            // Averaging equal spaces would drift and split them later on
+            dst->mag_s = 0.5f * (dst->mag_s + ts->mag_s);
+            dst->mag_t = 0.5f * (dst->mag_t + ts->mag_t);
+            dst->os = mikk_normalize_not_zero(mikk_add(dst->os, ts->os));
+            dst->ot = mikk_normalize_not_zero(mikk_add(dst->ot, ts->ot));
+        }
+        dst->counter = 2;
+    } else {
+        *dst = *ts;
+        dst->counter = 1;
+    }
+    dst->orient = orient;
+}
+
+// Helper: Split each group into subgroups of triangles whose projected UV
+// gradients agree (with the default 180 degree threshold, all but exactly
+// opposite ones) and give each corner the tangent space of its subgroup.
+// Returns 0 on allocation failure.
+static int mikk_generate_tspaces(mikk_context *mc, size_t num_groups) {
+    const float thres_cos = -1.0f;  // cos(180 degrees)
+    for (size_t g = 0; g < num_groups; g++) {
+        const mikk_group *group = &mc->groups[g];
+        const uint32_t *group_tris = mc->group_tris + group->first;
+        size_t num_subgroups = 0, num_members = 0;
+
+        for (size_t k = 0; k < group->count; k++) {
+            uint32_t f = group_tris[k];
+            const mikk_tri *tri = &mc->tris[f];
+            int index = tri->groups[0] == (int32_t)g ? 0 : tri->groups[1] == (int32_t)g ? 1 : 2;
+            mikk_vec3 n = mc->vertices[group->vertex].normal;
+            mikk_vec3 os = mikk_project(n, tri->os);
+            mikk_vec3 ot = mikk_project(n, tri->ot);
+
+            // The candidate subgroup goes after the stored ones
+            if (num_members + group->count > mc->members_cap) {
+                size_t cap = mc->members_cap * 2 > num_members + group->count
+                    ? mc->members_cap * 2 : num_members + group->count;
+                uint32_t *members = (uint32_t*)enif_realloc(mc->members, cap * sizeof(uint32_t));
+                if (!members) return 0;
+                mc->members = members;
+                mc->members_cap = cap;
+            }
+            uint32_t *candidate = mc->members + num_members;
+            size_t count = 0;
+            for (size_t j = 0; j < group->count; j++) {
+                const mikk_tri *other = &mc->tris[group_tris[j]];
+                bool any = ((tri->flags | other->flags) & MIKK_GROUP_WITH_ANY) != 0;
+                float cos_s = mikk_dot(os, mikk_project(n, other->os));
+                float cos_t = mikk_dot(ot, mikk_project(n, other->ot));
+                if (any || tri->face == other->face || (cos_s > thres_cos && cos_t > thres_cos)) {
+                    candidate[count++] = group_tris[j];
+                }
+            }
+            qsort(candidate, count, sizeof(uint32_t), compare_uint32s);
+
+            size_t l = 0;
+            for (; l < num_subgroups; l++) {
+                const mikk_subgroup *sub = &mc->subgroups[l];
+                if (sub->count == count &&
+                    memcmp(mc->members + sub->first, candidate, count * sizeof(uint32_t)) == 0) {
+                    break;
+                }
+            }
+            if (l == num_subgroups) {
+                mikk_subgroup *sub = &mc->subgroups[num_subgroups++];
+                sub->first = (uint32_t)num_members;
+                sub->count = (uint32_t)count;
+                sub->tspace = mikk_eval_tspace(mc, candidate, count, group->vertex);
+                num_members += count;
+            }
+
+            mikk_tspace *dst = &mc->tspaces[tri->slot + tri->corners[index]];
+            mikk_store_tspace(dst, &mc->subgroups[l].tspace, group->orient);
+        }
+    }
+    return 1;
+}
+
+// Helper: Give the corners of degenerate triangles the tangent space of the
+// first good corner at the same welded vertex, and the corner a quad's
+// degenerate triangle leaves out that of a corner at the same position
+static void mikk_degenerate_epilogue(mikk_context *mc, size_t num_good, size_t num_tris,
+                                     size_t num_vertices) {
+    for (size_t i = 0; i < num_vertices; i++) {
+        mc->first_corner[i] = UINT32_MAX;
+    }
+    for (size_t i = num_good * 3; i-- > 0; ) {
+        mc->first_corner[mc->tri_verts[i]] = (uint32_t)i;
+    }
+
+    for (size_t t = num_good; t < num_tris; t++) {
+        const mikk_tri *tri = &mc->tris[t];
+        if (tri->flags & MIKK_QUAD_ONE_DEGENERATE) continue;
+        for (int i = 0; i < 3; i++) {
+            uint32_t src = mc->first_corner[mc->tri_verts[t * 3 + i]];
+            if (src == UINT32_MAX) continue;
+            const mikk_tri *src_tri = &mc->tris[src / 3];
+            mc->tspaces[tri->slot + tri->corners[i]] =
+                mc->tspaces[src_tri->slot + src_tri->corners[src % 3]];
+        }
+    }
+
+    for (size_t t = 0; t < num_good; t++) {
+        const mikk_tri *tri = &mc->tris[t];
+        if (!(tri->flags & MIKK_QUAD_ONE_DEGENERATE)) continue;
+        int used = (1 << tri->corners[0]) | (1 << tri->corners[1]) | (1 << tri->corners[2]);
+        uint32_t missing = !(used & 2) ? 1 : !(used & 4) ? 2 : !(used & 8) ? 3 : 0;
+        mikk_vec3 dst = mc->vertices[mc->welded[tri->slot + missing]].position;
+        for (int i = 0; i < 3; i++) {
+            uint32_t slot = tri->slot + tri->corners[i];
+            if (mikk_equal(mc->vertices[mc->welded[slot]].position, dst)) {
+                mc->tspaces[tri->slot + missing] = mc->tspaces[slot];
+                break;
+            }
+        }
+    }
+}
+
+// Helper: Load the corner data of mesh index `ix` as MikkTSpace sees it
+static void mikk_load_vertex(const ufbx_mesh *mesh, const ufbx_vertex_vec3 *normals, uint32_t ix,
+                             mikk_vertex *v) {
+    ufbx_vec3 p = ufbx_get_vertex_vec3(&mesh->vertex_position, ix);
+    ufbx_vec3 n = ufbx_get_vertex_vec3(normals, ix);
+    ufbx_vec2 uv = ufbx_get_vertex_vec2(&mesh->vertex_uv, ix);
+    // Adding zero turns -0 into +0, welding compares bytes
+    v->position.x = (float)p.x + 0.0f;
+    v->position.y = (float)p.y + 0.0f;
+    v->position.z = (float)p.z + 0.0f;
+    v->normal.x = (float)n.x + 0.0f;
+    v->normal.y = (float)n.y + 0.0f;
+    v->normal.z = (float)n.z + 0.0f;
+    v->uv[0] = (float)uv.x + 0.0f;
+    v->uv[1] = (float)uv.y + 0.0f;
+}
+
+// Generate MikkTSpace tangents for every index of `mesh`, 4 floats per mesh
+// index in `out`: the tangent and the bitangent sign `w`, so the bitangent is
+// `w * cross(normal, tangent)`. Triangles and quads are MikkTSpace faces of
+// their own, ngons are split with `ufbx_triangulate_face()` and each triangle
+// is a face, like Blender does. Corners without a usable UV gradient get
+// `(1, 0, 0, -1)` as in the reference. Requires positions and texcoords.
+// Returns 0 on allocation failure.
+static int generate_mikktspace_tangents(const ufbx_mesh *mesh, const ufbx_vertex_vec3 *normals,
+                                        float *out) {
+    mikk_context mc = { 0 };
+    size_t max_tris = mesh->num_triangles;
+    size_t max_slots = max_tris * 3;
+    size_t num_tri_indices = mesh->max_face_triangles * 3;
+    mc.slot_index = (uint32_t*)enif_alloc((max_slots + 1) * sizeof(uint32_t));
+    mc.vertices = (mikk_vertex*)enif_alloc((max_slots + 1) * sizeof(mikk_vertex));
+    mc.welded = (uint32_t*)enif_alloc((max_slots + 1) * sizeof(uint32_t));
+    mc.tspaces = (mikk_tspace*)enif_alloc((max_slots + 1) * sizeof(mikk_tspace));
+    mc.tris = (mikk_tri*)enif_alloc((max_tris + 1) * sizeof(mikk_tri));
+    mc.tri_verts = (uint32_t*)enif_alloc((max_tris * 3 + 1) * sizeof(uint32_t));
+    mc.edges = (mikk_edge*)enif_alloc((max_tris * 3 + 1) * sizeof(mikk_edge));
+    mc.groups = (mikk_group*)enif_alloc((max_tris * 3 + 1) * sizeof(mikk_group));
+    mc.group_tris = (uint32_t*)enif_alloc((max_tris * 3 + 1) * sizeof(uint32_t));
+    mc.stack = (uint32_t*)enif_alloc((max_tris * 2 + 2) * sizeof(uint32_t));
+    mc.first_corner = (uint32_t*)enif_alloc((max_slots + 1) * sizeof(uint32_t));
+    mc.tri_indices = (uint32_t*)enif_alloc((num_tri_indices + 1) * sizeof(uint32_t));
+    mc.subgroups = (mikk_subgroup*)enif_alloc((max_tris + 1) * sizeof(mikk_subgroup));
+    mc.members_cap = max_tris + 1;
+    mc.members = (uint32_t*)enif_alloc(mc.members_cap * sizeof(uint32_t));
+    if (!mc.slot_index || !mc.vertices || !mc.welded || !mc.tspaces || !mc.tris ||
+        !mc.tri_verts || !mc.edges || !mc.groups || !mc.group_tris || !mc.stack ||
+        !mc.first_corner || !mc.tri_indices || !mc.subgroups || !mc.members) {
+        free_mikk_context(&mc);
+        return 0;
+    }
+
+    // Faces, splitting quads along the shorter UV diagonal (position on ties)
+    size_t num_slots = 0, num_tris = 0;
+    uint32_t num_faces = 0;
+    for (size_t f = 0; f < mesh->faces.count; f++) {
+        ufbx_face face = mesh->faces.data[f];
+        if (face.num_indices < 3) continue;
+        bool ngon = face.num_indices > 4;
+        uint32_t num_corners = ngon ? 3 : face.num_indices;
+        uint32_t num_parts = ngon ? ufbx_triangulate_face(mc.tri_indices, num_tri_indices, mesh, face) : 1;
+        for (uint32_t p = 0; p < num_parts; p++) {
+            uint32_t slot = (uint32_t)num_slots;
+            for (uint32_t c = 0; c < num_corners; c++) {
+                uint32_t ix = ngon ? mc.tri_indices[p * 3 + c] : face.index_begin + c;
+                mc.slot_index[num_slots] = ix;
+                mikk_load_vertex(mesh, normals, ix, &mc.vertices[num_slots]);
+                num_slots++;
+            }
+            if (num_corners == 3) {
+                mikk_add_tri(&mc, num_tris++, num_faces, slot, 0, 1, 2);
+            } else {
+                const mikk_vertex *v = mc.vertices + slot;
+                float du02 = v[2].uv[0] - v[0].uv[0], dv02 = v[2].uv[1] - v[0].uv[1];
+                float du13 = v[3].uv[0] - v[1].uv[0], dv13 = v[3].uv[1] - v[1].uv[1];
+                float dist02 = du02 * du02 + dv02 * dv02, dist13 = du13 * du13 + dv13 * dv13;
+                bool diagonal02 = dist02 < dist13;
+                if (dist02 == dist13) {
+                    mikk_vec3 p02 = mikk_sub(v[2].position, v[0].position);
+                    mikk_vec3 p13 = mikk_sub(v[3].position, v[1].position);
+                    diagonal02 = !(mikk_dot(p13, p13) < mikk_dot(p02, p02));
+                }
+                if (diagonal02) {
+                    mikk_add_tri(&mc, num_tris++, num_faces, slot, 0, 1, 2);
+                    mikk_add_tri(&mc, num_tris++, num_faces, slot, 0, 2, 3);
+                } else {
+                    mikk_add_tri(&mc, num_tris++, num_faces, slot, 0, 1, 3);
+                    mikk_add_tri(&mc, num_tris++, num_faces, slot, 1, 2, 3);
+                }
+            }
+            num_faces++;
+        }
+    }
+
+    for (size_t s = 0; s < num_slots; s++) {
+        mikk_tspace *ts = &mc.tspaces[s];
+        memset(ts, 0, sizeof(*ts));
+        ts->os.x = 1.0f;
+        ts->ot.y = 1.0f;
+        ts->mag_s = 1.0f;
+        ts->mag_t = 1.0f;
+    }
+
+    // Weld corners with identical position, normal and UV
+    ufbx_vertex_stream stream = { mc.vertices, num_slots, sizeof(mikk_vertex) };
+    ufbx_error error;
+    size_t num_vertices = ufbx_generate_indices(&stream, 1, mc.welded, num_slots, NULL, &error);
+    if (error.type != UFBX_ERROR_NONE) {
+        free_mikk_context(&mc);
+        return 0;
+    }
+    for (size_t i = 0; i < num_tris * 3; i++) {
+        mc.tri_verts[i] = mc.welded[mc.tri_verts[i]];
+    }
+
+    // Mark degenerate triangles and the quads left with one good triangle,
+    // then move the degenerate ones last keeping the good ones in order
+    size_t num_good = 0;
+    for (size_t t = 0; t < num_tris; t++) {
+        mikk_vec3 p0 = mc.vertices[mc.tri_verts[t * 3 + 0]].position;
+        mikk_vec3 p1 = mc.vertices[mc.tri_verts[t * 3 + 1]].position;
+        mikk_vec3 p2 = mc.vertices[mc.tri_verts[t * 3 + 2]].position;
+        if (mikk_equal(p0, p1) || mikk_equal(p0, p2) || mikk_equal(p1, p2)) {
+            mc.tris[t].flags |= MIKK_DEGENERATE;
+        }
+    }
+    for (size_t t = 0; t + 1 < num_tris; ) {
+        mikk_tri *a = &mc.tris[t], *b = &mc.tris[t + 1];
+        if (a->face != b->face) {
+            t++;
+            continue;
+        }
+        if ((a->flags ^ b->flags) & MIKK_DEGENERATE) {
+            a->flags |= MIKK_QUAD_ONE_DEGENERATE;
+            b->flags |= MIKK_QUAD_ONE_DEGENERATE;
+        }
+        t += 2;
+    }
+    for (size_t t = 0; t < num_tris; t++) {
+        if (mc.tris[t].flags & MIKK_DEGENERATE) continue;
+        if (t != num_good) {
+            mikk_tri tri = mc.tris[t];
+            uint32_t verts[3];
+            memcpy(verts, mc.tri_verts + t * 3, sizeof(verts));
+            mc.tris[t] = mc.tris[num_good];
+            memcpy(mc.tri_verts + t * 3, mc.tri_verts + num_good * 3, sizeof(verts));
+            mc.tris[num_good] = tri;
+            memcpy(mc.tri_verts + num_good * 3, verts, sizeof(verts));
+        }
+        num_good++;
+    }
+
+    mikk_init_tris(&mc, num_good);
+    mikk_build_neighbors(&mc, num_good);
+    size_t num_groups = mikk_build_groups(&mc, num_good);
+    if (!mikk_generate_tspaces(&mc, num_groups)) {
+        free_mikk_context(&mc);
+        return 0;
+    }
+    mikk_degenerate_epilogue(&mc, num_good, num_tris, num_vertices);
+
+    for (size_t s = 0; s < num_slots; s++) {
+        const mikk_tspace *ts = &mc.tspaces[s];
+        float *dst = out + (size_t)mc.slot_index[s] * 4;
+        dst[0] = ts->os.x;
+        dst[1] = ts->os.y;
+        dst[2] = ts->os.z;
+        dst[3] = ts->orient ? 1.0f : -1.0f;
+    }
+
+    free_mikk_context(&mc);
+    return 1;
+}
+
+// Triangulate every face of `mesh`, grouped by material part, and merge
+// identical vertices with `ufbx_generate_indices()`. Vertices of different control points are never
+// merged so that per-vertex data (e.g. skin weights) can be looked up through
+// `vertex_indices`. With `generate_tangents` meshes with UVs get MikkTSpace
+// tangents, replacing any in the file, and smooth normals if they have none.
+// Returns 0 on allocation failure.
+static int build_render_mesh(const ufbx_mesh *mesh, bool generate_tangents, render_mesh *rm) {
+    memset(rm, 0, sizeof(*rm));
+    generate_tangents = generate_tangents && mesh->vertex_uv.exists && mesh->vertex_position.exists;
+    
+    int has_attribute[RENDER_ATTRIBUTE_COUNT] = {
+        mesh->vertex_position.exists,
+        mesh->vertex_normal.exists || generate_tangents,
+        mesh->vertex_uv.exists,
+        mesh->vertex_color.exists,
+        mesh->vertex_tangent.exists || generate_tangents,
+    };
+    for (int i = 0; i < RENDER_ATTRIBUTE_COUNT; i++) {
+        rm->offsets[i] = RENDER_NO_ATTRIBUTE;
+        if (has_attribute[i]) {
+            rm->offsets[i] = rm->stride;
+            rm->stride += render_attribute_components[i];
+        }
+    }
+    if (!mesh->vertex_position.exists || mesh->num_triangles == 0) {
+        return 1;
+    }
+    
+    ufbx_vertex_vec3 generated_normals = { 0 };
+    const ufbx_vertex_vec3 *normals = &mesh->vertex_normal;
+    if (generate_tangents && !mesh->vertex_normal.exists) {
+        if (!compute_render_normals(mesh, &generated_normals)) {
+            return 0;
+        }
+        normals = &generated_normals;
+    }
+    float *tangents = NULL;
+    if (generate_tangents) {
+        tangents = (float*)enif_alloc(mesh->num_indices * 4 * sizeof(float));
+        if (!tangents || !generate_mikktspace_tangents(mesh, normals, tangents)) {
+            if (tangents) enif_free(tangents);
+            free_vertex_vec3(&generated_normals);
+            return 0;
+        }
+    }
+    
+    size_t max_corners = mesh->num_triangles * 3;
+    size_t num_tri_indices = mesh->max_face_triangles * 3;
+    uint32_t *tri_indices = (uint32_t*)enif_alloc(num_tri_indices * sizeof(uint32_t));
+    rm->vertices = (ufbx_real*)enif_alloc(max_corners * rm->stride * sizeof(ufbx_real));
+    rm->vertex_indices = (uint32_t*)enif_alloc(max_corners * sizeof(uint32_t));
+    rm->indices = (uint32_t*)enif_alloc(max_corners * sizeof(uint32_t));
+    rm->parts = (render_part*)enif_alloc((mesh->material_parts.count + 1) * sizeof(render_part));
+    if (!tri_indices || !rm->vertices || !rm->vertex_indices || !rm->indices || !rm->parts) {
+        if (tri_indices) enif_free(tri_indices);
+        if (tangents) enif_free(tangents);
+        free_render_mesh(rm);
+        free_vertex_vec3(&generated_normals);
+        return 0;
+    }
+    
+    size_t num_corners = 0;
+    for (size_t i = 0; i < mesh->material_parts.count; i++) {
+        const ufbx_mesh_part *part = &mesh->material_parts.data[i];
+        if (part->num_triangles == 0) continue;
+        
+        render_part *rp = &rm->parts[rm->num_parts++];
+        rp->material = part->index;
+        rp->index_offset = num_corners;
+        for (size_t j = 0; j < part->face_indices.count; j++) {
+            ufbx_face face = mesh->faces.data[part->face_indices.data[j]];
+            uint32_t num_tris = ufbx_triangulate_face(tri_indices, num_tri_indices, mesh, face);
+            for (size_t k = 0; k < (size_t)num_tris * 3; k++) {
+                uint32_t ix = tri_indices[k];
+                write_render_vertex(mesh, normals, tangents, rm, ix, rm->vertices + num_corners * rm->stride);
+                rm->vertex_indices[num_corners] = mesh->vertex_indices.data[ix];
+                num_corners++;
+            }
+        }
+        rp->num_indices = num_corners - rp->index_offset;
+    }
+    enif_free(tri_indices);
+    if (tangents) enif_free(tangents);
+    free_vertex_vec3(&generated_normals);
+    
+    // Compacts both streams in place, the same vertex is kept in both
+    ufbx_vertex_stream streams[2] = {
+        { rm->vertices, num_corners, rm->stride * sizeof(ufbx_real) },
+        { rm->vertex_indices, num_corners, sizeof(uint32_t) },
+    };
+    ufbx_error error;
+    rm->num_vertices = ufbx_generate_indices(streams, 2, rm->indices, num_corners, NULL, &error);
+    rm->num_indices = num_corners;
+    if (error.type != UFBX_ERROR_NONE) {
+        free_render_mesh(rm);
+        return 0;
+    }
+    return 1;
+}
+
+// Post-transform vertex cache efficiency of an index buffer, simulated with a
+// FIFO cache: ACMR is cache misses per triangle, ATVR misses per vertex.
+typedef struct render_cache_stats {
+    double acmr;
+    double atvr;
+} render_cache_stats;
+
+static render_cache_stats measure_vertex_cache(const uint32_t *indices, size_t num_indices, size_t num_vertices,
+                                               size_t cache_size, uint32_t *timestamps) {
+    render_cache_stats stats = { 0.0, 0.0 };
+    if (num_indices < 3 || num_vertices == 0) {
+        return stats;
+    }
+    
+    // A vertex is cached if it was loaded within the last `cache_size` misses
+    memset(timestamps, 0, num_vertices * sizeof(uint32_t));
+    uint32_t time = (uint32_t)cache_size + 1;
+    size_t misses = 0;
+    for (size_t i = 0; i < num_indices; i++) {
+        uint32_t v = indices[i];
+        if (time - timestamps[v] > cache_size) {
+            timestamps[v] = time++;
+            misses++;
+        }
+    }
+    stats.acmr = (double)misses / (double)(num_indices / 3);
+    stats.atvr = (double)misses / (double)num_vertices;
+    return stats;
+}
+
+// Scratch buffers for `tipsify()`: per vertex and per index of the whole mesh
+typedef struct tipsify_scratch {
+    uint32_t *counts;       // Triangles using each vertex
+    uint32_t *live;         // Triangles using each vertex that are not emitted yet
+    uint32_t *offsets;      // Start of each vertex's triangles in `adjacency`
+    uint32_t *timestamps;
+    uint32_t *adjacency;
+    uint32_t *dead_ends;    // Stack of emitted vertices to restart from
+    uint32_t *candidates;
+    uint32_t *output;
+    unsigned char *emitted; // Per triangle
+} tipsify_scratch;
+
+// Reorder triangles for a vertex cache of `cache_size` entries with Tipsify
+// (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality
+// and Reduced Overdraw", 2007). Triangles are emitted in fans around one
+// vertex at a time; the next fanning vertex is picked among the vertices just
+// emitted, preferring ones whose remaining triangles still hit the cache.
+// Linear in the number of indices and touches only the vertices they use.
+static void tipsify(uint32_t *indices, size_t num_indices, size_t cache_size, const tipsify_scratch *sc) {
+    size_t num_tris = num_indices / 3;
+    if (num_tris == 0) {
+        return;
+    }
+    
+    // Triangle adjacency of each vertex
+    for (size_t i = 0; i < num_indices; i++) {
+        uint32_t v = indices[i];
+        sc->counts[v] = 0;
+        sc->live[v] = 0;
+        sc->offsets[v] = UINT32_MAX;
+        sc->timestamps[v] = 0;
+    }
+    for (size_t i = 0; i < num_indices; i++) {
+        sc->counts[indices[i]]++;
+    }
+    uint32_t offset = 0;
+    for (size_t i = 0; i < num_indices; i++) {
+        uint32_t v = indices[i];
+        if (sc->offsets[v] == UINT32_MAX) {
+            sc->offsets[v] = offset;
+            offset += sc->counts[v];
+        }
+    }
+    for (size_t i = 0; i < num_indices; i++) {
+        uint32_t v = indices[i];
+        sc->adjacency[sc->offsets[v] + sc->live[v]++] = (uint32_t)(i / 3);
+    }
+    memset(sc->emitted, 0, num_tris);
+    
+    uint32_t time = (uint32_t)cache_size + 1;
+    size_t num_dead_ends = 0;
+    size_t num_output = 0;
+    size_t cursor = 0; // Last resort: scan the input for a vertex with triangles left
+    int64_t fan = indices[0];
+    
+    while (fan >= 0) {
+        // Emit every remaining triangle around the fanning vertex
+        size_t num_candidates = 0;
+        const uint32_t *tris = sc->adjacency + sc->offsets[fan];
+        for (uint32_t i = 0; i < sc->counts[fan]; i++) {
+            uint32_t t = tris[i];
+            if (sc->emitted[t]) continue;
+            sc->emitted[t] = 1;
+            for (size_t c = 0; c < 3; c++) {
+                uint32_t v = indices[t * 3 + c];
+                sc->output[num_output++] = v;
+                sc->dead_ends[num_dead_ends++] = v;
+                sc->candidates[num_candidates++] = v;
+                sc->live[v]--;
+                if (time - sc->timestamps[v] > cache_size) {
+                    sc->timestamps[v] = time++;
+                }
+            }
+        }
+        
+        // Continue from the candidate that stays in the cache the longest
+        // while emitting its fan, or any candidate with triangles left
+        fan = -1;
+        int64_t best = -1;
+        for (size_t i = 0; i < num_candidates; i++) {
+            uint32_t v = sc->candidates[i];
+            if (sc->live[v] == 0) continue;
+            int64_t priority = 0;
+            if (time - sc->timestamps[v] + 2 * sc->live[v] <= cache_size) {
+                priority = time - sc->timestamps[v];
+            }
+            if (priority > best) {
+                best = priority;
+                fan = v;
+            }
+        }
+        while (fan < 0 && num_dead_ends > 0) {
+            uint32_t v = sc->dead_ends[--num_dead_ends];
+            if (sc->live[v] > 0) fan = v;
+        }
+        while (fan < 0 && cursor < num_indices) {
+            uint32_t v = indices[cursor++];
+            if (sc->live[v] > 0) fan = v;
+        }
+    }
+    
+    memcpy(indices, sc->output, num_output * sizeof(uint32_t));
+}
+
+// Renumber vertices in the order the index buffer first uses them, so vertex
+// fetches walk the vertex buffer sequentially. Returns 0 on allocation failure.
+static int reorder_render_vertices(render_mesh *rm) {
+    uint32_t *remap = (uint32_t*)enif_alloc(rm->num_vertices * sizeof(uint32_t));
+    ufbx_real *vertices = (ufbx_real*)enif_alloc(rm->num_vertices * rm->stride * sizeof(ufbx_real));
+    uint32_t *vertex_indices = (uint32_t*)enif_alloc(rm->num_vertices * sizeof(uint32_t));
+    if (!remap || !vertices || !vertex_indices) {
+        if (remap) enif_free(remap);
+        if (vertices) enif_free(vertices);
+        if (vertex_indices) enif_free(vertex_indices);
+        return 0;
+    }
+    
+    memset(remap, 0xff, rm->num_vertices * sizeof(uint32_t));
+    uint32_t next = 0;
+    for (size_t i = 0; i < rm->num_indices; i++) {
+        uint32_t v = rm->indices[i];
+        if (remap[v] == UINT32_MAX) {
+            memcpy(vertices + next * rm->stride, rm->vertices + v * rm->stride, rm->stride * sizeof(ufbx_real));
+            vertex_indices[next] = rm->vertex_indices[v];
+            remap[v] = next++;
+        }
+        rm->indices[i] = remap[v];
+    }
+    
+    enif_free(remap);
+    enif_free(rm->vertices);
+    enif_free(rm->vertex_indices);
+    rm->vertices = vertices;
+    rm->vertex_indices = vertex_indices;
+    rm->num_vertices = next;
+    return 1;
+}
+
+// Helper: Allocate `tipsify()` scratch for `nv` vertices and `ni` indices in
+// one block, released with `enif_free(sc->counts)`
+static int alloc_tipsify_scratch(tipsify_scratch *sc, size_t nv, size_t ni) {
+    sc->counts = (uint32_t*)enif_alloc((nv * 4 + ni * 4) * sizeof(uint32_t) + ni / 3 + 1);
+    if (!sc->counts) {
+        return 0;
+    }
+    sc->live = sc->counts + nv;
+    sc->offsets = sc->live + nv;
+    sc->timestamps = sc->offsets + nv;
+    sc->adjacency = sc->timestamps + nv;
+    sc->dead_ends = sc->adjacency + ni;
+    sc->candidates = sc->dead_ends + ni;
+    sc->output = sc->candidates + ni;
+    sc->emitted = (unsigned char*)(sc->output + ni);
+    return 1;
+}
+
+// Optimize a render mesh for the post-transform vertex cache: reorder the
+// triangles of each draw range with `tipsify()`, then the vertices for fetch
+// locality. Draw ranges keep their offsets. Returns 0 on allocation failure.
+static int optimize_render_mesh(render_mesh *rm, size_t cache_size,
+                                render_cache_stats *before, render_cache_stats *after) {
+    size_t nv = rm->num_vertices, ni = rm->num_indices;
+    tipsify_scratch sc;
+    if (!alloc_tipsify_scratch(&sc, nv, ni)) {
+        return 0;
+    }
+    
+    *before = measure_vertex_cache(rm->indices, ni, nv, cache_size, sc.timestamps);
+    for (size_t i = 0; i < rm->num_parts; i++) {
+        tipsify(rm->indices + rm->parts[i].index_offset, rm->parts[i].num_indices, cache_size, &sc);
+    }
+    
+    if (!reorder_render_vertices(rm)) {
+        enif_free(sc.counts);
+        return 0;
+    }
+    *after = measure_vertex_cache(rm->indices, rm->num_indices, rm->num_vertices, cache_size, sc.timestamps);
+    enif_free(sc.counts);
+    return 1;
+}
+
+// Level of detail of a render mesh: an index buffer over the same vertices
+typedef struct render_lod {
+    uint32_t *indices;
+    render_part *parts;  // One range per `render_mesh.parts` entry, possibly empty
+    size_t num_indices;
+    double error;        // Largest collapse distance, relative to the mesh extent
+} render_lod;
+
+static void free_render_lods(render_lod *lods, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (lods[i].indices) enif_free(lods[i].indices);
+        if (lods[i].parts) enif_free(lods[i].parts);
+    }
+    memset(lods, 0, count * sizeof(render_lod));
+}
+
+// Quadric error metric (Garland and Heckbert, "Surface Simplification Using
+// Quadric Error Metrics", 1997): the upper triangle of a symmetric 4x4
+// matrix summing squared distances to planes, weighted by triangle area.
+typedef struct quadric {
+    double a00, a01, a02, a03, a11, a12, a13, a22, a23, a33;
+    double w;
+} quadric;
+
+static void quadric_add_plane(quadric *q, double nx, double ny, double nz, double d, double w) {
+    q->a00 += w * nx * nx; q->a01 += w * nx * ny; q->a02 += w * nx * nz; q->a03 += w * nx * d;
+    q->a11 += w * ny * ny; q->a12 += w * ny * nz; q->a13 += w * ny * d;
+    q->a22 += w * nz * nz; q->a23 += w * nz * d;
+    q->a33 += w * d * d;
+    q->w += w;
+}
+
+static void quadric_add(quadric *q, const quadric *r) {
+    q->a00 += r->a00; q->a01 += r->a01; q->a02 += r->a02; q->a03 += r->a03;
+    q->a11 += r->a11; q->a12 += r->a12; q->a13 += r->a13;
+    q->a22 += r->a22; q->a23 += r->a23;
+    q->a33 += r->a33;
+    q->w += r->w;
+}
+
+// Helper: Mean squared distance of `p` to the planes of `a` and `b` combined
+static double quadric_error(const quadric *a, const quadric *b, const ufbx_real *p) {
+    double x = p[0], y = p[1], z = p[2];
+    double w = a->w + b->w;
+    if (w <= 0.0) {
+        return 0.0;
+    }
+    double e = (a->a00 + b->a00) * x * x + 2.0 * (a->a01 + b->a01) * x * y + 2.0 * (a->a02 + b->a02) * x * z
+             + 2.0 * (a->a03 + b->a03) * x + (a->a11 + b->a11) * y * y + 2.0 * (a->a12 + b->a12) * y * z
+             + 2.0 * (a->a13 + b->a13) * y + (a->a22 + b->a22) * z * z + 2.0 * (a->a23 + b->a23) * z
+             + (a->a33 + b->a33);
+    return e > 0.0 ? e / w : 0.0;
+}
+
+static void triangle_normal(const ufbx_real *a, const ufbx_real *b, const ufbx_real *c, double *n) {
+    double ux = b[0] - a[0], uy = b[1] - a[1], uz = b[2] - a[2];
+    double vx = c[0] - a[0], vy = c[1] - a[1], vz = c[2] - a[2];
+    n[0] = uy * vz - uz * vy;
+    n[1] = uz * vx - ux * vz;
+    n[2] = ux * vy - uy * vx;
+}
+
+static size_t hash_table_size(size_t count) {
+    size_t size = 16;
+    while (size < count * 2) size *= 2;
+    return size;
+}
+
+// Helper: Map every vertex to the first vertex at the same position
+static int weld_render_positions(const render_mesh *rm, uint32_t *canonical) {
+    size_t size = hash_table_size(rm->num_vertices);
+    uint32_t *table = (uint32_t*)enif_alloc(size * sizeof(uint32_t));
+    if (!table) {
+        return 0;
+    }
+    memset(table, 0xff, size * sizeof(uint32_t));
+    
+    for (size_t v = 0; v < rm->num_vertices; v++) {
+        const unsigned char *p = (const unsigned char*)(rm->vertices + v * rm->stride + rm->offsets[RENDER_POSITION]);
+        uint64_t h = UINT64_C(14695981039346656037);
+        for (size_t i = 0; i < 3 * sizeof(ufbx_real); i++) {
+            h = (h ^ p[i]) * UINT64_C(1099511628211);
+        }
+        for (size_t i = (size_t)h & (size - 1); ; i = (i + 1) & (size - 1)) {
+            uint32_t other = table[i];
+            if (other == UINT32_MAX) {
+                table[i] = (uint32_t)v;
+                canonical[v] = (uint32_t)v;
+                break;
+            }
+            const void *q = rm->vertices + other * rm->stride + rm->offsets[RENDER_POSITION];
+            if (memcmp(p, q, 3 * sizeof(ufbx_real)) == 0) {
+                canonical[v] = other;
+                break;
+            }
+        }
+    }
+    enif_free(table);
+    return 1;
+}
+
+// Helper: Lock vertices on open or non-manifold edges. Edges are counted per
+// welded position pair, so UV and normal seams are not borders by themselves.
+static int lock_border_vertices(const render_mesh *rm, const uint32_t *canonical, unsigned char *locked) {
+    size_t size = hash_table_size(rm->num_indices);
+    uint64_t *keys = (uint64_t*)enif_alloc(size * sizeof(uint64_t));
+    uint32_t *counts = (uint32_t*)enif_alloc(size * sizeof(uint32_t));
+    if (!keys || !counts) {
+        if (keys) enif_free(keys);
+        if (counts) enif_free(counts);
+        return 0;
+    }
+    memset(keys, 0xff, size * sizeof(uint64_t));
+    
+    for (size_t i = 0; i < rm->num_indices; i++) {
+        uint32_t a = canonical[rm->indices[i]];
+        uint32_t b = canonical[rm->indices[i - i % 3 + (i + 1) % 3]];
+        uint64_t key = a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+        for (size_t j = (size_t)(key * UINT64_C(0x9E3779B97F4A7C15) >> 32) & (size - 1); ; j = (j + 1) & (size - 1)) {
+            if (keys[j] == UINT64_MAX) {
+                keys[j] = key;
+                counts[j] = 1;
+                break;
+            }
+            if (keys[j] == key) {
+                counts[j]++;
+                break;
+            }
+        }
+    }
+    for (size_t j = 0; j < size; j++) {
+        if (keys[j] != UINT64_MAX && counts[j] != 2) {
+            locked[keys[j] >> 32] = 1;
+            locked[keys[j] & UINT32_MAX] = 1;
+        }
+    }
+    
+    enif_free(keys);
+    enif_free(counts);
+    return 1;
+}
+
+typedef struct lod_collapse {
+    double cost;
+    uint32_t from, to;
+} lod_collapse;
+
+static int compare_lod_collapses(const void *a, const void *b) {
+    double ca = ((const lod_collapse*)a)->cost, cb = ((const lod_collapse*)b)->cost;
+    return (ca > cb) - (ca < cb);
+}
+
+// Working state of `simplify_render_mesh()`. Collapses move a whole welded
+// position, so most per-vertex arrays are only used at canonical vertices.
+typedef struct lod_state {
+    const render_mesh *rm;
+    uint32_t *indices;       // Live triangles, compacted per part
+    render_part *parts;
+    size_t num_tris;
+    uint32_t *canonical;     // First vertex at the same position
+    uint32_t *wedges;        // Next vertex at the same position, circular
+    uint32_t *joint;         // Dominant skin cluster
+    unsigned char *locked;
+    unsigned char *marked;   // Touched in the current pass
+    uint32_t *remap;         // Per vertex, reset every pass
+    quadric *quadrics;
+    uint32_t *adj_offsets;   // Triangles around each position, `num_vertices + 1` entries
+    uint32_t *adjacency;     // Per index
+    lod_collapse *collapses;
+    double max_error;
+} lod_state;
+
+static const ufbx_real *lod_position(const lod_state *st, uint32_t v) {
+    return st->rm->vertices + v * st->rm->stride + st->rm->offsets[RENDER_POSITION];
+}
+
+// Helper: Vertex of position `ct` sharing a live triangle with the wedge `w`
+// of position `cf`. Returns 1 and the vertex in `out`, 0 if `w` is unused, or
+// -1 if `w` never meets `ct`: moving it would tear a UV or normal seam.
+static int lod_wedge_target(const lod_state *st, uint32_t cf, uint32_t ct, uint32_t w, uint32_t *out) {
+    int used = 0;
+    for (uint32_t i = st->adj_offsets[cf]; i < st->adj_offsets[cf + 1]; i++) {
+        const uint32_t *tri = st->indices + st->adjacency[i] * 3;
+        if (tri[0] != w && tri[1] != w && tri[2] != w) continue;
+        used = 1;
+        for (int c = 0; c < 3; c++) {
+            uint32_t v = st->remap[tri[c]];
+            if (st->canonical[v] == ct) {
+                *out = v;
+                return 1;
+            }
+        }
+    }
+    return used ? -1 : 0;
+}
+
+// Helper: Check a collapse of position `cf` onto `ct` against the triangles
+// around `cf`. Returns the number of triangles it removes, or -1 if a wedge
+// has no counterpart at `ct` or a triangle would flip.
+static int lod_check_collapse(const lod_state *st, uint32_t cf, uint32_t ct) {
+    uint32_t target;
+    uint32_t w = cf;
+    do {
+        if (lod_wedge_target(st, cf, ct, w, &target) < 0) return -1;
+        w = st->wedges[w];
+    } while (w != cf);
+    
+    int removed = 0;
+    for (uint32_t i = st->adj_offsets[cf]; i < st->adj_offsets[cf + 1]; i++) {
+        const uint32_t *tri = st->indices + st->adjacency[i] * 3;
+        uint32_t c[3];
+        int has_to = 0;
+        for (int k = 0; k < 3; k++) {
+            c[k] = st->canonical[st->remap[tri[k]]];
+            has_to |= c[k] == ct;
+        }
+        if (has_to) {
+            removed++;
+            continue;
+        }
+        
+        double n0[3], n1[3];
+        triangle_normal(lod_position(st, c[0]), lod_position(st, c[1]), lod_position(st, c[2]), n0);
+        triangle_normal(lod_position(st, c[0] == cf ? ct : c[0]), lod_position(st, c[1] == cf ? ct : c[1]),
+                        lod_position(st, c[2] == cf ? ct : c[2]), n1);
+        if (n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2] <= 0.0 &&
+            (n0[0] != 0.0 || n0[1] != 0.0 || n0[2] != 0.0)) {
+            return -1;
+        }
+    }
+    return removed;
+}
+
+// One simplification pass: collapse the cheapest edges, at most one per
+// position, until about half of the triangles above `target` are gone.
+// Returns the number of collapses made.
+static size_t lod_pass(lod_state *st, size_t target) {
+    const render_mesh *rm = st->rm;
+    size_t nv = rm->num_vertices;
+    size_t ni = st->num_tris * 3;
+    
+    // Triangles around each position
+    memset(st->adj_offsets, 0, (nv + 1) * sizeof(uint32_t));
+    for (size_t i = 0; i < ni; i++) st->adj_offsets[st->canonical[st->indices[i]] + 1]++;
+    for (size_t v = 0; v < nv; v++) st->adj_offsets[v + 1] += st->adj_offsets[v];
+    for (size_t i = 0; i < ni; i += 3) {
+        for (size_t c = 0; c < 3; c++) {
+            uint32_t p = st->canonical[st->indices[i + c]];
+            if (c > 0 && p == st->canonical[st->indices[i]]) continue;
+            if (c > 1 && p == st->canonical[st->indices[i + 1]]) continue;
+            st->adjacency[st->adj_offsets[p]++] = (uint32_t)(i / 3);
+        }
+    }
+    for (size_t v = nv; v > 0; v--) st->adj_offsets[v] = st->adj_offsets[v - 1];
+    st->adj_offsets[0] = 0;
+    
+    // Cheapest collapse of every unlocked position along one of its edges.
+    // Positions of the same skin cluster only, so weights stay plausible.
+    for (size_t v = 0; v < nv; v++) {
+        st->collapses[v].cost = -1.0;
+        st->remap[v] = (uint32_t)v;
+    }
+    memset(st->marked, 0, nv);
+    for (size_t i = 0; i < ni; i++) {
+        uint32_t a = st->canonical[st->indices[i]];
+        uint32_t b = st->canonical[st->indices[i - i % 3 + (i + 1) % 3]];
+        for (int dir = 0; dir < 2; dir++) {
+            uint32_t cf = dir ? b : a, ct = dir ? a : b;
+            if (st->locked[cf] || cf == ct || st->joint[cf] != st->joint[ct]) continue;
+            double cost = quadric_error(&st->quadrics[cf], &st->quadrics[ct], lod_position(st, ct));
+            lod_collapse *best = &st->collapses[cf];
+            if (best->cost < 0.0 || cost < best->cost) {
+                best->cost = cost;
+                best->from = cf;
+                best->to = ct;
+            }
+        }
+    }
+    size_t num_collapses = 0;
+    for (size_t v = 0; v < nv; v++) {
+        if (st->collapses[v].cost >= 0.0) st->collapses[num_collapses++] = st->collapses[v];
+    }
+    qsort(st->collapses, num_collapses, sizeof(lod_collapse), compare_lod_collapses);
+    
+    size_t goal = (st->num_tris - target + 1) / 2;
+    size_t removed = 0, applied = 0;
+    for (size_t i = 0; i < num_collapses && removed < goal; i++) {
+        const lod_collapse *col = &st->collapses[i];
+        uint32_t cf = col->from, ct = col->to;
+        if (st->marked[cf] || st->marked[ct]) continue;
+        int tris = lod_check_collapse(st, cf, ct);
+        if (tris < 0) continue;
+        
+        // Move every wedge onto its counterpart. The neighbours of `cf` are
+        // not marked by this, so later checks still see their positions.
+        uint32_t w = cf;
+        do {
+            uint32_t to;
+            if (lod_wedge_target(st, cf, ct, w, &to) > 0) st->remap[w] = to;
+            w = st->wedges[w];
+        } while (w != cf);
+        st->marked[cf] = st->marked[ct] = 1;
+        quadric_add(&st->quadrics[ct], &st->quadrics[cf]);
+        if (col->cost > st->max_error) st->max_error = col->cost;
+        removed += (size_t)tris;
+        applied++;
+    }
+    
+    // Rewrite the live triangles, dropping collapsed ones, keeping parts contiguous
+    size_t out = 0;
+    for (size_t p = 0; p < rm->num_parts; p++) {
+        render_part *part = &st->parts[p];
+        size_t begin = out;
+        for (size_t i = part->index_offset; i < part->index_offset + part->num_indices; i += 3) {
+            uint32_t a = st->remap[st->indices[i]];
+            uint32_t b = st->remap[st->indices[i + 1]];
+            uint32_t c = st->remap[st->indices[i + 2]];
+            uint32_t ca = st->canonical[a], cb = st->canonical[b], cc = st->canonical[c];
+            if (ca == cb || cb == cc || ca == cc) continue;
+            st->indices[out++] = a;
+            st->indices[out++] = b;
+            st->indices[out++] = c;
+        }
+        part->index_offset = begin;
+        part->num_indices = out - begin;
+    }
+    st->num_tris = out / 3;
+    return applied;
+}
+
+// Generate levels of detail with at most `ratios[i]` of the triangles each
+// (`ratios` sorted in decreasing order) by repeatedly collapsing a position
+// onto a neighbour, cheapest quadric error first. Every level indexes the
+// vertices of `rm` and keeps its draw ranges. Positions on mesh borders and
+// material boundaries never move, seam positions only move along the seam, and
+// positions only collapse onto ones dominated by the same skin cluster. A level
+// stops early if no collapse is possible. Returns 0 on allocation failure.
+static int simplify_render_mesh(const ufbx_mesh *mesh, const render_mesh *rm, const double *ratios,
+                                size_t num_ratios, render_lod *lods) {
+    memset(lods, 0, num_ratios * sizeof(render_lod));
+    size_t nv = rm->num_vertices, ni = rm->num_indices;
+    
+    lod_state st = { 0 };
+    st.rm = rm;
+    st.num_tris = ni / 3;
+    st.indices = (uint32_t*)enif_alloc((ni + 1) * sizeof(uint32_t));
+    st.parts = (render_part*)enif_alloc((rm->num_parts + 1) * sizeof(render_part));
+    st.canonical = (uint32_t*)enif_alloc((nv + 1) * sizeof(uint32_t));
+    st.wedges = (uint32_t*)enif_alloc((nv + 1) * sizeof(uint32_t));
+    st.joint = (uint32_t*)enif_alloc((nv + 1) * sizeof(uint32_t));
+    st.locked = (unsigned char*)enif_alloc(nv + 1);
+    st.marked = (unsigned char*)enif_alloc(nv + 1);
+    st.remap = (uint32_t*)enif_alloc((nv + 1) * sizeof(uint32_t));
+    st.quadrics = (quadric*)enif_alloc((nv + 1) * sizeof(quadric));
+    st.adj_offsets = (uint32_t*)enif_alloc((nv + 1) * sizeof(uint32_t));
+    st.adjacency = (uint32_t*)enif_alloc((ni + 1) * sizeof(uint32_t));
+    st.collapses = (lod_collapse*)enif_alloc((nv + 1) * sizeof(lod_collapse));
+    
+    int ok = st.indices && st.parts && st.canonical && st.wedges && st.joint && st.locked && st.marked && st.remap &&
+        st.quadrics && st.adj_offsets && st.adjacency && st.collapses && weld_render_positions(rm, st.canonical);
+    if (ok) {
+        memcpy(st.indices, rm->indices, ni * sizeof(uint32_t));
+        memcpy(st.parts, rm->parts, rm->num_parts * sizeof(render_part));
+        memset(st.locked, 0, nv);
+        memset(st.quadrics, 0, nv * sizeof(quadric));
+        
+        // Wedges: vertices at one position with different attributes
+        for (size_t v = 0; v < nv; v++) {
+            uint32_t c = st.canonical[v];
+            st.wedges[v] = (uint32_t)v;
+            if (c != v) {
+                st.wedges[v] = st.wedges[c];
+                st.wedges[c] = (uint32_t)v;
+            }
+        }
+        
+        // Material boundaries: a position used by several parts
+        memset(st.remap, 0xff, nv * sizeof(uint32_t));
+        for (size_t p = 0; p < rm->num_parts; p++) {
+            for (size_t i = rm->parts[p].index_offset; i < rm->parts[p].index_offset + rm->parts[p].num_indices; i++) {
+                uint32_t c = st.canonical[rm->indices[i]];
+                if (st.remap[c] == UINT32_MAX) st.remap[c] = (uint32_t)p;
+                else if (st.remap[c] != p) st.locked[c] = 1;
+            }
+        }
+        ok = lock_border_vertices(rm, st.canonical, st.locked);
+    }
+    if (ok) {
+        for (size_t v = 0; v < nv; v++) {
+            ufbx_real weight;
+            if (!skin_influences(mesh, rm->vertex_indices[v], 1, &st.joint[v], &weight)) {
+                st.joint[v] = UINT32_MAX;
+            }
+        }
+        
+        for (size_t i = 0; i < ni; i += 3) {
+            uint32_t c[3] = { st.canonical[rm->indices[i]], st.canonical[rm->indices[i + 1]],
+                              st.canonical[rm->indices[i + 2]] };
+            const ufbx_real *p0 = lod_position(&st, c[0]);
+            double n[3];
+            triangle_normal(p0, lod_position(&st, c[1]), lod_position(&st, c[2]), n);
+            double len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (len <= 0.0) continue;
+            n[0] /= len; n[1] /= len; n[2] /= len;
+            double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+            for (int k = 0; k < 3; k++) {
+                quadric_add_plane(&st.quadrics[c[k]], n[0], n[1], n[2], d, len * 0.5);
+            }
+        }
+    }
+    
+    // Errors are reported relative to the bounding box diagonal
+    double extent = 0.0;
+    if (ok && nv > 0) {
+        const ufbx_real *first = lod_position(&st, 0);
+        ufbx_real min[3] = { first[0], first[1], first[2] }, max[3] = { first[0], first[1], first[2] };
+        for (size_t v = 1; v < nv; v++) {
+            const ufbx_real *p = lod_position(&st, (uint32_t)v);
+            for (int c = 0; c < 3; c++) {
+                if (p[c] < min[c]) min[c] = p[c];
+                if (p[c] > max[c]) max[c] = p[c];
+            }
+        }
+        extent = sqrt((max[0] - min[0]) * (max[0] - min[0]) + (max[1] - min[1]) * (max[1] - min[1]) +
+                      (max[2] - min[2]) * (max[2] - min[2]));
+    }
+    
+    for (size_t l = 0; ok && l < num_ratios; l++) {
+        size_t target = (size_t)(ratios[l] * (double)(ni / 3));
+        while (st.num_tris > target && lod_pass(&st, target) > 0) {
+        }
+        
+        render_lod *lod = &lods[l];
+        lod->num_indices = st.num_tris * 3;
+        lod->indices = (uint32_t*)enif_alloc((lod->num_indices + 1) * sizeof(uint32_t));
+        lod->parts = (render_part*)enif_alloc((rm->num_parts + 1) * sizeof(render_part));
+        if (!lod->indices || !lod->parts) {
+            ok = 0;
+            break;
+        }
+        memcpy(lod->indices, st.indices, lod->num_indices * sizeof(uint32_t));
+        memcpy(lod->parts, st.parts, rm->num_parts * sizeof(render_part));
+        lod->error = extent > 0.0 ? sqrt(st.max_error) / extent : 0.0;
+    }
+    
+    if (st.indices) enif_free(st.indices);
+    if (st.parts) enif_free(st.parts);
+    if (st.canonical) enif_free(st.canonical);
+    if (st.wedges) enif_free(st.wedges);
+    if (st.joint) enif_free(st.joint);
+    if (st.locked) enif_free(st.locked);
+    if (st.marked) enif_free(st.marked);
+    if (st.remap) enif_free(st.remap);
+    if (st.quadrics) enif_free(st.quadrics);
+    if (st.adj_offsets) enif_free(st.adj_offsets);
+    if (st.adjacency) enif_free(st.adjacency);
+    if (st.collapses) enif_free(st.collapses);
+    if (!ok) {
+        free_render_lods(lods, num_ratios);
+    }
+    return ok;
+}
+
+// Reorder the triangles of every LOD draw range for the vertex cache, like
+// `optimize_render_mesh()` but leaving the shared vertices in place
+static int optimize_render_lods(const render_mesh *rm, render_lod *lods, size_t num_lods, size_t cache_size) {
+    tipsify_scratch sc;
+    if (!alloc_tipsify_scratch(&sc, rm->num_vertices, rm->num_indices)) {
+        return 0;
+    }
+    for (size_t l = 0; l < num_lods; l++) {
+        for (size_t i = 0; i < rm->num_parts; i++) {
+            tipsify(lods[l].indices + lods[l].parts[i].index_offset, lods[l].parts[i].num_indices, cache_size, &sc);
+        }
+    }
+    enif_free(sc.counts);
+    return 1;
+}
+
+// Helper: Describe one attribute of an interleaved buffer:
+// %{type, components, stride, count, offset}, `stride` and `offset` in bytes
+static ERL_NIF_TERM make_vertex_layout(ErlNifEnv* env, ERL_NIF_TERM type, size_t components, size_t stride,
+                                       size_t count, size_t offset) {
+    ERL_NIF_TERM keys[5] = { atom_type, atom_components, atom_stride, atom_count, atom_offset };
+    ERL_NIF_TERM values[5] = {
+        type,
+        enif_make_uint64(env, components),
+        enif_make_uint64(env, stride),
+        enif_make_uint64(env, count),
+        enif_make_uint64(env, offset),
+    };
+    return make_map(env, keys, values, 5);
+}
+
+// Helper: Pack render mesh indices, as u16 whenever every vertex fits
+static ERL_NIF_TERM make_render_indices(ErlNifEnv* env, const uint32_t *indices, size_t count,
+                                        size_t num_vertices, ERL_NIF_TERM *layout) {
+    ERL_NIF_TERM result;
+    if (num_vertices <= (size_t)UINT16_MAX + 1) {
+        unsigned char *dst = enif_make_new_binary(env, count * sizeof(uint16_t), &result);
+        for (size_t i = 0; i < count; i++) {
+            store_u16_le(dst + i * sizeof(uint16_t), (uint16_t)indices[i]);
+        }
+        *layout = make_layout(env, atom_u16, 1, sizeof(uint16_t), count);
+    } else {
+        unsigned char *dst = enif_make_new_binary(env, count * sizeof(uint32_t), &result);
+        for (size_t i = 0; i < count; i++) {
+            store_u32_le(dst + i * sizeof(uint32_t), indices[i]);
+        }
+        *layout = make_layout(env, atom_u32, 1, sizeof(uint32_t), count);
+    }
+    return result;
+}
+
+// Helper: Pack draw ranges as u32 triples [material_id, index_offset, index_count]
+// where `material_id` is the material's typed_id, or `UFBX_NO_INDEX` for faces without one
+static ERL_NIF_TERM make_draw_ranges(ErlNifEnv* env, const ufbx_mesh *mesh, const render_part *parts,
+                                     size_t num_parts, ERL_NIF_TERM *layout) {
+    ERL_NIF_TERM result;
+    unsigned char *dst = enif_make_new_binary(env, num_parts * 3 * sizeof(uint32_t), &result);
+    for (size_t i = 0; i < num_parts; i++) {
+        const render_part *part = &parts[i];
+        uint32_t material_id = part->material < mesh->materials.count
+            ? mesh->materials.data[part->material]->typed_id : UFBX_NO_INDEX;
+        store_u32_le(dst + (i * 3 + 0) * sizeof(uint32_t), material_id);
+        store_u32_le(dst + (i * 3 + 1) * sizeof(uint32_t), (uint32_t)part->index_offset);
+        store_u32_le(dst + (i * 3 + 2) * sizeof(uint32_t), (uint32_t)part->num_indices);
+    }
+    *layout = make_layout(env, atom_u32, 3, sizeof(uint32_t), num_parts);
+    return result;
+}
+
+// Quantized render vertex: each attribute packed into 4-byte aligned integers.
+// Positions are snorm16 relative to the mesh bounds (padded to 8 bytes),
+// normals octahedral snorm16, texcoords unorm16 relative to their range,
+// colors unorm8 and tangents octahedral snorm8 followed by the handedness.
+static const size_t quantized_attribute_sizes[RENDER_ATTRIBUTE_COUNT] = { 8, 4, 4, 4, 4 };
+
+static int16_t quantize_snorm16(ufbx_real v) {
+    if (v < -1.0) v = -1.0;
+    if (v > 1.0) v = 1.0;
+    return (int16_t)(v >= 0.0 ? v * 32767.0 + 0.5 : v * 32767.0 - 0.5);
+}
+
+static int8_t quantize_snorm8(ufbx_real v) {
+    if (v < -1.0) v = -1.0;
+    if (v > 1.0) v = 1.0;
+    return (int8_t)(v >= 0.0 ? v * 127.0 + 0.5 : v * 127.0 - 0.5);
+}
+
+static uint16_t quantize_unorm16(ufbx_real v) {
+    if (v < 0.0) v = 0.0;
+    if (v > 1.0) v = 1.0;
+    return (uint16_t)(v * 65535.0 + 0.5);
+}
+
+static uint8_t quantize_unorm8(ufbx_real v) {
+    if (v < 0.0) v = 0.0;
+    if (v > 1.0) v = 1.0;
+    return (uint8_t)(v * 255.0 + 0.5);
+}
+
+// Helper: Map a direction onto the octahedron unfolded into [-1, 1]^2
+static void octahedral_encode(const ufbx_real *v, ufbx_real *out) {
+    ufbx_real l1 = (v[0] < 0 ? -v[0] : v[0]) + (v[1] < 0 ? -v[1] : v[1]) + (v[2] < 0 ? -v[2] : v[2]);
+    if (l1 == 0.0) {
+        out[0] = out[1] = 0.0;
+        return;
+    }
+    ufbx_real x = v[0] / l1, y = v[1] / l1;
+    if (v[2] < 0.0) {
+        ufbx_real fx = (1.0 - (y < 0 ? -y : y)) * (x >= 0.0 ? 1.0 : -1.0);
+        ufbx_real fy = (1.0 - (x < 0 ? -x : x)) * (y >= 0.0 ? 1.0 : -1.0);
+        x = fx;
+        y = fy;
+    }
+    out[0] = x;
+    out[1] = y;
+}
+
+// Helper: Per-component bounds of `components` reals at `offset` in every vertex
+static void render_attribute_bounds(const render_mesh *rm, size_t offset, size_t components,
+                                    ufbx_real *min, ufbx_real *max) {
+    for (size_t c = 0; c < components; c++) {
+        min[c] = rm->num_vertices > 0 ? rm->vertices[offset + c] : 0.0;
+        max[c] = min[c];
+    }
+    for (size_t i = 0; i < rm->num_vertices; i++) {
+        const ufbx_real *v = rm->vertices + i * rm->stride + offset;
+        for (size_t c = 0; c < components; c++) {
+            if (v[c] < min[c]) min[c] = v[c];
+            if (v[c] > max[c]) max[c] = v[c];
+        }
+    }
+}
+
+// Helper: Dequantization parameters %{bias, scale} of an attribute: the
+// original value is `bias + normalized * scale` per component
+static ERL_NIF_TERM make_dequantize_params(ErlNifEnv* env, const ufbx_real *bias, const ufbx_real *scale,
+                                           size_t components) {
+    ERL_NIF_TERM bias_list = enif_make_list(env, 0);
+    ERL_NIF_TERM scale_list = enif_make_list(env, 0);
+    for (size_t c = components; c > 0; c--) {
+        bias_list = enif_make_list_cell(env, enif_make_double(env, bias[c - 1]), bias_list);
+        scale_list = enif_make_list_cell(env, enif_make_double(env, scale[c - 1]), scale_list);
+    }
+    ERL_NIF_TERM keys[2] = { atom_bias, atom_scale };
+    ERL_NIF_TERM values[2] = { bias_list, scale_list };
+    return make_map(env, keys, values, 2);
+}
+
+// Helper: Describe one quantized attribute, like `make_vertex_layout()` plus
+// its `encoding` (`:linear` or `:octahedral`)
+static ERL_NIF_TERM make_quantized_layout(ErlNifEnv* env, ERL_NIF_TERM type, size_t components, size_t stride,
+                                          size_t count, size_t offset, ERL_NIF_TERM encoding) {
+    ERL_NIF_TERM keys[6] = { atom_type, atom_components, atom_stride, atom_count, atom_offset, atom_encoding };
+    ERL_NIF_TERM values[6] = {
+        type,
+        enif_make_uint64(env, components),
+        enif_make_uint64(env, stride),
+        enif_make_uint64(env, count),
+        enif_make_uint64(env, offset),
+        encoding,
+    };
+    return make_map(env, keys, values, 6);
+}
+
+// Pack render mesh vertices quantized (see `quantized_attribute_sizes`).
+// Fills the layout of every present attribute in `attribute_layouts` and
+// returns the position and texcoord dequantization parameters in `dequantize`.
+static ERL_NIF_TERM make_quantized_vertices(ErlNifEnv* env, const render_mesh *rm, ERL_NIF_TERM *vertices_layout,
+                                            ERL_NIF_TERM attribute_layouts[], ERL_NIF_TERM *dequantize) {
+    size_t offsets[RENDER_ATTRIBUTE_COUNT];
+    size_t stride = 0;
+    for (int i = 0; i < RENDER_ATTRIBUTE_COUNT; i++) {
+        offsets[i] = stride;
+        if (rm->offsets[i] != RENDER_NO_ATTRIBUTE) stride += quantized_attribute_sizes[i];
+    }
+    
+    // Positions map the bounding box to [-1, 1], texcoords their range to [0, 1]
+    ufbx_real pos_min[3], pos_max[3], pos_bias[3], pos_scale[3];
+    ufbx_real uv_min[2] = { 0.0, 0.0 }, uv_max[2] = { 0.0, 0.0 };
+    render_attribute_bounds(rm, rm->offsets[RENDER_POSITION], 3, pos_min, pos_max);
+    for (size_t c = 0; c < 3; c++) {
+        pos_bias[c] = (pos_min[c] + pos_max[c]) * 0.5;
+        pos_scale[c] = (pos_max[c] - pos_min[c]) * 0.5;
+    }
+    int has_uv = rm->offsets[RENDER_TEXCOORD] != RENDER_NO_ATTRIBUTE;
+    if (has_uv) {
+        render_attribute_bounds(rm, rm->offsets[RENDER_TEXCOORD], 2, uv_min, uv_max);
+    }
+    ufbx_real uv_scale[2] = { uv_max[0] - uv_min[0], uv_max[1] - uv_min[1] };
+    
+    ERL_NIF_TERM result;
+    unsigned char *dst = enif_make_new_binary(env, rm->num_vertices * stride, &result);
+    memset(dst, 0, rm->num_vertices * stride);
+    for (size_t i = 0; i < rm->num_vertices; i++) {
+        const ufbx_real *src = rm->vertices + i * rm->stride;
+        unsigned char *vertex = dst + i * stride;
+        
+        const ufbx_real *p = src + rm->offsets[RENDER_POSITION];
+        for (size_t c = 0; c < 3; c++) {
+            ufbx_real n = pos_scale[c] > 0.0 ? (p[c] - pos_bias[c]) / pos_scale[c] : 0.0;
+            store_u16_le(vertex + offsets[RENDER_POSITION] + c * 2, (uint16_t)quantize_snorm16(n));
+        }
+        if (rm->offsets[RENDER_NORMAL] != RENDER_NO_ATTRIBUTE) {
+            ufbx_real oct[2];
+            octahedral_encode(src + rm->offsets[RENDER_NORMAL], oct);
+            store_u16_le(vertex + offsets[RENDER_NORMAL], (uint16_t)quantize_snorm16(oct[0]));
+            store_u16_le(vertex + offsets[RENDER_NORMAL] + 2, (uint16_t)quantize_snorm16(oct[1]));
+        }
+        if (has_uv) {
+            const ufbx_real *uv = src + rm->offsets[RENDER_TEXCOORD];
+            for (size_t c = 0; c < 2; c++) {
+                ufbx_real n = uv_scale[c] > 0.0 ? (uv[c] - uv_min[c]) / uv_scale[c] : 0.0;
+                store_u16_le(vertex + offsets[RENDER_TEXCOORD] + c * 2, quantize_unorm16(n));
+            }
+        }
+        if (rm->offsets[RENDER_COLOR] != RENDER_NO_ATTRIBUTE) {
+            const ufbx_real *color = src + rm->offsets[RENDER_COLOR];
+            for (size_t c = 0; c < 4; c++) {
+                vertex[offsets[RENDER_COLOR] + c] = quantize_unorm8(color[c]);
+            }
+        }
+        if (rm->offsets[RENDER_TANGENT] != RENDER_NO_ATTRIBUTE) {
+            const ufbx_real *tangent = src + rm->offsets[RENDER_TANGENT];
+            ufbx_real oct[2];
+            octahedral_encode(tangent, oct);
+            vertex[offsets[RENDER_TANGENT]] = (uint8_t)quantize_snorm8(oct[0]);
+            vertex[offsets[RENDER_TANGENT] + 1] = (uint8_t)quantize_snorm8(oct[1]);
+            vertex[offsets[RENDER_TANGENT] + 2] = (uint8_t)quantize_snorm8(tangent[3]);
+        }
+    }
+    
+    const ERL_NIF_TERM types[RENDER_ATTRIBUTE_COUNT] = {
+        atom_snorm16, atom_snorm16, atom_unorm16, atom_unorm8, atom_snorm8,
+    };
+    const size_t components[RENDER_ATTRIBUTE_COUNT] = { 3, 2, 2, 4, 3 };
+    for (int i = 0; i < RENDER_ATTRIBUTE_COUNT; i++) {
+        if (rm->offsets[i] == RENDER_NO_ATTRIBUTE) continue;
+        ERL_NIF_TERM encoding = (i == RENDER_NORMAL || i == RENDER_TANGENT) ? atom_octahedral : atom_linear;
+        attribute_layouts[i] = make_quantized_layout(env, types[i], components[i], stride, rm->num_vertices,
+                                                     offsets[i], encoding);
+    }
+    *vertices_layout = make_layout(env, atom_u8, stride, sizeof(uint8_t), rm->num_vertices);
+    
+    ERL_NIF_TERM keys[2] = { atom_positions, atom_texcoords };
+    ERL_NIF_TERM values[2] = {
+        make_dequantize_params(env, pos_bias, pos_scale, 3),
+        make_dequantize_params(env, uv_min, uv_scale, 2),
+    };
+    *dequantize = make_map(env, keys, values, has_uv ? 2 : 1);
+    return result;
+}
+
+// Pack render mesh vertices as interleaved reals in the requested precision,
+// filling the layout of every present attribute in `attribute_layouts`
+static ERL_NIF_TERM make_render_vertices(ErlNifEnv* env, const render_mesh *rm, const extract_opts *opts,
+                                         ERL_NIF_TERM *vertices_layout, ERL_NIF_TERM attribute_layouts[]) {
+    ERL_NIF_TERM type = opts->use_f32 ? atom_f32 : atom_f64;
+    size_t elem_size = opts->use_f32 ? sizeof(float) : sizeof(double);
+    size_t num_reals = rm->num_vertices * rm->stride;
+    
+    ERL_NIF_TERM result;
+    unsigned char *dst = enif_make_new_binary(env, num_reals * elem_size, &result);
+    store_packed_reals(dst, 0, rm->vertices, num_reals, opts);
+    
+    for (int i = 0; i < RENDER_ATTRIBUTE_COUNT; i++) {
+        if (rm->offsets[i] == RENDER_NO_ATTRIBUTE) continue;
+        attribute_layouts[i] = make_vertex_layout(env, type, render_attribute_components[i],
+            rm->stride * elem_size, rm->num_vertices, rm->offsets[i] * elem_size);
+    }
+    *vertices_layout = make_layout(env, type, rm->stride, elem_size, rm->num_vertices);
+    return result;
+}
+
+// Helper: Vertex cache statistics of an optimized mesh:
+// %{cache_size, acmr_before, acmr_after, atvr_before, atvr_after}
+static ERL_NIF_TERM make_cache_stats(ErlNifEnv* env, size_t cache_size, const render_cache_stats *before,
+                                     const render_cache_stats *after) {
+    ERL_NIF_TERM keys[5] = { atom_cache_size, atom_acmr_before, atom_acmr_after, atom_atvr_before, atom_atvr_after };
+    ERL_NIF_TERM values[5] = {
+        enif_make_uint64(env, cache_size),
+        enif_make_double(env, before->acmr),
+        enif_make_double(env, after->acmr),
+        enif_make_double(env, before->atvr),
+        enif_make_double(env, after->atvr),
+    };
+    return make_map(env, keys, values, 5);
+}
+
+// Helper: LODs as a list of %{ratio, error, indices, draw_ranges, layout}
+// maps, their indices referring to the vertices of the full mesh
+static ERL_NIF_TERM make_render_lods(ErlNifEnv* env, const ufbx_mesh *mesh, const render_mesh *rm,
+                                     const render_lod *lods, const double *ratios, size_t num_lods) {
+    ERL_NIF_TERM list = enif_make_list(env, 0);
+    for (size_t i = num_lods; i > 0; i--) {
+        const render_lod *lod = &lods[i - 1];
+        ERL_NIF_TERM layout_keys[2] = { atom_indices, atom_draw_ranges };
+        ERL_NIF_TERM layout_values[2];
+        ERL_NIF_TERM keys[5] = { atom_ratio, atom_error, atom_indices, atom_draw_ranges, atom_layout };
+        ERL_NIF_TERM values[5];
+        values[0] = enif_make_double(env, ratios[i - 1]);
+        values[1] = enif_make_double(env, lod->error);
+        values[2] = make_render_indices(env, lod->indices, lod->num_indices, rm->num_vertices, &layout_values[0]);
+        values[3] = make_draw_ranges(env, mesh, lod->parts, rm->num_parts, &layout_values[1]);
+        values[4] = make_map(env, layout_keys, layout_values, 2);
+        list = enif_make_list_cell(env, make_map(env, keys, values, 5), list);
+    }
+    return list;
+}
+
+// Build the `skin` map of a skinned mesh: the joint nodes, their inverse bind
+// matrices (`geometry_to_bone`, 4x4 column-major in `:precision`) and per-vertex
+// `joint_indices` (`u8`, or `u16` past 256 joints) and `weights` (`f32`, or
+// `unorm8` summing to 255 when quantizing), `max_influences` per vertex.
+// Vertex `i` is source vertex `vertex_map[i]`, or `i` itself if NULL.
+static ERL_NIF_TERM make_skin(ErlNifEnv* env, const ufbx_mesh *mesh, const uint32_t *vertex_map,
+                              size_t num_vertices, const extract_opts *opts) {
+    const ufbx_skin_deformer *skin = mesh_skin(mesh);
+    size_t num_joints = skin->clusters.count;
+    size_t n = opts->max_influences;
+    int wide = num_joints > 256;
+    size_t index_size = wide ? sizeof(uint16_t) : sizeof(uint8_t);
+    size_t weight_size = opts->quantize ? sizeof(uint8_t) : sizeof(float);
+    
+    ufbx_real *matrices = (ufbx_real*)enif_alloc((num_joints ? num_joints : 1) * 16 * sizeof(ufbx_real));
+    if (!matrices) {
+        return atom_error;
+    }
+    
+    ERL_NIF_TERM keys[5] = { atom_joints, atom_inverse_bind_matrices, atom_joint_indices, atom_weights, atom_layout };
+    ERL_NIF_TERM values[5];
+    ERL_NIF_TERM layout_keys[3] = { atom_inverse_bind_matrices, atom_joint_indices, atom_weights };
+    ERL_NIF_TERM layout_values[3];
+    
+    // joints and inverse_bind_matrices
+    values[0] = enif_make_list(env, 0);
+    for (size_t j = num_joints; j > 0; j--) {
+        const ufbx_skin_cluster *cluster = skin->clusters.data[j - 1];
+        ERL_NIF_TERM joint = cluster->bone_node ? enif_make_uint(env, cluster->bone_node->typed_id) : atom_nil;
+        values[0] = enif_make_list_cell(env, joint, values[0]);
+        
+        const ufbx_matrix *m = &cluster->geometry_to_bone;
+        ufbx_real *dst = matrices + (j - 1) * 16;
+        for (int c = 0; c < 4; c++) {
+            dst[c * 4 + 0] = m->cols[c].x;
+            dst[c * 4 + 1] = m->cols[c].y;
+            dst[c * 4 + 2] = m->cols[c].z;
+            dst[c * 4 + 3] = c == 3 ? 1.0f : 0.0f;
+        }
+    }
+    extract_opts packed_opts = *opts;
+    packed_opts.owner = NULL;
+    values[1] = make_packed_reals(env, matrices, num_joints, 16, &packed_opts, &layout_values[0]);
+    enif_free(matrices);
+    
+    // joint_indices and weights, padded with zero weights
+    unsigned char *index_dst = enif_make_new_binary(env, num_vertices * n * index_size, &values[2]);
+    unsigned char *weight_dst = enif_make_new_binary(env, num_vertices * n * weight_size, &values[3]);
+    for (size_t v = 0; v < num_vertices; v++) {
+        uint32_t joints[MAX_INFLUENCES];
+        ufbx_real weights[MAX_INFLUENCES];
+        size_t count = skin_influences(mesh, vertex_map ? vertex_map[v] : (uint32_t)v, n, joints, weights);
+        
+        // Round to unorm8 and make the sum exactly 255 without reordering: a
+        // deficit goes to the strongest influence, a surplus comes off the weakest
+        uint8_t bytes[MAX_INFLUENCES];
+        int sum = 0;
+        for (size_t i = 0; i < count; i++) {
+            bytes[i] = quantize_unorm8(weights[i]);
+            sum += bytes[i];
+        }
+        if (count > 0 && sum < 255) {
+            bytes[0] = (uint8_t)(bytes[0] + 255 - sum);
+        }
+        for (size_t i = count; i > 0 && sum > 255; i--) {
+            int take = bytes[i - 1] < sum - 255 ? bytes[i - 1] : sum - 255;
+            bytes[i - 1] = (uint8_t)(bytes[i - 1] - take);
+            sum -= take;
+        }
+        
+        for (size_t i = 0; i < n; i++) {
+            uint32_t joint = i < count ? joints[i] : 0;
+            size_t k = v * n + i;
+            if (wide) {
+                store_u16_le(index_dst + k * index_size, (uint16_t)joint);
+            } else {
+                index_dst[k] = (uint8_t)joint;
+            }
+            if (opts->quantize) {
+                weight_dst[k] = i < count ? bytes[i] : 0;
+            } else {
+                store_f32_le(weight_dst + k * weight_size, i < count ? (float)weights[i] : 0.0f);
+            }
+        }
+    }
+    layout_values[1] = make_layout(env, wide ? atom_u16 : atom_u8, n, index_size, num_vertices);
+    layout_values[2] = make_layout(env, opts->quantize ? atom_unorm8 : atom_f32, n, weight_size, num_vertices);
+    values[4] = make_map(env, layout_keys, layout_values, 3);
+    
+    return make_map(env, keys, values, 5);
+}
+
+// Helper: One blend shape keyframe as %{id, name, target_weight,
+// vertex_indices, position_offsets, normal_offsets, layout}: sparse `f32`
+// offsets (with any per-offset weights folded in) and the `u32` vertices they
+// move. Source vertex `v` moves `targets[target_begin[v]..target_begin[v + 1]]`,
+// or just `v` if `targets` is NULL.
+static ERL_NIF_TERM make_blend_shape(ErlNifEnv* env, const ufbx_mesh *mesh, const ufbx_blend_keyframe *key,
+                                     const uint32_t *target_begin, const uint32_t *targets) {
+    const ufbx_blend_shape *shape = key->shape;
+    int has_normals = shape->normal_offsets.count >= shape->num_offsets && shape->num_offsets > 0;
+    
+    size_t count = 0;
+    for (size_t i = 0; i < shape->num_offsets; i++) {
+        uint32_t v = shape->offset_vertices.data[i];
+        if (v >= mesh->num_vertices) continue;
+        count += targets ? target_begin[v + 1] - target_begin[v] : 1;
+    }
+    
+    ERL_NIF_TERM keys[7] = { atom_id, atom_name, atom_target_weight, atom_vertex_indices,
+                             atom_position_offsets, atom_layout, atom_normal_offsets };
+    ERL_NIF_TERM values[7];
+    ERL_NIF_TERM layout_keys[3] = { atom_vertex_indices, atom_position_offsets, atom_normal_offsets };
+    ERL_NIF_TERM layout_values[3];
+    values[0] = enif_make_uint(env, shape->typed_id);
+    values[1] = make_string(env, shape->name);
+    values[2] = enif_make_double(env, key->target_weight);
+    
+    unsigned char *index_dst = enif_make_new_binary(env, count * sizeof(uint32_t), &values[3]);
+    unsigned char *position_dst = enif_make_new_binary(env, count * 3 * sizeof(float), &values[4]);
+    unsigned char *normal_dst = has_normals ? enif_make_new_binary(env, count * 3 * sizeof(float), &values[6]) : NULL;
+    size_t k = 0;
+    for (size_t i = 0; i < shape->num_offsets; i++) {
+        uint32_t v = shape->offset_vertices.data[i];
+        if (v >= mesh->num_vertices) continue;
+        ufbx_real w = i < shape->offset_weights.count ? shape->offset_weights.data[i] : 1.0f;
+        ufbx_vec3 p = shape->position_offsets.data[i];
+        ufbx_vec3 n = has_normals ? shape->normal_offsets.data[i] : ufbx_zero_vec3;
+        uint32_t begin = targets ? target_begin[v] : 0, end = targets ? target_begin[v + 1] : 1;
+        for (uint32_t t = begin; t < end; t++, k++) {
+            store_u32_le(index_dst + k * sizeof(uint32_t), targets ? targets[t] : v);
+            store_f32_le(position_dst + (k * 3 + 0) * sizeof(float), (float)(p.x * w));
+            store_f32_le(position_dst + (k * 3 + 1) * sizeof(float), (float)(p.y * w));
+            store_f32_le(position_dst + (k * 3 + 2) * sizeof(float), (float)(p.z * w));
+            if (normal_dst) {
+                store_f32_le(normal_dst + (k * 3 + 0) * sizeof(float), (float)(n.x * w));
+                store_f32_le(normal_dst + (k * 3 + 1) * sizeof(float), (float)(n.y * w));
+                store_f32_le(normal_dst + (k * 3 + 2) * sizeof(float), (float)(n.z * w));
+            }
+        }
+    }
+    
+    layout_values[0] = make_layout(env, atom_u32, 1, sizeof(uint32_t), count);
+    layout_values[1] = make_layout(env, atom_f32, 3, sizeof(float), count);
+    layout_values[2] = make_layout(env, atom_f32, 3, sizeof(float), count);
+    values[5] = make_map(env, layout_keys, layout_values, has_normals ? 3 : 2);
+    return make_map(env, keys, values, has_normals ? 7 : 6);
+}
+
+// Build the `blend_channels` list of a mesh with blend shapes: one
+// %{id, name, weight, shapes} map per channel of every blend deformer, its
+// `shapes` being the in-between keyframes of the channel in increasing
+// `target_weight`. Extracted vertex `i` is source vertex `vertex_map[i]`, or
+// `i` itself if NULL, so shapes move every render vertex of a source vertex.
+static ERL_NIF_TERM make_blend_channels(ErlNifEnv* env, const ufbx_mesh *mesh, const uint32_t *vertex_map,
+                                        size_t num_vertices) {
+    uint32_t *target_begin = NULL, *targets = NULL;
+    if (vertex_map) {
+        target_begin = (uint32_t*)enif_alloc((mesh->num_vertices + 1) * sizeof(uint32_t));
+        targets = (uint32_t*)enif_alloc((num_vertices + 1) * sizeof(uint32_t));
+        if (!target_begin || !targets) {
+            if (target_begin) enif_free(target_begin);
+            if (targets) enif_free(targets);
+            return atom_error;
+        }
+        
+        // Counting sort of the extracted vertices by source vertex
+        memset(target_begin, 0, (mesh->num_vertices + 1) * sizeof(uint32_t));
+        for (size_t i = 0; i < num_vertices; i++) {
+            target_begin[vertex_map[i] + 1]++;
+        }
+        for (size_t v = 0; v < mesh->num_vertices; v++) {
+            target_begin[v + 1] += target_begin[v];
+        }
+        for (size_t i = 0; i < num_vertices; i++) {
+            targets[target_begin[vertex_map[i]]++] = (uint32_t)i;
+        }
+        for (size_t v = mesh->num_vertices; v > 0; v--) {
+            target_begin[v] = target_begin[v - 1];
+        }
+        target_begin[0] = 0;
+    }
+    
+    ERL_NIF_TERM keys[4] = { atom_id, atom_name, atom_weight, atom_shapes };
+    ERL_NIF_TERM channels = enif_make_list(env, 0);
+    for (size_t d = mesh->blend_deformers.count; d > 0; d--) {
+        const ufbx_blend_deformer *deformer = mesh->blend_deformers.data[d - 1];
+        for (size_t c = deformer->channels.count; c > 0; c--) {
+            const ufbx_blend_channel *channel = deformer->channels.data[c - 1];
+            ERL_NIF_TERM values[4];
+            values[0] = enif_make_uint(env, channel->typed_id);
+            values[1] = make_string(env, channel->name);
+            values[2] = enif_make_double(env, channel->weight);
+            values[3] = enif_make_list(env, 0);
+            for (size_t k = channel->keyframes.count; k > 0; k--) {
+                const ufbx_blend_keyframe *key = &channel->keyframes.data[k - 1];
+                if (!key->shape) continue;
+                ERL_NIF_TERM shape = make_blend_shape(env, mesh, key, target_begin, targets);
+                values[3] = enif_make_list_cell(env, shape, values[3]);
+            }
+            channels = enif_make_list_cell(env, make_map(env, keys, values, 4), channels);
+        }
+    }
+    
+    if (target_begin) enif_free(target_begin);
+    if (targets) enif_free(targets);
+    return channels;
+}
+
+// Build the `cache_deformers` list of a mesh driven by geometry caches: one
+// %{id, name, channel, file_path} map per deformer, `file_path` resolved
+// relative to the loaded file
+static ERL_NIF_TERM make_cache_deformers(ErlNifEnv* env, const ufbx_mesh *mesh) {
+    ERL_NIF_TERM keys[4] = { atom_id, atom_name, atom_channel, atom_file_path };
+    ERL_NIF_TERM list = enif_make_list(env, 0);
+    for (size_t i = mesh->cache_deformers.count; i > 0; i--) {
+        const ufbx_cache_deformer *deformer = mesh->cache_deformers.data[i - 1];
+        ERL_NIF_TERM values[4];
+        values[0] = enif_make_uint(env, deformer->typed_id);
+        values[1] = make_string(env, deformer->name);
+        values[2] = make_string(env, deformer->channel);
+        values[3] = make_string(env, deformer->file ? deformer->file->filename : ufbx_empty_string);
+        list = enif_make_list_cell(env, make_map(env, keys, values, 4), list);
+    }
+    return list;
+}
+
+// Extract a triangulated mesh with a single interleaved `vertices` binary and
+// an `indices` binary sorted by material, with one `draw_ranges` entry per
+// material. `layout` has the whole buffers under `vertices`, `indices` and
+// `draw_ranges`, and the offset of each attribute within a vertex under its name.
+// Quantized meshes also carry the `dequantize` parameters, `lods` lists
+// simplified index buffers over the same vertices, and skinned meshes carry
+// per-vertex `skin` buffers matching `vertices`.
+static ERL_NIF_TERM extract_render_mesh(ErlNifEnv* env, ufbx_mesh *mesh, const extract_opts *opts) {
+    render_mesh rm;
+    if (!build_render_mesh(mesh, opts->generate_tangents, &rm)) {
+        return atom_error;
+    }
+    
+    ERL_NIF_TERM keys[13];
+    ERL_NIF_TERM values[13];
+    size_t idx = 0;
+    
+    if (opts->optimize) {
+        render_cache_stats before, after;
+        if (!optimize_render_mesh(&rm, opts->vertex_cache_size, &before, &after)) {
+            free_render_mesh(&rm);
+            return atom_error;
+        }
+        keys[idx] = atom_cache_stats;
+        values[idx] = make_cache_stats(env, opts->vertex_cache_size, &before, &after);
+        idx++;
+    }
+    
+    if (opts->num_lods > 0) {
+        render_lod lods[MAX_LODS];
+        if (!simplify_render_mesh(mesh, &rm, opts->lod_ratios, opts->num_lods, lods) ||
+            (opts->optimize && !optimize_render_lods(&rm, lods, opts->num_lods, opts->vertex_cache_size))) {
+            free_render_lods(lods, opts->num_lods);
+            free_render_mesh(&rm);
+            return atom_error;
+        }
+        keys[idx] = atom_lods;
+        values[idx] = make_render_lods(env, mesh, &rm, lods, opts->lod_ratios, opts->num_lods);
+        idx++;
+        free_render_lods(lods, opts->num_lods);
+    }
+    
+    ERL_NIF_TERM layout_keys[3 + RENDER_ATTRIBUTE_COUNT];
+    ERL_NIF_TERM layout_values[3 + RENDER_ATTRIBUTE_COUNT];
+    size_t layout_idx = 0;
+    
+    keys[idx] = atom_id;
+    values[idx] = enif_make_uint(env, mesh->typed_id);
+    idx++;
+    
+    keys[idx] = atom_name;
+    values[idx] = make_string(env, mesh->name);
+    idx++;
+    
+    // vertices, quantized or converted to the requested precision
+    ERL_NIF_TERM attribute_layouts[RENDER_ATTRIBUTE_COUNT];
+    keys[idx] = atom_vertices;
+    if (opts->quantize) {
+        values[idx] = make_quantized_vertices(env, &rm, &layout_values[layout_idx], attribute_layouts,
+                                              &values[idx + 1]);
+        idx++;
+        keys[idx] = atom_dequantize;
+    } else {
+        values[idx] = make_render_vertices(env, &rm, opts, &layout_values[layout_idx], attribute_layouts);
+    }
+    idx++;
+    layout_keys[layout_idx] = atom_vertices;
+    layout_idx++;
+    
+    keys[idx] = atom_indices;
+    values[idx] = make_render_indices(env, rm.indices, rm.num_indices, rm.num_vertices,
+                                      &layout_values[layout_idx]);
+    idx++;
+    layout_keys[layout_idx] = atom_indices;
+    layout_idx++;
+    
+    keys[idx] = atom_draw_ranges;
+    values[idx] = make_draw_ranges(env, mesh, rm.parts, rm.num_parts, &layout_values[layout_idx]);
+    idx++;
+    layout_keys[layout_idx] = atom_draw_ranges;
+    layout_idx++;
+    
+    const ERL_NIF_TERM attribute_names[RENDER_ATTRIBUTE_COUNT] = {
+        atom_positions, atom_normals, atom_texcoords, atom_colors, atom_tangents,
+    };
+    for (int i = 0; i < RENDER_ATTRIBUTE_COUNT; i++) {
+        if (rm.offsets[i] == RENDER_NO_ATTRIBUTE) continue;
+        layout_keys[layout_idx] = attribute_names[i];
+        layout_values[layout_idx] = attribute_layouts[i];
+        layout_idx++;
+    }
+    
+    // material_ids
+    if (mesh->materials.count > 0) {
+        ERL_NIF_TERM material_ids = enif_make_list(env, 0);
+        for (size_t i = mesh->materials.count; i > 0; i--) {
+            ERL_NIF_TERM mat_id = enif_make_uint(env, mesh->materials.data[i - 1]->typed_id);
+            material_ids = enif_make_list_cell(env, mat_id, material_ids);
+        }
+        keys[idx] = atom_material_ids;
+        values[idx] = material_ids;
+        idx++;
+    }
+    
+    // skin, per render vertex
+    if (mesh_skin(mesh)) {
+        keys[idx] = atom_skin;
+        values[idx] = make_skin(env, mesh, rm.vertex_indices, rm.num_vertices, opts);
+        if (values[idx] == atom_error) {
+            free_render_mesh(&rm);
+            return atom_error;
+        }
+        idx++;
+    }
+    
+    // blend_channels, moving render vertices
+    if (mesh_has_blend(mesh)) {
+        keys[idx] = atom_blend_channels;
+        values[idx] = make_blend_channels(env, mesh, rm.vertex_indices, rm.num_vertices);
+        if (values[idx] == atom_error) {
+            free_render_mesh(&rm);
+            return atom_error;
+        }
+        idx++;
+    }
+    
+    if (mesh->cache_deformers.count > 0) {
+        keys[idx] = atom_cache_deformers;
+        values[idx] = make_cache_deformers(env, mesh);
+        idx++;
+    }
+    
+    keys[idx] = atom_layout;
+    values[idx] = make_map(env, layout_keys, layout_values, layout_idx);
+    idx++;
+    
+    free_render_mesh(&rm);
+    return make_map(env, keys, values, idx);
+}
+
+// Helper: Catmull-Clark levels `opts` asks for on `mesh`. Authored levels only
+// apply if the mesh is displayed smoothed at all.
+static size_t subdivision_level(const ufbx_mesh *mesh, const extract_opts *opts) {
+    size_t level = opts->subdivide;
+    if (level == SUBDIVIDE_PREVIEW || level == SUBDIVIDE_RENDER) {
+        if (mesh->subdivision_display_mode == UFBX_SUBDIVISION_DISPLAY_DISABLED) {
+            return 0;
+        }
+        level = level == SUBDIVIDE_PREVIEW ? mesh->subdivision_preview_levels : mesh->subdivision_render_levels;
+    }
+    return level < MAX_SUBDIVISION_LEVEL ? level : MAX_SUBDIVISION_LEVEL;
+}
+
+// Helper: Subdivide `mesh` with its authored boundary rules and edge creases.
+// Sets `*result` to NULL if the mesh needs no subdivision. Returns 0 on failure.
+static int subdivide_for_extract(const ufbx_mesh *mesh, const extract_opts *opts, ufbx_mesh **result) {
+    *result = NULL;
+    size_t level = subdivision_level(mesh, opts);
+    if (level == 0 || mesh->num_faces == 0) {
+        return 1;
+    }
+    
+    ufbx_subdivide_opts subdivide_opts = { 0 };
+    subdivide_opts.boundary = mesh->subdivision_boundary;
+    subdivide_opts.uv_boundary = mesh->subdivision_uv_boundary;
+    subdivide_opts.interpolate_tangents = mesh->vertex_tangent.exists;
+    subdivide_opts.evaluate_skin_weights = mesh_skin(mesh) != NULL;
+    subdivide_opts.max_skin_weights = MAX_INFLUENCES;
+    ufbx_error error;
+    *result = ufbx_subdivide_mesh(mesh, level, &subdivide_opts, &error);
+    return *result != NULL;
+}
+
+// Subdivision of many meshes, one thread pool task per mesh
+typedef struct subdivide_task {
+    ufbx_mesh *const *meshes;
+    ufbx_mesh **results;
+    unsigned char *failed;
+    const extract_opts *opts;
+} subdivide_task;
+
+static void run_subdivide_task(void *user, uint32_t index) {
+    subdivide_task *task = (subdivide_task*)user;
+    task->failed[index] = !subdivide_for_extract(task->meshes[index], task->opts, &task->results[index]);
+}
+
+// Helper: Call `fn(user, i)` for every `i < count`, spread over the native
+// thread pool when there is one, and wait for all of them
+static void run_parallel(void (*fn)(void *user, uint32_t index), void *user, size_t count) {
+    if (thread_pool && count > 1) {
+        uint64_t id = ufbx_os_thread_pool_run(thread_pool, fn, user, (uint32_t)count);
+        ufbx_os_thread_pool_wait(thread_pool, id);
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            fn(user, (uint32_t)i);
+        }
+    }
+}
+
+// Helper: Subdivide `count` meshes into `results` (NULL where not needed),
+// in parallel. `failed[i]` is set for meshes that could not be subdivided.
+static void subdivide_meshes(ufbx_mesh *const *meshes, size_t count, const extract_opts *opts,
+                             ufbx_mesh **results, unsigned char *failed) {
+    subdivide_task task = { meshes, results, failed, opts };
+    run_parallel(&run_subdivide_task, &task, count);
+}
+
+// Helper: Segments per knot span `opts` asks for on one axis of a surface
+static size_t span_subdivision(uint32_t authored, const extract_opts *opts) {
+    size_t segments = opts->span_subdivision == SPAN_SUBDIVISION_AUTHORED ? authored : opts->span_subdivision;
+    return segments < MAX_SPAN_SUBDIVISION ? segments : MAX_SPAN_SUBDIVISION;
+}
+
+// Tessellation of many NURBS surfaces, one thread pool task per surface
+typedef struct tessellate_task {
+    ufbx_nurbs_surface *const *surfaces;
+    ufbx_mesh **results;
+    ufbx_error *errors;
+    const extract_opts *opts;
+} tessellate_task;
+
+static void run_tessellate_task(void *user, uint32_t index) {
+    tessellate_task *task = (tessellate_task*)user;
+    const ufbx_nurbs_surface *surface = task->surfaces[index];
+    
+    ufbx_tessellate_surface_opts tessellate_opts = { 0 };
+    tessellate_opts.span_subdivision_u = span_subdivision(surface->span_subdivision_u, task->opts);
+    tessellate_opts.span_subdivision_v = span_subdivision(surface->span_subdivision_v, task->opts);
+    ufbx_mesh *mesh = ufbx_tessellate_nurbs_surface(surface, &tessellate_opts, &task->errors[index]);
+    
+    // The tessellated mesh is anonymous, so it takes on the surface's identity
+    if (mesh) {
+        mesh->name = surface->name;
+        mesh->typed_id = surface->typed_id;
+    }
+    task->results[index] = mesh;
+}
+
+// Helper: Tessellate `count` NURBS surfaces into polygon meshes in parallel.
+// `results[i]` is NULL for surfaces that could not be tessellated, with the
+// reason in `errors[i]`.
+static void tessellate_surfaces(ufbx_nurbs_surface *const *surfaces, size_t count, const extract_opts *opts,
+                                ufbx_mesh **results, ufbx_error *errors) {
+    tessellate_task task = { surfaces, results, errors, opts };
+    run_parallel(&run_tessellate_task, &task, count);
+}
+
+// Extract mesh data from ufbx_mesh to Elixir map
+static ERL_NIF_TERM extract_mesh(ErlNifEnv* env, ufbx_mesh *mesh, const extract_opts *opts) {
+    if (opts->render) {
+        return extract_render_mesh(env, mesh, opts);
+    }
+    
+    ERL_NIF_TERM keys[11];
+    ERL_NIF_TERM values[11];
+    size_t idx = 0;
+    
+    // Layout of packed attributes, keyed like the attributes themselves
+    ERL_NIF_TERM layout_keys[4];
+    ERL_NIF_TERM layout_values[4];
+    size_t layout_idx = 0;
+    
+    // id
+    keys[idx] = atom_id;
+    values[idx] = enif_make_uint(env, mesh->typed_id);
+    idx++;
+    
+    // name
+    keys[idx] = atom_name;
+    values[idx] = make_string(env, mesh->name);
+    idx++;
+    
+    // positions (from vertex_position)
+    if (mesh->vertex_position.exists && mesh->vertex_position.values.count > 0) {
+        ERL_NIF_TERM positions;
+        if (opts->packed) {
+            layout_keys[layout_idx] = atom_positions;
+            positions = make_packed_reals(env, &mesh->vertex_position.values.data[0].x,
+                mesh->vertex_position.values.count, 3, opts, &layout_values[layout_idx]);
+            layout_idx++;
+        } else {
+            positions = make_vec3_list(env, mesh->vertex_position.values);
+        }
+        keys[idx] = atom_positions;
+        values[idx] = positions;
+        idx++;
+        
+        // indices (from vertex_position.indices)
+        if (mesh->vertex_position.indices.count > 0) {
+            ERL_NIF_TERM indices;
+            if (opts->packed) {
+                layout_keys[layout_idx] = atom_indices;
+                indices = make_packed_uint32(env, mesh->vertex_position.indices, opts, &layout_values[layout_idx]);
+                layout_idx++;
+            } else {
+                indices = make_uint32_list(env, mesh->vertex_position.indices);
+            }
+            keys[idx] = atom_indices;
+            values[idx] = indices;
+            idx++;
+        }
+    }
+    
+    // normals (from vertex_normal)
+    if (mesh->vertex_normal.exists && mesh->vertex_normal.values.count > 0) {
+        ERL_NIF_TERM normals;
+        if (opts->packed) {
+            layout_keys[layout_idx] = atom_normals;
+            normals = make_packed_reals(env, &mesh->vertex_normal.values.data[0].x,
+                mesh->vertex_normal.values.count, 3, opts, &layout_values[layout_idx]);
+            layout_idx++;
+        } else {
+            normals = make_vec3_list(env, mesh->vertex_normal.values);
+        }
+        keys[idx] = atom_normals;
+        values[idx] = normals;
+        idx++;
+    }
+    
+    // texcoords (from vertex_uv)
+    if (mesh->vertex_uv.exists && mesh->vertex_uv.values.count > 0) {
+        ERL_NIF_TERM texcoords;
+        if (opts->packed) {
+            layout_keys[layout_idx] = atom_texcoords;
+            texcoords = make_packed_reals(env, &mesh->vertex_uv.values.data[0].x,
+                mesh->vertex_uv.values.count, 2, opts, &layout_values[layout_idx]);
+            layout_idx++;
+        } else {
+            texcoords = enif_make_list(env, 0);
+            for (size_t i = mesh->vertex_uv.values.count; i > 0; i--) {
+                ufbx_vec2 uv = mesh->vertex_uv.values.data[i - 1];
+                ERL_NIF_TERM u = enif_make_double(env, uv.x);
+                ERL_NIF_TERM v = enif_make_double(env, uv.y);
+                ERL_NIF_TERM uv_vec = enif_make_list2(env, u, v);
+                texcoords = enif_make_list_cell(env, uv_vec, texcoords);
+            }
+        }
+        keys[idx] = atom_texcoords;
+        values[idx] = texcoords;
+        idx++;
+    }
+    
+    // material_ids
+    if (mesh->materials.count > 0) {
+        ERL_NIF_TERM material_ids = enif_make_list(env, 0);
+        for (size_t i = mesh->materials.count; i > 0; i--) {
+            ERL_NIF_TERM mat_id = enif_make_uint(env, mesh->materials.data[i - 1]->typed_id);
+            material_ids = enif_make_list_cell(env, mat_id, material_ids);
+        }
+        keys[idx] = atom_material_ids;
+        values[idx] = material_ids;
+        idx++;
+    }
+    
+    // skin, per vertex of `positions`
+    if (mesh_skin(mesh)) {
+        keys[idx] = atom_skin;
+        values[idx] = make_skin(env, mesh, NULL, mesh->num_vertices, opts);
+        if (values[idx] == atom_error) {
+            return atom_error;
+        }
+        idx++;
+    }
+    
+    // blend_channels, moving `positions` vertices
+    if (mesh_has_blend(mesh)) {
+        keys[idx] = atom_blend_channels;
+        values[idx] = make_blend_channels(env, mesh, NULL, mesh->num_vertices);
+        idx++;
+    }
+    
+    if (mesh->cache_deformers.count > 0) {
+        keys[idx] = atom_cache_deformers;
+        values[idx] = make_cache_deformers(env, mesh);
+        idx++;
+    }
+    
+    // layout (packed mode only)
+    if (opts->packed) {
+        ERL_NIF_TERM layout = make_map(env, layout_keys, layout_values, layout_idx);
+        keys[idx] = atom_layout;
+        values[idx] = layout;
+        idx++;
+    }
+    
+    return make_map(env, keys, values, idx);
+}
+
+// Stand-in for NURBS geometry that could not be tessellated: %{id, name,
+// error} with ufbx's description of the problem as `error`
+static ERL_NIF_TERM make_tessellation_error(ErlNifEnv* env, uint32_t typed_id, ufbx_string name,
+                                            const ufbx_error *error) {
+    ERL_NIF_TERM keys[3] = { atom_id, atom_name, atom_error };
+    ERL_NIF_TERM values[3];
+    values[0] = enif_make_uint(env, typed_id);
+    values[1] = make_string(env, name);
+    values[2] = make_string(env, error->description);
+    return make_map(env, keys, values, 3);
+}
+
+// Extract a NURBS curve as a polyline: `positions` and `indices` binaries
+// in the packed format, the indices tracing the line from start to end
+// (repeating the first point for closed curves). See
+// `make_tessellation_error()` for curves that could not be tessellated.
+static ERL_NIF_TERM extract_nurbs_curve(ErlNifEnv* env, const ufbx_nurbs_curve *curve, const extract_opts *opts) {
+    ufbx_tessellate_curve_opts tessellate_opts = { 0 };
+    // Curves have no authored rate, so `:authored` falls back to the ufbx default
+    tessellate_opts.span_subdivision = span_subdivision(0, opts);
+    ufbx_error error;
+    ufbx_line_curve *line = ufbx_tessellate_nurbs_curve(curve, &tessellate_opts, &error);
+    if (!line) {
+        return make_tessellation_error(env, curve->typed_id, curve->name, &error);
+    }
+    
+    // The line is freed below, so the binaries must not alias it
+    extract_opts packed_opts = *opts;
+    packed_opts.owner = NULL;
+    
+    ERL_NIF_TERM layout_keys[2] = { atom_positions, atom_indices };
+    ERL_NIF_TERM layout_values[2];
+    ERL_NIF_TERM keys[5] = { atom_id, atom_name, atom_positions, atom_indices, atom_layout };
+    ERL_NIF_TERM values[5];
+    values[0] = enif_make_uint(env, curve->typed_id);
+    values[1] = make_string(env, curve->name);
+    const ufbx_real *points = line->control_points.count > 0 ? &line->control_points.data[0].x : NULL;
+    values[2] = make_packed_reals(env, points, line->control_points.count, 3, &packed_opts, &layout_values[0]);
+    values[3] = make_packed_uint32(env, line->point_indices, &packed_opts, &layout_values[1]);
+    values[4] = make_map(env, layout_keys, layout_values, 2);
+    
+    ufbx_free_line_curve(line);
+    return make_map(env, keys, values, 5);
+}
+
+// Extract material data from ufbx_material to Elixir map
+static ERL_NIF_TERM extract_material(ErlNifEnv* env, ufbx_material *material) {
+    ERL_NIF_TERM keys[10];
+    ERL_NIF_TERM values[10];
+    size_t idx = 0;
+    
+    // id
+    keys[idx] = atom_id;
+    values[idx] = enif_make_uint(env, material->typed_id);
+    idx++;
+    
+    // name
+    keys[idx] = atom_name;
+    values[idx] = make_string(env, material->name);
+    idx++;
+    
+    // diffuse_color (from PBR base_color or FBX diffuse)
+    if (material->pbr.base_color.has_value && material->pbr.base_color.value_components >= 3) {
+        ufbx_vec3 color = material->pbr.base_color.value_vec3;
+        keys[idx] = atom_diffuse_color;
+        values[idx] = make_vec3(env, color);
+        idx++;
+    } else if (material->fbx.diffuse_color.has_value && material->fbx.diffuse_color.value_components >= 3) {
+        ufbx_vec3 color = material->fbx.diffuse_color.value_vec3;
+        keys[idx] = atom_diffuse_color;
+        values[idx] = make_vec3(env, color);
+        idx++;
+    }
+    
+    // specular_color (from PBR specular_color or FBX)
+    if (material->pbr.specular_color.has_value && material->pbr.specular_color.value_components >= 3) {
+        ufbx_vec3 color = material->pbr.specular_color.value_vec3;
+        keys[idx] = atom_specular_color;
+        values[idx] = make_vec3(env, color);
+        idx++;
+    } else if (material->fbx.specular_color.has_value && material->fbx.specular_color.value_components >= 3) {
+        ufbx_vec3 color = material->fbx.specular_color.value_vec3;
+        keys[idx] = atom_specular_color;
+        values[idx] = make_vec3(env, color);
+        idx++;
+    }
+    
+    // emissive_color (from PBR emission_color or FBX)
+    if (material->pbr.emission_color.has_value && material->pbr.emission_color.value_components >= 3) {
+        ufbx_vec3 color = material->pbr.emission_color.value_vec3;
+        keys[idx] = atom_emissive_color;
+        values[idx] = make_vec3(env, color);
+        idx++;
+    } else if (material->fbx.emission_color.has_value && material->fbx.emission_color.value_components >= 3) {
+        ufbx_vec3 color = material->fbx.emission_color.value_vec3;
+        keys[idx] = atom_emissive_color;
+        values[idx] = make_vec3(env, color);
+        idx++;
+    }
+    
+    return make_map(env, keys, values, idx);
+}
+
+// Extract texture data from ufbx_texture to Elixir map
+static ERL_NIF_TERM extract_texture(ErlNifEnv* env, ufbx_texture *texture) {
+    ERL_NIF_TERM keys[5];
+    ERL_NIF_TERM values[5];
+    size_t idx = 0;
+    
+    // id
+    keys[idx] = atom_id;
+    values[idx] = enif_make_uint(env, texture->typed_id);
+    idx++;
+    
+    // name
+    keys[idx] = atom_name;
+    values[idx] = make_string(env, texture->name);
+    idx++;
+    
+    // file_path (from filename)
+    if (texture->filename.length > 0) {
+        keys[idx] = atom_file_path;
+        values[idx] = make_string(env, texture->filename);
+        idx++;
+    }
+    
+    return make_map(env, keys, values, idx);
+}
+
+// Extract keyframe from ufbx_baked_vec3 to Elixir map (translation/scale)
+static ERL_NIF_TERM extract_vec3_keyframe(ErlNifEnv* env, ufbx_baked_vec3 *key, ERL_NIF_TERM field,
+                                          ERL_NIF_TERM node_id) {
+    ERL_NIF_TERM keys[3] = { atom_node_id, atom_time, field };
+    ERL_NIF_TERM values[3] = { node_id, enif_make_double(env, key->time), make_vec3(env, key->value) };
+    return make_map(env, keys, values, 3);
+}
+
+// Extract keyframe from ufbx_baked_quat to Elixir map (rotation)
+static ERL_NIF_TERM extract_quat_keyframe(ErlNifEnv* env, ufbx_baked_quat *key, ERL_NIF_TERM node_id) {
+    // Convert ufbx_quat to vec4 format [x, y, z, w]
+    ERL_NIF_TERM x = enif_make_double(env, key->value.x);
+    ERL_NIF_TERM y = enif_make_double(env, key->value.y);
+    ERL_NIF_TERM z = enif_make_double(env, key->value.z);
+    ERL_NIF_TERM w = enif_make_double(env, key->value.w);
+    
+    ERL_NIF_TERM keys[3] = { atom_node_id, atom_time, atom_rotation };
+    ERL_NIF_TERM values[3] = { node_id, enif_make_double(env, key->time), enif_make_list4(env, x, y, z, w) };
+    return make_map(env, keys, values, 3);
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+// Helper: Check whether a baked channel is keyed exactly at `times`
+static int vec3_keys_match(ufbx_baked_vec3_list keys, const double *times, size_t count) {
+    if (keys.count != count) return 0;
+    for (size_t i = 0; i < count; i++) {
+        if (keys.data[i].time != times[i]) return 0;
+    }
+    return 1;
+}
+
+static int quat_keys_match(ufbx_baked_quat_list keys, const double *times, size_t count) {
+    if (keys.count != count) return 0;
+    for (size_t i = 0; i < count; i++) {
+        if (keys.data[i].time != times[i]) return 0;
+    }
+    return 1;
+}
+
+// Helper: Sorted union of the key times of all channels of a baked node.
+// `times` must have room for the sum of the three key counts.
+static size_t merge_baked_times(const ufbx_baked_node *node, double *times) {
+    size_t count = 0;
+    for (size_t i = 0; i < node->translation_keys.count; i++) times[count++] = node->translation_keys.data[i].time;
+    
+    // Common case: everything was resampled on the same frames
+    if (quat_keys_match(node->rotation_keys, times, count) && vec3_keys_match(node->scale_keys, times, count)) {
+        return count;
+    }
+    
+    for (size_t i = 0; i < node->rotation_keys.count; i++) times[count++] = node->rotation_keys.data[i].time;
+    for (size_t i = 0; i < node->scale_keys.count; i++) times[count++] = node->scale_keys.data[i].time;
+    qsort(times, count, sizeof(double), compare_doubles);
+    
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (unique == 0 || times[i] != times[unique - 1]) {
+            times[unique++] = times[i];
+        }
+    }
+    return unique;
+}
+
+// Extract one baked node as a channel: %{node_id, times, translation, rotation, scale}.
+// All value binaries are sampled at `times` (f64), values use the requested precision.
+static ERL_NIF_TERM extract_channel(ErlNifEnv* env, const ufbx_baked_node *node, const extract_opts *opts,
+                                    double *times_buf) {
+    size_t count = merge_baked_times(node, times_buf);
+    size_t elem_size = opts->use_f32 ? sizeof(float) : sizeof(double);
+    
+    ERL_NIF_TERM times, translation, rotation, scale;
+    unsigned char *times_dst = enif_make_new_binary(env, count * sizeof(double), &times);
+    unsigned char *t_dst = enif_make_new_binary(env, count * 3 * elem_size, &translation);
+    unsigned char *r_dst = enif_make_new_binary(env, count * 4 * elem_size, &rotation);
+    unsigned char *s_dst = enif_make_new_binary(env, count * 3 * elem_size, &scale);
+    
+    int t_direct = vec3_keys_match(node->translation_keys, times_buf, count);
+    int r_direct = quat_keys_match(node->rotation_keys, times_buf, count);
+    int s_direct = vec3_keys_match(node->scale_keys, times_buf, count);
+    
+    for (size_t i = 0; i < count; i++) {
+        double t = times_buf[i];
+        store_f64_le(times_dst + i * sizeof(double), t);
+        
+        ufbx_vec3 tv = t_direct ? node->translation_keys.data[i].value
+                                : ufbx_evaluate_baked_vec3(node->translation_keys, t);
+        ufbx_quat rv = r_direct ? node->rotation_keys.data[i].value
+                                : ufbx_evaluate_baked_quat(node->rotation_keys, t);
+        ufbx_vec3 sv = s_direct ? node->scale_keys.data[i].value
+                                : ufbx_evaluate_baked_vec3(node->scale_keys, t);
+        store_packed_reals(t_dst, i, &tv.x, 3, opts);
+        store_packed_reals(r_dst, i, &rv.x, 4, opts);
+        store_packed_reals(s_dst, i, &sv.x, 3, opts);
+    }
+    
+    ERL_NIF_TERM keys[6] = { atom_node_id, atom_times, atom_translation, atom_rotation, atom_scale, atom_precision };
+    ERL_NIF_TERM values[6] = { enif_make_uint(env, node->typed_id), times, translation, rotation, scale,
+                               opts->use_f32 ? atom_f32 : atom_f64 };
+    return make_map(env, keys, values, 6);
+}
+
+// Extract animation data from ufbx_baked_anim to Elixir map. Returns
+// `atom_error` if out of memory.
+static ERL_NIF_TERM extract_animation(ErlNifEnv* env, ufbx_baked_anim *baked, ufbx_anim_stack *anim_stack,
+                                      const extract_opts *opts) {
+    ERL_NIF_TERM keys[4];
+    ERL_NIF_TERM values[4];
+    size_t idx = 0;
+    
+    // id (use anim_stack typed_id)
+    keys[idx] = atom_id;
+    values[idx] = enif_make_uint(env, anim_stack->typed_id);
+    idx++;
+    
+    // name
+    keys[idx] = atom_name;
+    values[idx] = make_string(env, anim_stack->name);
+    idx++;
+    
+    if (opts->channels) {
+        // Scratch space for the merged key times of the largest node
+        size_t max_keys = 0;
+        for (size_t i = 0; i < baked->nodes.count; i++) {
+            ufbx_baked_node *node = &baked->nodes.data[i];
+            size_t keys_count = node->translation_keys.count + node->rotation_keys.count + node->scale_keys.count;
+            if (keys_count > max_keys) max_keys = keys_count;
+        }
+        double *times_buf = (double*)enif_alloc((max_keys > 0 ? max_keys : 1) * sizeof(double));
+        if (!times_buf) {
+            return atom_error;
+        }
+        
+        ERL_NIF_TERM channels = enif_make_list(env, 0);
+        for (size_t i = baked->nodes.count; i > 0; i--) {
+            ERL_NIF_TERM channel = extract_channel(env, &baked->nodes.data[i - 1], opts, times_buf);
+            channels = enif_make_list_cell(env, channel, channels);
+        }
+        enif_free(times_buf);
+        
+        keys[idx] = atom_channels;
+        values[idx] = channels;
+        idx++;
+        return make_map(env, keys, values, idx);
+    }
+    
+    // Extract keyframes per node
+    ERL_NIF_TERM all_keyframes = enif_make_list(env, 0);
+    
+    for (size_t i = baked->nodes.count; i > 0; i--) {
+        ufbx_baked_node *baked_node = &baked->nodes.data[i - 1];
+        ERL_NIF_TERM node_id = enif_make_uint(env, baked_node->typed_id);
+        
+        // Extract translation keyframes
+        for (size_t j = baked_node->translation_keys.count; j > 0; j--) {
+            ufbx_baked_vec3 *trans_key = &baked_node->translation_keys.data[j - 1];
+            ERL_NIF_TERM keyframe = extract_vec3_keyframe(env, trans_key, atom_translation, node_id);
+            all_keyframes = enif_make_list_cell(env, keyframe, all_keyframes);
+        }
+        
+        // Extract rotation keyframes
+        for (size_t j = baked_node->rotation_keys.count; j > 0; j--) {
+            ufbx_baked_quat *rot_key = &baked_node->rotation_keys.data[j - 1];
+            ERL_NIF_TERM keyframe = extract_quat_keyframe(env, rot_key, node_id);
+            all_keyframes = enif_make_list_cell(env, keyframe, all_keyframes);
+        }
+        
+        // Extract scale keyframes
+        for (size_t j = baked_node->scale_keys.count; j > 0; j--) {
+            ufbx_baked_vec3 *scale_key = &baked_node->scale_keys.data[j - 1];
+            ERL_NIF_TERM keyframe = extract_vec3_keyframe(env, scale_key, atom_scale, node_id);
+            all_keyframes = enif_make_list_cell(env, keyframe, all_keyframes);
+        }
+    }
+    
+    // keyframes
+    keys[idx] = atom_keyframes;
+    values[idx] = all_keyframes;
     idx++;
     
-    // file_path (from filename)
-    if (texture->filename.length > 0) {
-        keys[idx] = enif_make_atom(env, "file_path");
-        values[idx] = make_string(env, texture->filename);
-        idx++;
+    return make_map(env, keys, values, idx);
+}
+
+// Bake an animation stack and extract it to an Elixir map. Returns 0 if
+// baking fails; `out` is `atom_error` if extraction runs out of memory.
+static int extract_anim_stack(ErlNifEnv* env, ufbx_scene *scene, ufbx_anim_stack *anim_stack,
+                              const extract_opts *opts, ERL_NIF_TERM *out) {
+    ufbx_error error;
+    ufbx_baked_anim *baked = ufbx_bake_anim(scene, anim_stack->anim, &opts->bake, &error);
+    if (!baked) {
+        return 0;
+    }
+    
+    *out = extract_animation(env, baked, anim_stack, opts);
+    ufbx_free_baked_anim(baked);
+    return 1;
+}
+
+// Helper: Check whether an animation stack was requested by `:anim_stacks`
+static int anim_stack_selected(ErlNifEnv* env, const extract_opts *opts, ufbx_anim_stack *anim_stack) {
+    if (enif_is_identical(opts->anim_stacks, atom_all)) {
+        return 1;
+    }
+    
+    ERL_NIF_TERM head, tail = opts->anim_stacks;
+    while (enif_get_list_cell(env, tail, &head, &tail)) {
+        unsigned int index;
+        ErlNifBinary name;
+        if (enif_get_uint(env, head, &index)) {
+            if (index == anim_stack->typed_id) return 1;
+        } else if (enif_inspect_binary(env, head, &name)) {
+            if (name.size == anim_stack->name.length &&
+                memcmp(name.data, anim_stack->name.data, name.size) == 0) return 1;
+        }
+    }
+    return 0;
+}
+
+// Helper: Build version string from scene metadata
+static ERL_NIF_TERM make_version(ErlNifEnv* env, ufbx_scene *scene) {
+    char version_str[32];
+    snprintf(version_str, sizeof(version_str), "FBX %u.%u", 
+             scene->metadata.version / 1000, 
+             (scene->metadata.version % 1000) / 100);
+    return enif_make_string(env, version_str, ERL_NIF_LATIN1);
+}
+
+// Helper: Extract scene data from ufbx_scene to Elixir map. Returns 0 with
+// `{:error, reason}` in `out` if a mesh fails to subdivide or build, or if
+// extraction runs out of memory.
+static int extract_scene_data(ErlNifEnv* env, ufbx_scene *scene, const extract_opts *opts, ERL_NIF_TERM *out) {
+    // Build nodes list
+    ERL_NIF_TERM nodes = enif_make_list(env, 0);
+    for (size_t i = scene->nodes.count; i > 0; i--) {
+        ufbx_node *node = scene->nodes.data[i - 1];
+        ERL_NIF_TERM node_term = extract_node(env, node, node->typed_id);
+        nodes = enif_make_list_cell(env, node_term, nodes);
+    }
+    
+    // Subdivide up front so the meshes can be processed in parallel. A mesh
+    // that fails to subdivide fails the whole load.
+    size_t num_meshes = scene->meshes.count;
+    ufbx_mesh **subdivided = NULL;
+    unsigned char *failed = NULL;
+    int subdivide_failed = 0;
+    if (opts->subdivide > 0 && num_meshes > 0) {
+        subdivided = (ufbx_mesh**)enif_alloc(num_meshes * sizeof(ufbx_mesh*));
+        failed = (unsigned char*)enif_alloc(num_meshes);
+        if (subdivided && failed) {
+            subdivide_meshes(scene->meshes.data, num_meshes, opts, subdivided, failed);
+        } else {
+            if (subdivided) enif_free(subdivided);
+            if (failed) enif_free(failed);
+            subdivided = NULL;
+            subdivide_failed = 1;
+        }
+    }
+    
+    // Build meshes list. After a failure the remaining subdivided meshes are
+    // only freed.
+    const char *mesh_error = subdivide_failed ? "failed to subdivide mesh" : NULL;
+    ERL_NIF_TERM meshes = enif_make_list(env, 0);
+    for (size_t i = num_meshes; i > 0; i--) {
+        ufbx_mesh *mesh = scene->meshes.data[i - 1];
+        ERL_NIF_TERM mesh_term = atom_error;
+        if (subdivided && failed[i - 1]) {
+            mesh_error = "failed to subdivide mesh";
+        } else if (subdivided && subdivided[i - 1]) {
+            if (!mesh_error) mesh_term = extract_mesh(env, subdivided[i - 1], opts);
+            ufbx_free_mesh(subdivided[i - 1]);
+        } else if (!mesh_error) {
+            mesh_term = extract_mesh(env, mesh, opts);
+        }
+        if (!mesh_error && enif_is_identical(mesh_term, atom_error)) {
+            mesh_error = "out of memory";
+        }
+        meshes = enif_make_list_cell(env, mesh_term, meshes);
+    }
+    if (subdivided) {
+        enif_free(subdivided);
+        enif_free(failed);
+    }
+    if (mesh_error) {
+        *out = make_error(env, mesh_error);
+        return 0;
+    }
+    
+    // Tessellate NURBS surfaces in parallel, then extract them like polygon
+    // meshes. The tessellated meshes are freed right away, so nothing may
+    // alias them. Surfaces that fail to tessellate come out as
+    // `make_tessellation_error()` maps.
+    extract_opts nurbs_opts = *opts;
+    nurbs_opts.owner = NULL;
+    size_t num_surfaces = scene->nurbs_surfaces.count;
+    ERL_NIF_TERM nurbs_surfaces = enif_make_list(env, 0);
+    if (num_surfaces > 0) {
+        ufbx_mesh **tessellated = (ufbx_mesh**)enif_alloc(num_surfaces * sizeof(ufbx_mesh*));
+        ufbx_error *errors = (ufbx_error*)enif_alloc(num_surfaces * sizeof(ufbx_error));
+        if (!tessellated || !errors) {
+            if (tessellated) enif_free(tessellated);
+            if (errors) enif_free(errors);
+            *out = make_error(env, "out of memory");
+            return 0;
+        }
+        tessellate_surfaces(scene->nurbs_surfaces.data, num_surfaces, opts, tessellated, errors);
+        
+        int out_of_memory = 0;
+        for (size_t i = num_surfaces; i > 0; i--) {
+            const ufbx_nurbs_surface *surface = scene->nurbs_surfaces.data[i - 1];
+            ERL_NIF_TERM surface_term = atom_error;
+            if (!tessellated[i - 1]) {
+                surface_term = make_tessellation_error(env, surface->typed_id, surface->name, &errors[i - 1]);
+            } else {
+                if (!out_of_memory) surface_term = extract_mesh(env, tessellated[i - 1], &nurbs_opts);
+                ufbx_free_mesh(tessellated[i - 1]);
+            }
+            out_of_memory = out_of_memory || enif_is_identical(surface_term, atom_error);
+            nurbs_surfaces = enif_make_list_cell(env, surface_term, nurbs_surfaces);
+        }
+        enif_free(tessellated);
+        enif_free(errors);
+        if (out_of_memory) {
+            *out = make_error(env, "out of memory");
+            return 0;
+        }
+    }
+    
+    // Build NURBS curves list
+    ERL_NIF_TERM nurbs_curves = enif_make_list(env, 0);
+    for (size_t i = scene->nurbs_curves.count; i > 0; i--) {
+        ERL_NIF_TERM curve_term = extract_nurbs_curve(env, scene->nurbs_curves.data[i - 1], opts);
+        nurbs_curves = enif_make_list_cell(env, curve_term, nurbs_curves);
+    }
+    
+    // Build materials list
+    ERL_NIF_TERM materials = enif_make_list(env, 0);
+    for (size_t i = scene->materials.count; i > 0; i--) {
+        ufbx_material *material = scene->materials.data[i - 1];
+        ERL_NIF_TERM material_term = extract_material(env, material);
+        materials = enif_make_list_cell(env, material_term, materials);
+    }
+    
+    // Build textures list
+    ERL_NIF_TERM textures = enif_make_list(env, 0);
+    for (size_t i = scene->textures.count; i > 0; i--) {
+        ufbx_texture *texture = scene->textures.data[i - 1];
+        ERL_NIF_TERM texture_term = extract_texture(env, texture);
+        textures = enif_make_list_cell(env, texture_term, textures);
+    }
+    
+    // Extract animations from anim_stacks
+    ERL_NIF_TERM animations = enif_make_list(env, 0);
+    for (size_t i = scene->anim_stacks.count; i > 0; i--) {
+        ERL_NIF_TERM animation_term;
+        if (!anim_stack_selected(env, opts, scene->anim_stacks.data[i - 1])) {
+            continue;
+        }
+        if (extract_anim_stack(env, scene, scene->anim_stacks.data[i - 1], opts, &animation_term)) {
+            if (enif_is_identical(animation_term, atom_error)) {
+                *out = make_error(env, "out of memory");
+                return 0;
+            }
+            animations = enif_make_list_cell(env, animation_term, animations);
+        }
+    }
+    
+    // Build result map
+    ERL_NIF_TERM keys[8];
+    ERL_NIF_TERM values[8];
+    keys[0] = atom_version;
+    values[0] = make_version(env, scene);
+    keys[1] = atom_nodes;
+    values[1] = nodes;
+    keys[2] = atom_meshes;
+    values[2] = meshes;
+    keys[3] = atom_materials;
+    values[3] = materials;
+    keys[4] = atom_textures;
+    values[4] = textures;
+    keys[5] = atom_animations;
+    values[5] = animations;
+    keys[6] = atom_nurbs_surfaces;
+    values[6] = nurbs_surfaces;
+    keys[7] = atom_nurbs_curves;
+    values[7] = nurbs_curves;
+    
+    *out = make_map(env, keys, values, 8);
+    return 1;
+}
+
+static ERL_NIF_TERM load_fbx_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    ErlNifBinary file_path_bin;
+    ufbx_error error;
+    ufbx_scene *scene;
+    
+    // Get file path from Elixir
+    if (!enif_inspect_binary(env, argv[0], &file_path_bin)) {
+        return enif_make_badarg(env);
+    }
+    
+    extract_opts extract = { 0 };
+    parse_extract_opts(env, argv[1], &extract);
+    
+    // Null-terminate the path
+    char file_path[file_path_bin.size + 1];
+    memcpy(file_path, file_path_bin.data, file_path_bin.size);
+    file_path[file_path_bin.size] = '\0';
+    
+    // Load FBX file using ufbx
+    ufbx_load_opts opts = { 0 };
+    parse_load_opts(env, argv[1], &opts);
+    scene = ufbx_load_file(file_path, &opts, &error);
+    
+    if (!scene) {
+        // Return error tuple
+        return enif_make_tuple2(env,
+            atom_error,
+            enif_make_string(env, error.description.data, ERL_NIF_LATIN1));
+    }
+    
+    // Extract scene data
+    ERL_NIF_TERM scene_data;
+    int extracted = extract_scene_data(env, scene, &extract, &scene_data);
+    
+    // Free scene
+    ufbx_free_scene(scene);
+    if (!extracted) {
+        return scene_data;
+    }
+    
+    // Return ok tuple with scene data
+    return enif_make_tuple2(env,
+        atom_ok,
+        scene_data);
+}
+
+// Load FBX from binary data
+static ERL_NIF_TERM load_fbx_binary_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    ErlNifBinary data_bin;
+    ufbx_error error;
+    ufbx_scene *scene;
+    
+    // Get binary data from Elixir
+    if (!enif_inspect_binary(env, argv[0], &data_bin)) {
+        return enif_make_badarg(env);
+    }
+    
+    extract_opts extract = { 0 };
+    parse_extract_opts(env, argv[1], &extract);
+    
+    // Load FBX from memory using ufbx
+    ufbx_load_opts opts = { 0 };
+    parse_load_opts(env, argv[1], &opts);
+    scene = ufbx_load_memory(data_bin.data, data_bin.size, &opts, &error);
+    
+    if (!scene) {
+        // Return error tuple
+        return enif_make_tuple2(env,
+            atom_error,
+            enif_make_string(env, error.description.data, ERL_NIF_LATIN1));
+    }
+    
+    // Extract scene data
+    ERL_NIF_TERM scene_data;
+    int extracted = extract_scene_data(env, scene, &extract, &scene_data);
+    
+    // Free scene
+    ufbx_free_scene(scene);
+    if (!extracted) {
+        return scene_data;
+    }
+    
+    // Return ok tuple with scene data
+    return enif_make_tuple2(env,
+        atom_ok,
+        scene_data);
+}
+
+// ============================================================================
+// Scene Resource
+// ============================================================================
+
+// A loaded ufbx_scene kept alive between NIF calls. Each resource holds one
+// reference to the scene (see `ufbx_retain_scene()`), released by the destructor.
+typedef struct scene_resource {
+    ufbx_scene *scene;
+} scene_resource;
+
+static ErlNifResourceType *scene_resource_type = NULL;
+
+static void scene_resource_dtor(ErlNifEnv* env, void* obj) {
+    (void)env;  // Unused parameter
+    scene_resource *res = (scene_resource*)obj;
+    if (res->scene) {
+        ufbx_free_scene(res->scene);
+    }
+}
+
+// Helper: Wrap a scene in a new resource term (the resource retains its own reference)
+static ERL_NIF_TERM make_scene_resource(ErlNifEnv* env, ufbx_scene *scene) {
+    scene_resource *res = (scene_resource*)enif_alloc_resource(scene_resource_type, sizeof(scene_resource));
+    ufbx_retain_scene(scene);
+    res->scene = scene;
+    ERL_NIF_TERM term = enif_make_resource(env, res);
+    enif_release_resource(res);
+    return term;
+}
+
+// Helper: Get scene resource from term
+static int get_scene_resource(ErlNifEnv* env, ERL_NIF_TERM term, scene_resource **out) {
+    return enif_get_resource(env, term, scene_resource_type, (void**)out);
+}
+
+// Helper: Make {:error, :not_found} for out of range element indices
+static ERL_NIF_TERM make_not_found(ErlNifEnv* env) {
+    return enif_make_tuple2(env,
+        atom_error,
+        atom_not_found);
+}
+
+// Open FBX file as a scene resource
+static ERL_NIF_TERM open_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    ErlNifBinary file_path_bin;
+    ufbx_error error;
+    
+    if (!enif_inspect_binary(env, argv[0], &file_path_bin)) {
+        return enif_make_badarg(env);
+    }
+    
+    ufbx_load_opts opts = { 0 };
+    parse_load_opts(env, argv[1], &opts);
+    
+    ufbx_scene *scene = ufbx_load_file_len((const char*)file_path_bin.data, file_path_bin.size, &opts, &error);
+    if (!scene) {
+        return enif_make_tuple2(env,
+            atom_error,
+            enif_make_string(env, error.description.data, ERL_NIF_LATIN1));
+    }
+    
+    ERL_NIF_TERM resource = make_scene_resource(env, scene);
+    
+    // The resource holds its own reference now
+    ufbx_free_scene(scene);
+    
+    return enif_make_tuple2(env,
+        atom_ok,
+        resource);
+}
+
+// Scene summary: version and element counts
+static ERL_NIF_TERM scene_info_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    scene_resource *res;
+    if (!get_scene_resource(env, argv[0], &res)) {
+        return enif_make_badarg(env);
+    }
+    
+    ufbx_scene *scene = res->scene;
+    ERL_NIF_TERM keys[6];
+    ERL_NIF_TERM values[6];
+    keys[0] = atom_version;
+    values[0] = make_version(env, scene);
+    keys[1] = atom_node_count;
+    values[1] = enif_make_uint64(env, scene->nodes.count);
+    keys[2] = atom_mesh_count;
+    values[2] = enif_make_uint64(env, scene->meshes.count);
+    keys[3] = atom_material_count;
+    values[3] = enif_make_uint64(env, scene->materials.count);
+    keys[4] = atom_texture_count;
+    values[4] = enif_make_uint64(env, scene->textures.count);
+    keys[5] = atom_anim_stack_count;
+    values[5] = enif_make_uint64(env, scene->anim_stacks.count);
+    
+    ERL_NIF_TERM info = make_map(env, keys, values, 6);
+    
+    return enif_make_tuple2(env,
+        atom_ok,
+        info);
+}
+
+// Helper: Get scene resource and element index arguments
+static int get_element_args(ErlNifEnv* env, const ERL_NIF_TERM argv[], ufbx_scene **scene, unsigned int *index) {
+    scene_resource *res;
+    if (!get_scene_resource(env, argv[0], &res) || !enif_get_uint(env, argv[1], index)) {
+        return 0;
+    }
+    *scene = res->scene;
+    return 1;
+}
+
+// Extract a single node by typed_id
+static ERL_NIF_TERM node_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    ufbx_scene *scene;
+    unsigned int index;
+    if (!get_element_args(env, argv, &scene, &index)) {
+        return enif_make_badarg(env);
+    }
+    if (index >= scene->nodes.count) {
+        return make_not_found(env);
+    }
+    
+    ufbx_node *node = scene->nodes.data[index];
+    return enif_make_tuple2(env,
+        atom_ok,
+        extract_node(env, node, node->typed_id));
+}
+
+// Extract a single mesh by typed_id
+static ERL_NIF_TERM mesh_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    scene_resource *res;
+    unsigned int index;
+    if (!get_scene_resource(env, argv[0], &res) || !enif_get_uint(env, argv[1], &index)) {
+        return enif_make_badarg(env);
+    }
+    ufbx_scene *scene = res->scene;
+    if (index >= scene->meshes.count) {
+        return make_not_found(env);
+    }
+    
+    // Packed attributes may alias the scene, which then lives as long as they do
+    extract_opts extract = { 0 };
+    parse_extract_opts(env, argv[2], &extract);
+    extract.owner = res;
+    
+    // Subdivided meshes are freed right away, so nothing may alias them
+    ufbx_mesh *subdivided;
+    if (!subdivide_for_extract(scene->meshes.data[index], &extract, &subdivided)) {
+        return make_error(env, "failed to subdivide mesh");
+    }
+    ERL_NIF_TERM mesh;
+    if (subdivided) {
+        extract.owner = NULL;
+        mesh = extract_mesh(env, subdivided, &extract);
+        ufbx_free_mesh(subdivided);
+    } else {
+        mesh = extract_mesh(env, scene->meshes.data[index], &extract);
+    }
+    if (enif_is_identical(mesh, atom_error)) {
+        return make_error(env, "out of memory");
+    }
+    
+    return enif_make_tuple2(env,
+        atom_ok,
+        mesh);
+}
+
+// Extract a single material by typed_id
+static ERL_NIF_TERM material_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    ufbx_scene *scene;
+    unsigned int index;
+    if (!get_element_args(env, argv, &scene, &index)) {
+        return enif_make_badarg(env);
+    }
+    if (index >= scene->materials.count) {
+        return make_not_found(env);
+    }
+    
+    return enif_make_tuple2(env,
+        atom_ok,
+        extract_material(env, scene->materials.data[index]));
+}
+
+// Extract a single texture by typed_id
+static ERL_NIF_TERM texture_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    ufbx_scene *scene;
+    unsigned int index;
+    if (!get_element_args(env, argv, &scene, &index)) {
+        return enif_make_badarg(env);
+    }
+    if (index >= scene->textures.count) {
+        return make_not_found(env);
+    }
+    
+    return enif_make_tuple2(env,
+        atom_ok,
+        extract_texture(env, scene->textures.data[index]));
+}
+
+// Bake and extract a single animation stack by typed_id
+static ERL_NIF_TERM anim_stack_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    ufbx_scene *scene;
+    unsigned int index;
+    if (!get_element_args(env, argv, &scene, &index)) {
+        return enif_make_badarg(env);
+    }
+    if (index >= scene->anim_stacks.count) {
+        return make_not_found(env);
+    }
+    
+    extract_opts extract = { 0 };
+    parse_extract_opts(env, argv[2], &extract);
+    
+    ERL_NIF_TERM animation;
+    if (!extract_anim_stack(env, scene, scene->anim_stacks.data[index], &extract, &animation)) {
+        return enif_make_tuple2(env,
+            atom_error,
+            enif_make_string(env, "Failed to bake animation", ERL_NIF_LATIN1));
+    }
+    if (enif_is_identical(animation, atom_error)) {
+        return make_error(env, "out of memory");
     }
     
-    // Build map manually for compatibility
-    ERL_NIF_TERM map = enif_make_new_map(env);
-    for (size_t i = 0; i < idx; i++) {
-        enif_make_map_put(env, map, keys[i], values[i], &map);
+    return enif_make_tuple2(env,
+        atom_ok,
+        animation);
+}
+
+// Helper: Grow `min`/`max` by `count` points. The running bounds stay in
+// locals, so the compares build to branch-free min/max instructions at -O2.
+static void expand_bounds(const ufbx_vec3 *points, size_t count, ufbx_real *min, ufbx_real *max) {
+    ufbx_real lo0 = min[0], lo1 = min[1], lo2 = min[2];
+    ufbx_real hi0 = max[0], hi1 = max[1], hi2 = max[2];
+    for (size_t i = 0; i < count; i++) {
+        ufbx_real x = points[i].x, y = points[i].y, z = points[i].z;
+        lo0 = x < lo0 ? x : lo0; hi0 = x > hi0 ? x : hi0;
+        lo1 = y < lo1 ? y : lo1; hi1 = y > hi1 ? y : hi1;
+        lo2 = z < lo2 ? z : lo2; hi2 = z > hi2 ? z : hi2;
     }
-    return map;
+    min[0] = lo0; min[1] = lo1; min[2] = lo2;
+    max[0] = hi0; max[1] = hi1; max[2] = hi2;
 }
 
-// Extract keyframe from ufbx_baked_vec3 to Elixir map (translation/scale)
-static ERL_NIF_TERM extract_vec3_keyframe(ErlNifEnv* env, ufbx_baked_vec3 *key, const char* field_name) {
-    ERL_NIF_TERM keys[2];
-    ERL_NIF_TERM values[2];
+// Helper: Grow `min`/`max` by `points` transformed by the affine `m`
+static void expand_transformed_bounds(const ufbx_matrix *m, const ufbx_vec3 *points, size_t count,
+                                      ufbx_real *min, ufbx_real *max) {
+    ufbx_real lo0 = min[0], lo1 = min[1], lo2 = min[2];
+    ufbx_real hi0 = max[0], hi1 = max[1], hi2 = max[2];
+    for (size_t i = 0; i < count; i++) {
+        ufbx_real px = points[i].x, py = points[i].y, pz = points[i].z;
+        ufbx_real x = m->m00 * px + m->m01 * py + m->m02 * pz + m->m03;
+        ufbx_real y = m->m10 * px + m->m11 * py + m->m12 * pz + m->m13;
+        ufbx_real z = m->m20 * px + m->m21 * py + m->m22 * pz + m->m23;
+        lo0 = x < lo0 ? x : lo0; hi0 = x > hi0 ? x : hi0;
+        lo1 = y < lo1 ? y : lo1; hi1 = y > hi1 ? y : hi1;
+        lo2 = z < lo2 ? z : lo2; hi2 = z > hi2 ? z : hi2;
+    }
+    min[0] = lo0; min[1] = lo1; min[2] = lo2;
+    max[0] = hi0; max[1] = hi1; max[2] = hi2;
+}
+
+// Helper: Union box `src` into `dst`, both as [min xyz, max xyz]
+static void union_bounds(ufbx_real *dst, const ufbx_real *src) {
+    for (int c = 0; c < 3; c++) {
+        if (src[c] < dst[c]) dst[c] = src[c];
+        if (src[3 + c] > dst[3 + c]) dst[3 + c] = src[3 + c];
+    }
+}
+
+static void clear_bounds(ufbx_real *box) {
+    box[0] = box[1] = box[2] = (ufbx_real)HUGE_VAL;
+    box[3] = box[4] = box[5] = -(ufbx_real)HUGE_VAL;
+}
+
+// Helper: Pack boxes as [min xyz, max xyz] in the requested precision.
+// Empty boxes become a point at `origins[i]`, or zeros without origins.
+static ERL_NIF_TERM make_packed_bounds(ErlNifEnv* env, ufbx_real *boxes, size_t count, const ufbx_real *origins,
+                                       const extract_opts *opts, ERL_NIF_TERM *layout) {
+    for (size_t i = 0; i < count; i++) {
+        ufbx_real *box = boxes + i * 6;
+        if (box[0] > box[3]) {
+            for (int c = 0; c < 3; c++) {
+                box[c] = box[3 + c] = origins ? origins[i * 3 + c] : 0.0;
+            }
+        }
+    }
+    return make_packed_reals(env, boxes, count, 6, opts, layout);
+}
+
+// Local bounds of every mesh, world bounds of the meshes on every node, and
+// world bounds of every node's subtree (including itself) and the scene
+static ERL_NIF_TERM bounds_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    scene_resource *res;
+    if (!get_scene_resource(env, argv[0], &res)) {
+        return enif_make_badarg(env);
+    }
+    const ufbx_scene *scene = res->scene;
+    extract_opts extract = { 0 };
+    parse_extract_opts(env, argv[1], &extract);
     
-    keys[0] = enif_make_atom(env, "time");
-    values[0] = enif_make_double(env, key->time);
+    size_t num_meshes = scene->meshes.count, num_nodes = scene->nodes.count;
+    ufbx_real *mesh_boxes = (ufbx_real*)enif_alloc((num_meshes + 1) * 6 * sizeof(ufbx_real));
+    ufbx_real *node_boxes = (ufbx_real*)enif_alloc((num_nodes + 1) * 6 * sizeof(ufbx_real));
+    ufbx_real *tree_boxes = (ufbx_real*)enif_alloc((num_nodes + 1) * 6 * sizeof(ufbx_real));
+    ufbx_real *origins = (ufbx_real*)enif_alloc((num_nodes + 1) * 3 * sizeof(ufbx_real));
+    uint32_t *order = (uint32_t*)enif_alloc((num_nodes + 1) * sizeof(uint32_t));
+    if (!mesh_boxes || !node_boxes || !tree_boxes || !origins || !order) {
+        if (mesh_boxes) enif_free(mesh_boxes);
+        if (node_boxes) enif_free(node_boxes);
+        if (tree_boxes) enif_free(tree_boxes);
+        if (origins) enif_free(origins);
+        if (order) enif_free(order);
+        return make_error(env, "out of memory");
+    }
     
-    keys[1] = enif_make_atom(env, field_name);
-    values[1] = make_vec3(env, key->value);
+    for (size_t i = 0; i < num_meshes; i++) {
+        const ufbx_mesh *mesh = scene->meshes.data[i];
+        ufbx_real *box = mesh_boxes + i * 6;
+        clear_bounds(box);
+        expand_bounds(mesh->vertex_position.values.data, mesh->vertex_position.values.count, box, box + 3);
+    }
     
-    ERL_NIF_TERM map = enif_make_new_map(env);
-    enif_make_map_put(env, map, keys[0], values[0], &map);
-    enif_make_map_put(env, map, keys[1], values[1], &map);
+    uint32_t max_depth = 0;
+    for (size_t i = 0; i < num_nodes; i++) {
+        const ufbx_node *node = scene->nodes.data[i];
+        ufbx_real *box = node_boxes + i * 6;
+        clear_bounds(box);
+        if (node->mesh) {
+            const ufbx_vertex_vec3 *positions = &node->mesh->vertex_position;
+            expand_transformed_bounds(&node->geometry_to_world, positions->values.data, positions->values.count,
+                                      box, box + 3);
+        }
+        memcpy(tree_boxes + i * 6, box, 6 * sizeof(ufbx_real));
+        origins[i * 3 + 0] = node->node_to_world.m03;
+        origins[i * 3 + 1] = node->node_to_world.m13;
+        origins[i * 3 + 2] = node->node_to_world.m23;
+        if (node->node_depth > max_depth) max_depth = node->node_depth;
+    }
     
-    return map;
-}
-
-// Extract keyframe from ufbx_baked_quat to Elixir map (rotation)
-static ERL_NIF_TERM extract_quat_keyframe(ErlNifEnv* env, ufbx_baked_quat *key) {
-    ERL_NIF_TERM keys[2];
-    ERL_NIF_TERM values[2];
+    // Propagate subtrees to parents, deepest nodes first: counting sort by
+    // depth, with `depth_start` as the offset of each depth in `order`
+    size_t *depth_start = (size_t*)enif_alloc(((size_t)max_depth + 2) * sizeof(size_t));
+    if (!depth_start) {
+        enif_free(mesh_boxes);
+        enif_free(node_boxes);
+        enif_free(tree_boxes);
+        enif_free(origins);
+        enif_free(order);
+        return make_error(env, "out of memory");
+    }
+    memset(depth_start, 0, ((size_t)max_depth + 2) * sizeof(size_t));
+    for (size_t i = 0; i < num_nodes; i++) {
+        depth_start[scene->nodes.data[i]->node_depth + 1]++;
+    }
+    for (uint32_t depth = 0; depth <= max_depth; depth++) {
+        depth_start[depth + 1] += depth_start[depth];
+    }
+    for (size_t i = 0; i < num_nodes; i++) {
+        order[depth_start[scene->nodes.data[i]->node_depth]++] = (uint32_t)i;
+    }
+    enif_free(depth_start);
+    for (size_t i = num_nodes; i > 0; i--) {
+        const ufbx_node *node = scene->nodes.data[order[i - 1]];
+        if (node->parent) {
+            union_bounds(tree_boxes + node->parent->typed_id * 6, tree_boxes + order[i - 1] * 6);
+        }
+    }
     
-    keys[0] = enif_make_atom(env, "time");
-    values[0] = enif_make_double(env, key->time);
+    ufbx_real scene_box[6];
+    clear_bounds(scene_box);
+    for (size_t i = 0; i < num_nodes; i++) {
+        union_bounds(scene_box, node_boxes + i * 6);
+    }
     
-    // Convert ufbx_quat to vec4 format [x, y, z, w]
-    keys[1] = enif_make_atom(env, "rotation");
-    ERL_NIF_TERM x = enif_make_double(env, key->value.x);
-    ERL_NIF_TERM y = enif_make_double(env, key->value.y);
-    ERL_NIF_TERM z = enif_make_double(env, key->value.z);
-    ERL_NIF_TERM w = enif_make_double(env, key->value.w);
-    values[1] = enif_make_list4(env, x, y, z, w);
+    ERL_NIF_TERM layout_keys[4] = { atom_meshes, atom_nodes, atom_subtrees, atom_scene };
+    ERL_NIF_TERM layout_values[4];
+    ERL_NIF_TERM keys[5] = { atom_meshes, atom_nodes, atom_subtrees, atom_scene, atom_layout };
+    ERL_NIF_TERM values[5];
+    values[0] = make_packed_bounds(env, mesh_boxes, num_meshes, NULL, &extract, &layout_values[0]);
+    values[1] = make_packed_bounds(env, node_boxes, num_nodes, origins, &extract, &layout_values[1]);
+    values[2] = make_packed_bounds(env, tree_boxes, num_nodes, origins, &extract, &layout_values[2]);
+    values[3] = make_packed_bounds(env, scene_box, 1, NULL, &extract, &layout_values[3]);
+    values[4] = make_map(env, layout_keys, layout_values, 4);
     
-    ERL_NIF_TERM map = enif_make_new_map(env);
-    enif_make_map_put(env, map, keys[0], values[0], &map);
-    enif_make_map_put(env, map, keys[1], values[1], &map);
+    enif_free(mesh_boxes);
+    enif_free(node_boxes);
+    enif_free(tree_boxes);
+    enif_free(origins);
+    enif_free(order);
     
-    return map;
+    return enif_make_tuple2(env,
+        atom_ok,
+        make_map(env, keys, values, 5));
 }
 
-// Extract animation data from ufbx_baked_anim to Elixir map
-static ERL_NIF_TERM extract_animation(ErlNifEnv* env, ufbx_baked_anim *baked, ufbx_anim_stack *anim_stack) {
-    ERL_NIF_TERM keys[4];
-    ERL_NIF_TERM values[4];
-    size_t idx = 0;
+// ============================================================================
+// CPU Skinning
+// ============================================================================
+
+// 4-wide float vector for the skinning kernel
+#ifdef HAVE_SSE
+typedef __m128 vec4f;
+static inline vec4f vec4f_load(const float *p) { return _mm_loadu_ps(p); }
+static inline void vec4f_store(float *p, vec4f v) { _mm_storeu_ps(p, v); }
+static inline vec4f vec4f_splat(float x) { return _mm_set1_ps(x); }
+static inline vec4f vec4f_add(vec4f a, vec4f b) { return _mm_add_ps(a, b); }
+static inline vec4f vec4f_mul(vec4f a, vec4f b) { return _mm_mul_ps(a, b); }
+#else
+typedef struct vec4f { float v[4]; } vec4f;
+static inline vec4f vec4f_load(const float *p) { vec4f r; memcpy(r.v, p, sizeof(r.v)); return r; }
+static inline void vec4f_store(float *p, vec4f v) { memcpy(p, v.v, sizeof(v.v)); }
+static inline vec4f vec4f_splat(float x) { vec4f r = { { x, x, x, x } }; return r; }
+static inline vec4f vec4f_add(vec4f a, vec4f b) {
+    vec4f r = { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } };
+    return r;
+}
+static inline vec4f vec4f_mul(vec4f a, vec4f b) {
+    vec4f r = { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } };
+    return r;
+}
+#endif
+
+// Skinning inputs shared by every frame. Points (w = 1) and directions
+// (w = 0) are stored as xyzw floats, each moved by the influences of a
+// source vertex. The outputs are frame-major packed binaries.
+typedef struct skin_batch {
+    const ufbx_scene *scene;
+    const ufbx_anim *anim;
+    const ufbx_mesh *mesh;
+    const double *times;
+    size_t num_joints;
+    size_t num_vertices;        // Source vertices
+    uint32_t *influence_begin;  // `num_vertices + 1` offsets into `joints` / `weights`
+    uint32_t *joints;
+    float *weights;             // Normalized per vertex
+    size_t num_points;
+    float *points;
+    const uint32_t *point_vertex;  // Source vertex per point, or NULL for the identity
+    size_t num_dirs;
+    float *dirs;                   // NULL if the mesh has no normals
+    const uint32_t *dir_vertex;
+    unsigned char *positions_out;
+    unsigned char *normals_out;
+    float *positions_xyzw;  // If set, frames go here as unnormalized xyzw floats
+    float *normals_xyzw;    // instead of the packed outputs
+    bool apply_blend;       // Morph by the evaluated blend shapes before skinning
+    const extract_opts *opts;
+    unsigned char *failed;  // Per frame
+} skin_batch;
+
+// Helper: Store a ufbx matrix as 4 xyzw float columns
+static void store_matrix_columns(const ufbx_matrix *m, float *dst) {
+    for (int c = 0; c < 4; c++) {
+        dst[c * 4 + 0] = (float)m->cols[c].x;
+        dst[c * 4 + 1] = (float)m->cols[c].y;
+        dst[c * 4 + 2] = (float)m->cols[c].z;
+        dst[c * 4 + 3] = c == 3 ? 1.0f : 0.0f;
+    }
+}
+
+// Linear blend skinning: blend the joint matrices of every source vertex by
+// its weights. Vertices without influences follow the mesh's node, stored
+// after the joints.
+static void blend_skin_matrices(const skin_batch *b, const float *joint_matrices, float *blended) {
+    for (size_t v = 0; v < b->num_vertices; v++) {
+        uint32_t begin = b->influence_begin[v], end = b->influence_begin[v + 1];
+        float *dst = blended + v * 16;
+        if (begin == end) {
+            memcpy(dst, joint_matrices + b->num_joints * 16, 16 * sizeof(float));
+            continue;
+        }
+        
+        vec4f c0 = vec4f_splat(0.0f), c1 = c0, c2 = c0, c3 = c0;
+        for (uint32_t i = begin; i < end; i++) {
+            const float *m = joint_matrices + b->joints[i] * 16;
+            vec4f w = vec4f_splat(b->weights[i]);
+            c0 = vec4f_add(c0, vec4f_mul(w, vec4f_load(m)));
+            c1 = vec4f_add(c1, vec4f_mul(w, vec4f_load(m + 4)));
+            c2 = vec4f_add(c2, vec4f_mul(w, vec4f_load(m + 8)));
+            c3 = vec4f_add(c3, vec4f_mul(w, vec4f_load(m + 12)));
+        }
+        vec4f_store(dst, c0);
+        vec4f_store(dst + 4, c1);
+        vec4f_store(dst + 8, c2);
+        vec4f_store(dst + 12, c3);
+    }
+}
+
+// Transform `count` xyzw elements by the blended matrix of their vertex
+static void transform_skinned(const float *blended, const float *src, const uint32_t *vertex, size_t count,
+                              float *dst) {
+    for (size_t i = 0; i < count; i++) {
+        const float *m = blended + (vertex ? vertex[i] : (uint32_t)i) * 16;
+        const float *p = src + i * 4;
+        vec4f r = vec4f_add(
+            vec4f_add(vec4f_mul(vec4f_load(m), vec4f_splat(p[0])), vec4f_mul(vec4f_load(m + 4), vec4f_splat(p[1]))),
+            vec4f_add(vec4f_mul(vec4f_load(m + 8), vec4f_splat(p[2])), vec4f_mul(vec4f_load(m + 12), vec4f_splat(p[3]))));
+        vec4f_store(dst + i * 4, r);
+    }
+}
+
+// Helper: Pack `count` xyzw results as xyz in the requested precision,
+// optionally renormalized
+static void store_skinned(unsigned char *dst, const float *src, size_t count, bool normalize,
+                          const extract_opts *opts) {
+    for (size_t i = 0; i < count; i++) {
+        ufbx_real v[3] = { src[i * 4 + 0], src[i * 4 + 1], src[i * 4 + 2] };
+        if (normalize) {
+            ufbx_real len = (ufbx_real)sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+            if (len > 0.0f) {
+                v[0] /= len;
+                v[1] /= len;
+                v[2] /= len;
+            }
+        }
+        store_packed_reals(dst, i, v, 3, opts);
+    }
+}
+
+// Helper: Accumulate `weight` times the offsets of `shape` into `positions`
+// (and its normal offsets into `normals` if both exist), xyzw floats per
+// vertex. Like `ufbx_add_blend_shape_vertex_offsets()` in single precision.
+static void add_blend_shape_offsets(const ufbx_mesh *mesh, const ufbx_blend_shape *shape, float weight,
+                                    float *positions, float *normals) {
+    int has_normals = normals && shape->normal_offsets.count >= shape->num_offsets;
+    for (size_t i = 0; i < shape->num_offsets; i++) {
+        uint32_t v = shape->offset_vertices.data[i];
+        if (v >= mesh->num_vertices) continue;
+        float w = i < shape->offset_weights.count ? weight * (float)shape->offset_weights.data[i] : weight;
+        vec4f vw = vec4f_splat(w);
+        
+        ufbx_vec3 p = shape->position_offsets.data[i];
+        float offset[4] = { (float)p.x, (float)p.y, (float)p.z, 0.0f };
+        float *dst = positions + v * 4;
+        vec4f_store(dst, vec4f_add(vec4f_load(dst), vec4f_mul(vw, vec4f_load(offset))));
+        
+        if (has_normals) {
+            ufbx_vec3 n = shape->normal_offsets.data[i];
+            float normal_offset[4] = { (float)n.x, (float)n.y, (float)n.z, 0.0f };
+            dst = normals + v * 4;
+            vec4f_store(dst, vec4f_add(vec4f_load(dst), vec4f_mul(vw, vec4f_load(normal_offset))));
+        }
+    }
+}
+
+// Helper: Offset `count` xyzw elements by the delta of their vertex
+static void add_vertex_deltas(const float *src, const float *deltas, const uint32_t *vertex, size_t count,
+                              float *dst) {
+    for (size_t i = 0; i < count; i++) {
+        const float *d = deltas + (vertex ? vertex[i] : (uint32_t)i) * 4;
+        vec4f_store(dst + i * 4, vec4f_add(vec4f_load(src + i * 4), vec4f_load(d)));
+    }
+}
+
+// Helper: Sum the blend shape offsets of the posed `mesh` into `deltas`: a
+// position then a normal offset per source vertex, as xyzw floats
+static void accumulate_blend_deltas(const ufbx_mesh *mesh, const ufbx_mesh *posed, float *deltas) {
+    memset(deltas, 0, mesh->num_vertices * 8 * sizeof(float));
+    for (size_t d = 0; d < posed->blend_deformers.count; d++) {
+        const ufbx_blend_deformer *deformer = posed->blend_deformers.data[d];
+        for (size_t c = 0; c < deformer->channels.count; c++) {
+            const ufbx_blend_channel *channel = deformer->channels.data[c];
+            for (size_t k = 0; k < channel->keyframes.count; k++) {
+                const ufbx_blend_keyframe *key = &channel->keyframes.data[k];
+                if (key->effective_weight == 0.0f || !key->shape) continue;
+                add_blend_shape_offsets(mesh, key->shape, (float)key->effective_weight,
+                                        deltas, deltas + mesh->num_vertices * 4);
+            }
+        }
+    }
+}
+
+// Evaluate one frame: pose the scene, then morph and skin every point and direction
+static void run_skin_frame(void *user, uint32_t frame) {
+    skin_batch *b = (skin_batch*)user;
+    const ufbx_skin_deformer *skin = mesh_skin(b->mesh);
+    size_t scratch_count = b->num_points > b->num_dirs ? b->num_points : b->num_dirs;
     
-    // id (use anim_stack typed_id)
-    keys[idx] = enif_make_atom(env, "id");
-    values[idx] = enif_make_uint(env, anim_stack->typed_id);
-    idx++;
+    ufbx_evaluate_opts evaluate_opts = { 0 };
+    ufbx_error error;
+    ufbx_scene *state = ufbx_evaluate_scene(b->scene, b->anim, b->times[frame], &evaluate_opts, &error);
+    float *joint_matrices = (float*)enif_alloc((b->num_joints + 1) * 16 * sizeof(float));
+    float *blended = (float*)enif_alloc((b->num_vertices + 1) * 16 * sizeof(float));
+    float *scratch = (float*)enif_alloc((scratch_count + 1) * 4 * sizeof(float));
+    int blend = b->apply_blend && mesh_has_blend(b->mesh);
+    float *deltas = blend ? (float*)enif_alloc((b->num_vertices + 1) * 8 * sizeof(float)) : NULL;
+    if (!state || !joint_matrices || !blended || !scratch || (blend && !deltas)) {
+        if (state) ufbx_free_scene(state);
+        if (joint_matrices) enif_free(joint_matrices);
+        if (blended) enif_free(blended);
+        if (scratch) enif_free(scratch);
+        if (deltas) enif_free(deltas);
+        b->failed[frame] = 1;
+        return;
+    }
+    if (deltas) {
+        accumulate_blend_deltas(b->mesh, state->meshes.data[b->mesh->typed_id], deltas);
+    }
     
-    // name
-    keys[idx] = enif_make_atom(env, "name");
-    values[idx] = make_string(env, anim_stack->name);
-    idx++;
+    for (size_t j = 0; j < b->num_joints; j++) {
+        const ufbx_skin_cluster *cluster = state->skin_clusters.data[skin->clusters.data[j]->typed_id];
+        store_matrix_columns(&cluster->geometry_to_world, joint_matrices + j * 16);
+    }
+    const ufbx_matrix *rest = &ufbx_identity_matrix;
+    if (b->mesh->instances.count > 0) {
+        rest = &state->nodes.data[b->mesh->instances.data[0]->typed_id]->geometry_to_world;
+    }
+    store_matrix_columns(rest, joint_matrices + b->num_joints * 16);
+    ufbx_free_scene(state);
     
-    // Extract keyframes per node
-    ERL_NIF_TERM all_keyframes = enif_make_list(env, 0);
+    blend_skin_matrices(b, joint_matrices, blended);
     
-    for (size_t i = baked->nodes.count; i > 0; i--) {
-        ufbx_baked_node *baked_node = &baked->nodes.data[i - 1];
-        uint32_t node_id = baked_node->typed_id;
+    // Skin in place after morphing into `scratch`, or straight into the xyzw output
+    size_t elem_size = b->opts->use_f32 ? sizeof(float) : sizeof(double);
+    const float *points = b->points;
+    if (deltas) {
+        add_vertex_deltas(b->points, deltas, b->point_vertex, b->num_points, scratch);
+        points = scratch;
+    }
+    float *dst = b->positions_xyzw ? b->positions_xyzw + frame * b->num_points * 4 : scratch;
+    transform_skinned(blended, points, b->point_vertex, b->num_points, dst);
+    if (!b->positions_xyzw) {
+        store_skinned(b->positions_out + frame * b->num_points * 3 * elem_size, dst, b->num_points, false, b->opts);
+    }
+    if (b->dirs) {
+        const float *dirs = b->dirs;
+        if (deltas) {
+            add_vertex_deltas(b->dirs, deltas + b->num_vertices * 4, b->dir_vertex, b->num_dirs, scratch);
+            dirs = scratch;
+        }
+        dst = b->normals_xyzw ? b->normals_xyzw + frame * b->num_dirs * 4 : scratch;
+        transform_skinned(blended, dirs, b->dir_vertex, b->num_dirs, dst);
+        if (!b->normals_xyzw) {
+            store_skinned(b->normals_out + frame * b->num_dirs * 3 * elem_size, dst, b->num_dirs, true, b->opts);
+        }
+    }
+    
+    enif_free(joint_matrices);
+    enif_free(blended);
+    enif_free(scratch);
+    if (deltas) enif_free(deltas);
+}
+
+// Helper: Gather every influence of the mesh's source vertices, normalized
+static int gather_skin_influences(skin_batch *b) {
+    const ufbx_skin_deformer *skin = mesh_skin(b->mesh);
+    size_t total = 0;
+    for (size_t v = 0; skin && v < b->num_vertices && v < skin->vertices.count; v++) {
+        total += skin->vertices.data[v].num_weights;
+    }
+    
+    b->influence_begin = (uint32_t*)enif_alloc((b->num_vertices + 1) * sizeof(uint32_t));
+    b->joints = (uint32_t*)enif_alloc((total + 1) * sizeof(uint32_t));
+    b->weights = (float*)enif_alloc((total + 1) * sizeof(float));
+    if (!b->influence_begin || !b->joints || !b->weights) {
+        return 0;
+    }
+    
+    uint32_t count = 0;
+    for (size_t v = 0; v < b->num_vertices; v++) {
+        b->influence_begin[v] = count;
+        if (!skin || v >= skin->vertices.count) continue;
         
-        // Extract translation keyframes
-        for (size_t j = baked_node->translation_keys.count; j > 0; j--) {
-            ufbx_baked_vec3 *trans_key = &baked_node->translation_keys.data[j - 1];
-            ERL_NIF_TERM keyframe = extract_vec3_keyframe(env, trans_key, "translation");
-            
-            // Add node_id to keyframe
-            ERL_NIF_TERM keyframe_map = enif_make_new_map(env);
-            ERL_NIF_TERM node_id_key = enif_make_atom(env, "node_id");
-            ERL_NIF_TERM node_id_val = enif_make_uint(env, node_id);
-            enif_make_map_put(env, keyframe_map, node_id_key, node_id_val, &keyframe_map);
-            
-            // Copy keyframe fields into map
-            ERL_NIF_TERM value;
-            if (enif_get_map_value(env, keyframe, enif_make_atom(env, "time"), &value)) {
-                enif_make_map_put(env, keyframe_map, enif_make_atom(env, "time"), value, &keyframe_map);
+        ufbx_skin_vertex sv = skin->vertices.data[v];
+        ufbx_real sum = 0.0f;
+        for (uint32_t i = 0; i < sv.num_weights; i++) {
+            sum += skin->weights.data[sv.weight_begin + i].weight;
+        }
+        if (!(sum > 0.0f)) continue;
+        for (uint32_t i = 0; i < sv.num_weights; i++) {
+            ufbx_skin_weight w = skin->weights.data[sv.weight_begin + i];
+            b->joints[count] = w.cluster_index;
+            b->weights[count] = (float)(w.weight / sum);
+            count++;
+        }
+    }
+    b->influence_begin[b->num_vertices] = count;
+    return 1;
+}
+
+// Helper: Copy `count` vec3s (or `stride`-spaced reals) to xyzw floats
+static float *make_skin_elements(const ufbx_real *src, size_t stride, size_t count, float w) {
+    float *dst = (float*)enif_alloc((count + 1) * 4 * sizeof(float));
+    if (!dst) {
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        dst[i * 4 + 0] = (float)src[i * stride + 0];
+        dst[i * 4 + 1] = (float)src[i * stride + 1];
+        dst[i * 4 + 2] = (float)src[i * stride + 2];
+        dst[i * 4 + 3] = w;
+    }
+    return dst;
+}
+
+// Helper: Parse sample times: a list of seconds, or a `Range` of frame
+// numbers at `frame_rate`, into an `enif_alloc`ed array in `out`. Returns 0
+// if invalid. `out` is NULL if out of memory, or if `count` is over
+// `MAX_SKIN_FRAMES` (nothing is allocated then).
+static int parse_times(ErlNifEnv* env, ERL_NIF_TERM term, double frame_rate, double **out, size_t *count) {
+    ErlNifSInt64 first, last, step = 1;
+    ERL_NIF_TERM value;
+    *out = NULL;
+    if (enif_is_map(env, term)) {
+        if (!enif_get_map_value(env, term, atom_first, &value) || !enif_get_int64(env, value, &first) ||
+            !enif_get_map_value(env, term, atom_last, &value) || !enif_get_int64(env, value, &last)) {
+            return 0;
+        }
+        if (enif_get_map_value(env, term, atom_step, &value) && (!enif_get_int64(env, value, &step) || step == 0)) {
+            return 0;
+        }
+        // Unsigned so the span of extreme bounds can't overflow
+        int empty = step > 0 ? last < first : last > first;
+        uint64_t span = step > 0 ? (uint64_t)last - (uint64_t)first : (uint64_t)first - (uint64_t)last;
+        uint64_t stride = step > 0 ? (uint64_t)step : 0 - (uint64_t)step;
+        uint64_t steps = empty ? 0 : span / stride;
+        if (steps >= MAX_SKIN_FRAMES) {
+            *count = MAX_SKIN_FRAMES + 1;
+            return 1;
+        }
+        *count = empty ? 0 : (size_t)steps + 1;
+        *out = (double*)enif_alloc((*count + 1) * sizeof(double));
+        for (size_t i = 0; *out && i < *count; i++) {
+            (*out)[i] = ((double)first + (double)i * (double)step) / frame_rate;
+        }
+        return 1;
+    }
+    
+    unsigned int length;
+    if (!enif_get_list_length(env, term, &length)) {
+        return 0;
+    }
+    *count = length;
+    if (*count > MAX_SKIN_FRAMES) {
+        return 1;
+    }
+    double *times = (double*)enif_alloc((*count + 1) * sizeof(double));
+    ERL_NIF_TERM head;
+    size_t i = 0;
+    while (times && enif_get_list_cell(env, term, &head, &term)) {
+        ErlNifSInt64 integer;
+        if (!enif_get_double(env, head, &times[i])) {
+            if (!enif_get_int64(env, head, &integer)) {
+                enif_free(times);
+                return 0;
             }
-            if (enif_get_map_value(env, keyframe, enif_make_atom(env, "translation"), &value)) {
-                enif_make_map_put(env, keyframe_map, enif_make_atom(env, "translation"), value, &keyframe_map);
+            times[i] = (double)integer;
+        }
+        i++;
+    }
+    *out = times;
+    return 1;
+}
+
+static void free_skin_batch(skin_batch *b) {
+    if (b->influence_begin) enif_free(b->influence_begin);
+    if (b->joints) enif_free(b->joints);
+    if (b->weights) enif_free(b->weights);
+    if (b->points) enif_free(b->points);
+    if (b->dirs) enif_free(b->dirs);
+    if (b->failed) enif_free(b->failed);
+}
+
+// Helper: Skin the vertices of the render mesh `mesh/3` would return with
+// `opts`, building it into `rm`. Returns 0 on failure.
+static int prepare_render_skin_batch(skin_batch *b, const extract_opts *opts, render_mesh *rm) {
+    render_cache_stats before, after;
+    if (!build_render_mesh(b->mesh, opts->generate_tangents, rm) ||
+        (opts->optimize && !optimize_render_mesh(rm, opts->vertex_cache_size, &before, &after))) {
+        return 0;
+    }
+    b->num_points = rm->num_vertices;
+    b->points = make_skin_elements(rm->vertices + rm->offsets[RENDER_POSITION], rm->stride, rm->num_vertices, 1.0f);
+    b->point_vertex = rm->vertex_indices;
+    if (!b->points) {
+        return 0;
+    }
+    if (rm->offsets[RENDER_NORMAL] != RENDER_NO_ATTRIBUTE) {
+        b->num_dirs = rm->num_vertices;
+        b->dirs = make_skin_elements(rm->vertices + rm->offsets[RENDER_NORMAL], rm->stride, rm->num_vertices, 0.0f);
+        b->dir_vertex = rm->vertex_indices;
+        return b->dirs != NULL;
+    }
+    return 1;
+}
+
+static ERL_NIF_TERM evaluate_skinning_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    ufbx_scene *scene;
+    unsigned int mesh_index, stack_index;
+    if (!get_element_args(env, argv, &scene, &mesh_index) || !enif_get_uint(env, argv[2], &stack_index)) {
+        return enif_make_badarg(env);
+    }
+    if (mesh_index >= scene->meshes.count || stack_index >= scene->anim_stacks.count) {
+        return make_not_found(env);
+    }
+    
+    extract_opts extract = { 0 };
+    parse_extract_opts(env, argv[4], &extract);
+    
+    double scene_rate = scene->settings.frames_per_second;
+    double frame_rate = scene_rate > 0.0 && isfinite(scene_rate) ? scene_rate : 30.0;
+    size_t num_frames;
+    double *times;
+    if (!parse_times(env, argv[3], frame_rate, &times, &num_frames)) {
+        return enif_make_badarg(env);
+    }
+    if (num_frames > MAX_SKIN_FRAMES) {
+        return make_error(env, "too many frames");
+    }
+    if (!times) {
+        return make_error(env, "out of memory");
+    }
+    
+    const ufbx_mesh *mesh = scene->meshes.data[mesh_index];
+    skin_batch b = { 0 };
+    b.scene = scene;
+    b.anim = scene->anim_stacks.data[stack_index]->anim;
+    b.mesh = mesh;
+    b.times = times;
+    b.num_joints = mesh_skin(mesh) ? mesh_skin(mesh)->clusters.count : 0;
+    b.num_vertices = mesh->num_vertices;
+    b.opts = &extract;
+    
+    // Render meshes skin their own vertices, so the frames line up with `mesh/3`
+    render_mesh rm = { 0 };
+    int ok = gather_skin_influences(&b);
+    if (ok && extract.render) {
+        ok = prepare_render_skin_batch(&b, &extract, &rm);
+    } else if (ok) {
+        // Positions per vertex, normals per face corner
+        b.num_points = mesh->num_vertices;
+        b.points = make_skin_elements(&mesh->vertices.data[0].x, 3, mesh->num_vertices, 1.0f);
+        ok = b.points != NULL;
+        if (ok && mesh->vertex_normal.exists) {
+            b.num_dirs = mesh->num_indices;
+            b.dirs = (float*)enif_alloc((mesh->num_indices + 1) * 4 * sizeof(float));
+            b.dir_vertex = mesh->vertex_indices.data;
+            ok = b.dirs != NULL;
+            for (size_t i = 0; ok && i < mesh->num_indices; i++) {
+                ufbx_vec3 n = ufbx_get_vertex_vec3(&mesh->vertex_normal, i);
+                b.dirs[i * 4 + 0] = (float)n.x;
+                b.dirs[i * 4 + 1] = (float)n.y;
+                b.dirs[i * 4 + 2] = (float)n.z;
+                b.dirs[i * 4 + 3] = 0.0f;
             }
-            
-            all_keyframes = enif_make_list_cell(env, keyframe_map, all_keyframes);
         }
-        
-        // Extract rotation keyframes
-        for (size_t j = baked_node->rotation_keys.count; j > 0; j--) {
-            ufbx_baked_quat *rot_key = &baked_node->rotation_keys.data[j - 1];
-            ERL_NIF_TERM keyframe = extract_quat_keyframe(env, rot_key);
-            
-            // Add node_id to keyframe
-            ERL_NIF_TERM keyframe_map = enif_make_new_map(env);
-            ERL_NIF_TERM node_id_key = enif_make_atom(env, "node_id");
-            ERL_NIF_TERM node_id_val = enif_make_uint(env, node_id);
-            enif_make_map_put(env, keyframe_map, node_id_key, node_id_val, &keyframe_map);
-            
-            // Copy keyframe fields into map
-            ERL_NIF_TERM value;
-            if (enif_get_map_value(env, keyframe, enif_make_atom(env, "time"), &value)) {
-                enif_make_map_put(env, keyframe_map, enif_make_atom(env, "time"), value, &keyframe_map);
+    }
+    b.failed = ok ? (unsigned char*)enif_alloc(num_frames + 1) : NULL;
+    if (!ok || !b.failed) {
+        free_skin_batch(&b);
+        free_render_mesh(&rm);
+        enif_free(times);
+        return make_error(env, "out of memory");
+    }
+    memset(b.failed, 0, num_frames);
+    
+    // The outputs are allocated up front, where a failure can still be
+    // returned instead of aborting like `enif_make_new_binary()`
+    size_t elem_size = extract.use_f32 ? sizeof(float) : sizeof(double);
+    size_t frame_elems = (num_frames > 0 ? num_frames : 1) * 3 * elem_size;
+    ErlNifBinary positions_bin = { 0 }, normals_bin = { 0 };
+    const char *error = NULL;
+    if (b.num_points > SIZE_MAX / frame_elems || b.num_dirs > SIZE_MAX / frame_elems) {
+        error = "too many frames";
+    } else if (!enif_alloc_binary(num_frames * b.num_points * 3 * elem_size, &positions_bin) ||
+               (b.dirs && !enif_alloc_binary(num_frames * b.num_dirs * 3 * elem_size, &normals_bin))) {
+        error = "out of memory";
+    } else {
+        b.positions_out = positions_bin.data;
+        b.normals_out = normals_bin.data;
+        run_parallel(&run_skin_frame, &b, num_frames);
+        for (size_t i = 0; i < num_frames && !error; i++) {
+            if (b.failed[i]) error = "failed to evaluate scene";
+        }
+    }
+    size_t num_outputs = b.dirs ? 3 : 2;
+    free_skin_batch(&b);
+    free_render_mesh(&rm);
+    if (error) {
+        if (positions_bin.data) enif_release_binary(&positions_bin);
+        if (normals_bin.data) enif_release_binary(&normals_bin);
+        enif_free(times);
+        return make_error(env, error);
+    }
+    
+    ERL_NIF_TERM layout_keys[3] = { atom_times, atom_positions, atom_normals };
+    ERL_NIF_TERM layout_values[3];
+    ERL_NIF_TERM keys[4] = { atom_times, atom_positions, atom_layout, atom_normals };
+    ERL_NIF_TERM values[4];
+    ERL_NIF_TERM real_type = extract.use_f32 ? atom_f32 : atom_f64;
+    
+    unsigned char *times_out = enif_make_new_binary(env, num_frames * sizeof(double), &values[0]);
+    for (size_t i = 0; i < num_frames; i++) {
+        store_f64_le(times_out + i * sizeof(double), times[i]);
+    }
+    enif_free(times);
+    layout_values[0] = make_layout(env, atom_f64, 1, sizeof(double), num_frames);
+    values[1] = enif_make_binary(env, &positions_bin);
+    layout_values[1] = make_layout(env, real_type, 3, elem_size, b.num_points);
+    if (num_outputs == 3) {
+        values[3] = enif_make_binary(env, &normals_bin);
+        layout_values[2] = make_layout(env, real_type, 3, elem_size, b.num_dirs);
+    }
+    
+    values[2] = make_map(env, layout_keys, layout_values, num_outputs);
+    return enif_make_tuple2(env,
+        atom_ok,
+        make_map(env, keys, values, num_outputs + 1));
+}
+
+// ============================================================================
+// Vertex Animation Textures
+// ============================================================================
+
+// Helper: Layout of an RGBA texture binary of `height` rows of `width`
+// texels: %{type, components, stride, count, width, height}
+static ERL_NIF_TERM make_texture_layout(ErlNifEnv* env, bool half, size_t width, size_t height) {
+    size_t elem_size = half ? sizeof(uint16_t) : sizeof(float);
+    ERL_NIF_TERM keys[6] = { atom_type, atom_components, atom_stride, atom_count, atom_width, atom_height };
+    ERL_NIF_TERM values[6] = {
+        half ? atom_f16 : atom_f32,
+        enif_make_uint64(env, 4),
+        enif_make_uint64(env, 4 * elem_size),
+        enif_make_uint64(env, width * height),
+        enif_make_uint64(env, width),
+        enif_make_uint64(env, height),
+    };
+    return make_map(env, keys, values, 6);
+}
+
+// Helper: Encode `count` xyzw floats as RGBA texels. Positions are remapped
+// from `[min, max]` to `[0, 1]` when `range` is set and get `w = 1`;
+// directions are renormalized with `w = 0`.
+static ERL_NIF_TERM make_vat_texture(ErlNifEnv* env, const float *src, size_t count, bool half, bool is_point,
+                                     const float *min, const float *range) {
+    size_t elem_size = half ? sizeof(uint16_t) : sizeof(float);
+    ERL_NIF_TERM result;
+    unsigned char *dst = enif_make_new_binary(env, count * 4 * elem_size, &result);
+    for (size_t i = 0; i < count; i++) {
+        float texel[4] = { src[i * 4 + 0], src[i * 4 + 1], src[i * 4 + 2], is_point ? 1.0f : 0.0f };
+        if (is_point && range) {
+            for (int c = 0; c < 3; c++) {
+                texel[c] = range[c] > 0.0f ? (texel[c] - min[c]) / range[c] : 0.0f;
             }
-            if (enif_get_map_value(env, keyframe, enif_make_atom(env, "rotation"), &value)) {
-                enif_make_map_put(env, keyframe_map, enif_make_atom(env, "rotation"), value, &keyframe_map);
+        } else if (!is_point) {
+            float len = sqrtf(texel[0] * texel[0] + texel[1] * texel[1] + texel[2] * texel[2]);
+            for (int c = 0; c < 3 && len > 0.0f; c++) {
+                texel[c] /= len;
             }
-            
-            all_keyframes = enif_make_list_cell(env, keyframe_map, all_keyframes);
         }
-        
-        // Extract scale keyframes
-        for (size_t j = baked_node->scale_keys.count; j > 0; j--) {
-            ufbx_baked_vec3 *scale_key = &baked_node->scale_keys.data[j - 1];
-            ERL_NIF_TERM keyframe = extract_vec3_keyframe(env, scale_key, "scale");
-            
-            // Add node_id to keyframe
-            ERL_NIF_TERM keyframe_map = enif_make_new_map(env);
-            ERL_NIF_TERM node_id_key = enif_make_atom(env, "node_id");
-            ERL_NIF_TERM node_id_val = enif_make_uint(env, node_id);
-            enif_make_map_put(env, keyframe_map, node_id_key, node_id_val, &keyframe_map);
-            
-            // Copy keyframe fields into map
-            ERL_NIF_TERM value;
-            if (enif_get_map_value(env, keyframe, enif_make_atom(env, "time"), &value)) {
-                enif_make_map_put(env, keyframe_map, enif_make_atom(env, "time"), value, &keyframe_map);
+        for (int c = 0; c < 4; c++) {
+            if (half) {
+                store_f16_le(dst + (i * 4 + c) * elem_size, texel[c]);
+            } else {
+                store_f32_le(dst + (i * 4 + c) * elem_size, texel[c]);
             }
-            if (enif_get_map_value(env, keyframe, enif_make_atom(env, "scale"), &value)) {
-                enif_make_map_put(env, keyframe_map, enif_make_atom(env, "scale"), value, &keyframe_map);
+        }
+    }
+    return result;
+}
+
+static ERL_NIF_TERM bake_vertex_animation_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    ufbx_scene *scene;
+    unsigned int mesh_index, stack_index;
+    if (!get_element_args(env, argv, &scene, &mesh_index) || !enif_get_uint(env, argv[2], &stack_index)) {
+        return enif_make_badarg(env);
+    }
+    if (mesh_index >= scene->meshes.count || stack_index >= scene->anim_stacks.count) {
+        return make_not_found(env);
+    }
+    
+    extract_opts extract = { 0 };
+    parse_extract_opts(env, argv[3], &extract);
+    double scene_rate = scene->settings.frames_per_second;
+    double frame_rate = scene_rate > 0.0 && isfinite(scene_rate) ? scene_rate : 30.0;
+    get_opt_double(env, argv[3], atom_frame_rate, &frame_rate);
+    bool normalize = false;
+    get_opt_bool(env, argv[3], atom_normalize, &normalize);
+    ERL_NIF_TERM format;
+    bool half = !get_opt(env, argv[3], atom_texture_format, &format) || !enif_is_identical(format, atom_rgba32f);
+    if (!(frame_rate > 0.0) || !isfinite(frame_rate)) {
+        return make_error(env, "invalid frame rate");
+    }
+    
+    // One frame per `1 / frame_rate` over the stack, both ends included. The
+    // count is checked as a double so huge stacks can't overflow the cast.
+    const ufbx_anim_stack *stack = scene->anim_stacks.data[stack_index];
+    double duration = stack->time_end > stack->time_begin ? stack->time_end - stack->time_begin : 0.0;
+    double frames = floor(duration * frame_rate + 0.5) + 1.0;
+    if (!(frames <= (double)MAX_SKIN_FRAMES)) {
+        return make_error(env, "too many frames");
+    }
+    size_t num_frames = (size_t)frames;
+    double *times = (double*)enif_alloc(num_frames * sizeof(double));
+    if (!times) {
+        return make_error(env, "out of memory");
+    }
+    for (size_t i = 0; i < num_frames; i++) {
+        double t = stack->time_begin + (double)i / frame_rate;
+        times[i] = t < stack->time_end ? t : stack->time_end;
+    }
+    
+    const ufbx_mesh *mesh = scene->meshes.data[mesh_index];
+    skin_batch b = { 0 };
+    b.scene = scene;
+    b.anim = stack->anim;
+    b.mesh = mesh;
+    b.times = times;
+    b.num_joints = mesh_skin(mesh) ? mesh_skin(mesh)->clusters.count : 0;
+    b.num_vertices = mesh->num_vertices;
+    b.apply_blend = true;
+    b.opts = &extract;
+    
+    render_mesh rm = { 0 };
+    int ok = gather_skin_influences(&b) && prepare_render_skin_batch(&b, &extract, &rm);
+    size_t num_texels = num_frames * b.num_points;
+    if (ok) {
+        b.failed = (unsigned char*)enif_alloc(num_frames);
+        b.positions_xyzw = (float*)enif_alloc((num_texels + 1) * 4 * sizeof(float));
+        b.normals_xyzw = b.dirs ? (float*)enif_alloc((num_texels + 1) * 4 * sizeof(float)) : NULL;
+        ok = b.failed && b.positions_xyzw && (!b.dirs || b.normals_xyzw);
+    }
+    ERL_NIF_TERM result = make_error(env, "out of memory");
+    if (ok) {
+        memset(b.failed, 0, num_frames);
+        run_parallel(&run_skin_frame, &b, num_frames);
+        for (size_t i = 0; i < num_frames; i++) {
+            ok &= !b.failed[i];
+        }
+        if (!ok) {
+            result = make_error(env, "failed to evaluate scene");
+        }
+    }
+    
+    if (ok) {
+        float min[3] = { INFINITY, INFINITY, INFINITY }, max[3] = { -INFINITY, -INFINITY, -INFINITY };
+        for (size_t i = 0; i < num_texels; i++) {
+            for (int c = 0; c < 3; c++) {
+                float x = b.positions_xyzw[i * 4 + c];
+                min[c] = x < min[c] ? x : min[c];
+                max[c] = x > max[c] ? x : max[c];
             }
-            
-            all_keyframes = enif_make_list_cell(env, keyframe_map, all_keyframes);
         }
+        float range[3];
+        for (int c = 0; c < 3; c++) {
+            if (num_texels == 0) min[c] = max[c] = 0.0f;
+            range[c] = max[c] - min[c];
+        }
+        
+        ERL_NIF_TERM layout_keys[3] = { atom_times, atom_positions, atom_normals };
+        ERL_NIF_TERM layout_values[3];
+        ERL_NIF_TERM keys[7] = { atom_times, atom_frame_rate, atom_min, atom_max, atom_positions, atom_layout,
+                                 atom_normals };
+        ERL_NIF_TERM values[7];
+        unsigned char *times_out = enif_make_new_binary(env, num_frames * sizeof(double), &values[0]);
+        for (size_t i = 0; i < num_frames; i++) {
+            store_f64_le(times_out + i * sizeof(double), times[i]);
+        }
+        layout_values[0] = make_layout(env, atom_f64, 1, sizeof(double), num_frames);
+        values[1] = enif_make_double(env, frame_rate);
+        values[2] = enif_make_list3(env, enif_make_double(env, min[0]), enif_make_double(env, min[1]),
+                                    enif_make_double(env, min[2]));
+        values[3] = enif_make_list3(env, enif_make_double(env, max[0]), enif_make_double(env, max[1]),
+                                    enif_make_double(env, max[2]));
+        values[4] = make_vat_texture(env, b.positions_xyzw, num_texels, half, true, min, normalize ? range : NULL);
+        layout_values[1] = make_texture_layout(env, half, b.num_points, num_frames);
+        if (b.dirs) {
+            values[6] = make_vat_texture(env, b.normals_xyzw, num_texels, half, false, NULL, NULL);
+            layout_values[2] = make_texture_layout(env, half, b.num_points, num_frames);
+        }
+        values[5] = make_map(env, layout_keys, layout_values, b.dirs ? 3 : 2);
+        result = enif_make_tuple2(env, atom_ok, make_map(env, keys, values, b.dirs ? 7 : 6));
     }
     
-    // keyframes
-    keys[idx] = enif_make_atom(env, "keyframes");
-    values[idx] = all_keyframes;
-    idx++;
+    if (b.positions_xyzw) enif_free(b.positions_xyzw);
+    if (b.normals_xyzw) enif_free(b.normals_xyzw);
+    free_skin_batch(&b);
+    free_render_mesh(&rm);
+    enif_free(times);
+    return result;
+}
+
+// ============================================================================
+// Blend Shape Evaluation
+// ============================================================================
+
+// Helper: Parse channel weights, a list of numbers or a binary of
+// little-endian `f32`s, into `count` zero-initialized reals. Fails if more
+// weights than channels are given.
+static int parse_blend_weights(ErlNifEnv* env, ERL_NIF_TERM term, size_t count, ufbx_real *out) {
+    memset(out, 0, count * sizeof(ufbx_real));
     
-    // Build map manually
-    ERL_NIF_TERM map = enif_make_new_map(env);
-    for (size_t i = 0; i < idx; i++) {
-        enif_make_map_put(env, map, keys[i], values[i], &map);
+    ErlNifBinary bin;
+    if (enif_inspect_binary(env, term, &bin)) {
+        if (bin.size % sizeof(float) != 0 || bin.size / sizeof(float) > count) {
+            return 0;
+        }
+        for (size_t i = 0; i < bin.size / sizeof(float); i++) {
+            out[i] = load_f32_le(bin.data + i * sizeof(float));
+        }
+        return 1;
     }
     
-    return map;
+    ERL_NIF_TERM head;
+    size_t i = 0;
+    while (enif_get_list_cell(env, term, &head, &term)) {
+        double value;
+        ErlNifSInt64 integer;
+        if (i >= count) {
+            return 0;
+        }
+        if (!enif_get_double(env, head, &value)) {
+            if (!enif_get_int64(env, head, &integer)) {
+                return 0;
+            }
+            value = (double)integer;
+        }
+        out[i++] = (ufbx_real)value;
+    }
+    return enif_is_empty_list(env, term);
 }
 
-// Helper: Extract scene data from ufbx_scene to Elixir map
-static ERL_NIF_TERM extract_scene_data(ErlNifEnv* env, ufbx_scene *scene) {
-    // Build nodes list
-    ERL_NIF_TERM nodes = enif_make_list(env, 0);
-    for (size_t i = scene->nodes.count; i > 0; i--) {
-        ufbx_node *node = scene->nodes.data[i - 1];
-        ERL_NIF_TERM node_term = extract_node(env, node, node->typed_id);
-        nodes = enif_make_list_cell(env, node_term, nodes);
+static ERL_NIF_TERM evaluate_blend_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    ufbx_scene *scene;
+    unsigned int index;
+    if (!get_element_args(env, argv, &scene, &index)) {
+        return enif_make_badarg(env);
     }
-    
-    // Build meshes list
-    ERL_NIF_TERM meshes = enif_make_list(env, 0);
-    for (size_t i = scene->meshes.count; i > 0; i--) {
-        ufbx_mesh *mesh = scene->meshes.data[i - 1];
-        ERL_NIF_TERM mesh_term = extract_mesh(env, mesh);
-        meshes = enif_make_list_cell(env, mesh_term, meshes);
+    if (index >= scene->meshes.count) {
+        return make_not_found(env);
     }
     
-    // Build materials list
-    ERL_NIF_TERM materials = enif_make_list(env, 0);
-    for (size_t i = scene->materials.count; i > 0; i--) {
-        ufbx_material *material = scene->materials.data[i - 1];
-        ERL_NIF_TERM material_term = extract_material(env, material);
-        materials = enif_make_list_cell(env, material_term, materials);
+    const ufbx_mesh *mesh = scene->meshes.data[index];
+    size_t num_channels = blend_channel_count(mesh);
+    size_t num_vertices = mesh->num_vertices;
+    int has_normals = mesh->vertex_normal.exists;
+    ufbx_real *weights = (ufbx_real*)enif_alloc((num_channels + 1) * sizeof(ufbx_real));
+    if (!weights) {
+        return make_error(env, "out of memory");
     }
-    
-    // Build textures list
-    ERL_NIF_TERM textures = enif_make_list(env, 0);
-    for (size_t i = scene->textures.count; i > 0; i--) {
-        ufbx_texture *texture = scene->textures.data[i - 1];
-        ERL_NIF_TERM texture_term = extract_texture(env, texture);
-        textures = enif_make_list_cell(env, texture_term, textures);
+    if (!parse_blend_weights(env, argv[2], num_channels, weights)) {
+        enif_free(weights);
+        return enif_make_badarg(env);
     }
     
-    // Extract animations from anim_stacks
-    ERL_NIF_TERM animations = enif_make_list(env, 0);
-    ufbx_bake_opts bake_opts = {0};
-    bake_opts.resample_rate = 30.0; // 30 FPS default
+    // Positions start at the base mesh, normal offsets at zero
+    float *positions = (float*)enif_alloc((num_vertices + 1) * 4 * sizeof(float));
+    float *normal_offsets = has_normals ? (float*)enif_alloc((num_vertices + 1) * 4 * sizeof(float)) : NULL;
+    ufbx_real *key_weights = NULL;
+    size_t max_keys = 1;
+    for (size_t d = 0; d < mesh->blend_deformers.count; d++) {
+        const ufbx_blend_deformer *deformer = mesh->blend_deformers.data[d];
+        for (size_t c = 0; c < deformer->channels.count; c++) {
+            size_t num_keys = deformer->channels.data[c]->keyframes.count;
+            max_keys = num_keys > max_keys ? num_keys : max_keys;
+        }
+    }
+    key_weights = (ufbx_real*)enif_alloc(max_keys * sizeof(ufbx_real));
+    if (!positions || (has_normals && !normal_offsets) || !key_weights) {
+        if (positions) enif_free(positions);
+        if (normal_offsets) enif_free(normal_offsets);
+        if (key_weights) enif_free(key_weights);
+        enif_free(weights);
+        return make_error(env, "out of memory");
+    }
+    for (size_t v = 0; v < num_vertices; v++) {
+        ufbx_vec3 p = mesh->vertices.data[v];
+        positions[v * 4 + 0] = (float)p.x;
+        positions[v * 4 + 1] = (float)p.y;
+        positions[v * 4 + 2] = (float)p.z;
+        positions[v * 4 + 3] = 0.0f;
+    }
+    if (normal_offsets) {
+        memset(normal_offsets, 0, num_vertices * 4 * sizeof(float));
+    }
     
-    for (size_t i = scene->anim_stacks.count; i > 0; i--) {
-        ufbx_anim_stack *anim_stack = scene->anim_stacks.data[i - 1];
-        
-        // Bake animation
-        ufbx_error error;
-        ufbx_baked_anim *baked = ufbx_bake_anim(scene, anim_stack->anim, &bake_opts, &error);
-        
-        if (baked) {
-            ERL_NIF_TERM animation_term = extract_animation(env, baked, anim_stack);
-            animations = enif_make_list_cell(env, animation_term, animations);
-            ufbx_free_baked_anim(baked);
+    // Channels in `blend_channels` order, skipping the ones at zero weight
+    size_t channel_index = 0;
+    for (size_t d = 0; mesh_has_blend(mesh) && d < mesh->blend_deformers.count; d++) {
+        const ufbx_blend_deformer *deformer = mesh->blend_deformers.data[d];
+        for (size_t c = 0; c < deformer->channels.count; c++, channel_index++) {
+            const ufbx_blend_channel *channel = deformer->channels.data[c];
+            if (weights[channel_index] == 0.0f) continue;
+            blend_keyframe_weights(channel, weights[channel_index], key_weights);
+            for (size_t k = 0; k < channel->keyframes.count; k++) {
+                const ufbx_blend_shape *shape = channel->keyframes.data[k].shape;
+                if (key_weights[k] == 0.0f || !shape) continue;
+                add_blend_shape_offsets(mesh, shape, (float)key_weights[k], positions, normal_offsets);
+            }
         }
     }
+    enif_free(key_weights);
+    enif_free(weights);
     
-    // Build version string from metadata
-    char version_str[32];
-    snprintf(version_str, sizeof(version_str), "FBX %u.%u", 
-             scene->metadata.version / 1000, 
-             (scene->metadata.version % 1000) / 100);
+    ERL_NIF_TERM layout_keys[2] = { atom_positions, atom_normals };
+    ERL_NIF_TERM layout_values[2];
+    ERL_NIF_TERM keys[3] = { atom_positions, atom_layout, atom_normals };
+    ERL_NIF_TERM values[3];
     
-    // Build result map
-    ERL_NIF_TERM keys[6];
-    ERL_NIF_TERM values[6];
-    keys[0] = enif_make_atom(env, "version");
-    values[0] = enif_make_string(env, version_str, ERL_NIF_LATIN1);
-    keys[1] = enif_make_atom(env, "nodes");
-    values[1] = nodes;
-    keys[2] = enif_make_atom(env, "meshes");
-    values[2] = meshes;
-    keys[3] = enif_make_atom(env, "materials");
-    values[3] = materials;
-    keys[4] = enif_make_atom(env, "textures");
-    values[4] = textures;
-    keys[5] = enif_make_atom(env, "animations");
-    values[5] = animations;
+    unsigned char *dst = enif_make_new_binary(env, num_vertices * 3 * sizeof(float), &values[0]);
+    for (size_t v = 0; v < num_vertices; v++) {
+        for (int c = 0; c < 3; c++) {
+            store_f32_le(dst + (v * 3 + c) * sizeof(float), positions[v * 4 + c]);
+        }
+    }
+    layout_values[0] = make_layout(env, atom_f32, 3, sizeof(float), num_vertices);
+    enif_free(positions);
     
-    // Build map manually for compatibility
-    ERL_NIF_TERM scene_data = enif_make_new_map(env);
-    for (size_t i = 0; i < 6; i++) {
-        enif_make_map_put(env, scene_data, keys[i], values[i], &scene_data);
+    // Normals per face corner: the corner's normal plus its vertex's offset
+    if (normal_offsets) {
+        dst = enif_make_new_binary(env, mesh->num_indices * 3 * sizeof(float), &values[2]);
+        for (size_t i = 0; i < mesh->num_indices; i++) {
+            const float *offset = normal_offsets + mesh->vertex_indices.data[i] * 4;
+            ufbx_vec3 n = ufbx_get_vertex_vec3(&mesh->vertex_normal, i);
+            n.x += offset[0];
+            n.y += offset[1];
+            n.z += offset[2];
+            n = ufbx_vec3_normalize(n);
+            store_f32_le(dst + (i * 3 + 0) * sizeof(float), (float)n.x);
+            store_f32_le(dst + (i * 3 + 1) * sizeof(float), (float)n.y);
+            store_f32_le(dst + (i * 3 + 2) * sizeof(float), (float)n.z);
+        }
+        layout_values[1] = make_layout(env, atom_f32, 3, sizeof(float), mesh->num_indices);
+        enif_free(normal_offsets);
     }
     
-    return scene_data;
+    values[1] = make_map(env, layout_keys, layout_values, has_normals ? 2 : 1);
+    return enif_make_tuple2(env,
+        atom_ok,
+        make_map(env, keys, values, has_normals ? 3 : 2));
 }
 
-static ERL_NIF_TERM load_fbx_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+// ============================================================================
+// Geometry Cache Resource
+// ============================================================================
+
+// An open geometry cache (.mc/.mcx/.pc2) kept alive between NIF calls. Only
+// the structure is in memory; frames are read from disk on demand. Either a
+// standalone cache owned by the resource, or the external cache of a scene
+// deformer, in which case the resource holds a reference to the scene.
+typedef struct cache_resource {
+    ufbx_geometry_cache *cache;
+    ufbx_scene *scene;
+} cache_resource;
+
+static ErlNifResourceType *cache_resource_type = NULL;
+
+static void cache_resource_dtor(ErlNifEnv* env, void* obj) {
+    (void)env;  // Unused parameter
+    cache_resource *res = (cache_resource*)obj;
+    if (res->scene) {
+        ufbx_free_scene(res->scene);
+    } else if (res->cache) {
+        ufbx_free_geometry_cache(res->cache);
+    }
+}
+
+// Helper: Wrap a cache in a new resource term, taking ownership of `cache`
+// or retaining `scene` if it belongs to one
+static ERL_NIF_TERM make_cache_resource(ErlNifEnv* env, ufbx_geometry_cache *cache, ufbx_scene *scene) {
+    cache_resource *res = (cache_resource*)enif_alloc_resource(cache_resource_type, sizeof(cache_resource));
+    if (scene) {
+        ufbx_retain_scene(scene);
+    }
+    res->cache = cache;
+    res->scene = scene;
+    ERL_NIF_TERM term = enif_make_resource(env, res);
+    enif_release_resource(res);
+    return term;
+}
+
+// Helper: Get the cache of a resource term and the channel at `argv[1]`
+static int get_cache_channel(ErlNifEnv* env, const ERL_NIF_TERM argv[], const ufbx_geometry_cache **cache,
+                             unsigned int *channel) {
+    cache_resource *res;
+    if (!enif_get_resource(env, argv[0], cache_resource_type, (void**)&res) ||
+        !enif_get_uint(env, argv[1], channel)) {
+        return 0;
+    }
+    *cache = res->cache;
+    return 1;
+}
+
+// Helper: Number of vec3s stored in a cache frame
+static size_t cache_frame_points(const ufbx_cache_frame *frame) {
+    switch (frame->data_format) {
+    case UFBX_CACHE_DATA_FORMAT_VEC3_FLOAT:
+    case UFBX_CACHE_DATA_FORMAT_VEC3_DOUBLE:
+        return frame->data_count;
+    default:
+        return frame->data_count / 3;
+    }
+}
+
+static ERL_NIF_TERM make_cache_interpretation(ufbx_cache_interpretation interpretation) {
+    switch (interpretation) {
+    case UFBX_CACHE_INTERPRETATION_POINTS: return atom_points;
+    case UFBX_CACHE_INTERPRETATION_VERTEX_POSITION: return atom_vertex_position;
+    case UFBX_CACHE_INTERPRETATION_VERTEX_NORMAL: return atom_vertex_normal;
+    default: return atom_unknown;
+    }
+}
+
+// Open a standalone geometry cache file
+static ERL_NIF_TERM open_geometry_cache_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
 {
     (void)argc;  // Unused parameter
     ErlNifBinary file_path_bin;
     ufbx_error error;
-    ufbx_scene *scene;
-    
-    // Get file path from Elixir
     if (!enif_inspect_binary(env, argv[0], &file_path_bin)) {
         return enif_make_badarg(env);
     }
     
-    // Null-terminate the path
-    char file_path[file_path_bin.size + 1];
-    memcpy(file_path, file_path_bin.data, file_path_bin.size);
-    file_path[file_path_bin.size] = '\0';
-    
-    // Load FBX file using ufbx
-    ufbx_load_opts opts = { 0 };
-    scene = ufbx_load_file(file_path, &opts, &error);
-    
-    if (!scene) {
-        // Return error tuple
+    ufbx_geometry_cache_opts opts = { 0 };
+    get_opt_double(env, argv[1], atom_frame_rate, &opts.frames_per_second);
+    ufbx_geometry_cache *cache = ufbx_load_geometry_cache_len((const char*)file_path_bin.data,
+        file_path_bin.size, &opts, &error);
+    if (!cache) {
         return enif_make_tuple2(env,
-            enif_make_atom(env, "error"),
+            atom_error,
             enif_make_string(env, error.description.data, ERL_NIF_LATIN1));
     }
     
-    // Extract scene data
-    ERL_NIF_TERM scene_data = extract_scene_data(env, scene);
-    
-    // Free scene
-    ufbx_free_scene(scene);
-    
-    // Return ok tuple with scene data
     return enif_make_tuple2(env,
-        enif_make_atom(env, "ok"),
-        scene_data);
+        atom_ok,
+        make_cache_resource(env, cache, NULL));
 }
 
-// Load FBX from binary data
-static ERL_NIF_TERM load_fbx_binary_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+// Get the external cache loaded for a scene's cache deformer
+static ERL_NIF_TERM geometry_cache_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
 {
     (void)argc;  // Unused parameter
-    ErlNifBinary data_bin;
-    ufbx_error error;
-    ufbx_scene *scene;
-    
-    // Get binary data from Elixir
-    if (!enif_inspect_binary(env, argv[0], &data_bin)) {
+    scene_resource *res;
+    unsigned int index;
+    if (!get_scene_resource(env, argv[0], &res) || !enif_get_uint(env, argv[1], &index)) {
         return enif_make_badarg(env);
     }
+    if (index >= res->scene->cache_deformers.count || !res->scene->cache_deformers.data[index]->external_cache) {
+        return make_not_found(env);
+    }
     
-    // Load FBX from memory using ufbx
-    ufbx_load_opts opts = { 0 };
-    scene = ufbx_load_memory(data_bin.data, data_bin.size, &opts, &error);
+    ufbx_geometry_cache *cache = res->scene->cache_deformers.data[index]->external_cache;
+    return enif_make_tuple2(env,
+        atom_ok,
+        make_cache_resource(env, cache, res->scene));
+}
+
+// Cache summary: one %{name, interpretation, point_count, times, layout} per channel
+static ERL_NIF_TERM geometry_cache_info_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    cache_resource *res;
+    if (!enif_get_resource(env, argv[0], cache_resource_type, (void**)&res)) {
+        return enif_make_badarg(env);
+    }
     
-    if (!scene) {
-        // Return error tuple
-        return enif_make_tuple2(env,
-            enif_make_atom(env, "error"),
-            enif_make_string(env, error.description.data, ERL_NIF_LATIN1));
+    const ufbx_geometry_cache *cache = res->cache;
+    ERL_NIF_TERM keys[5] = { atom_name, atom_interpretation, atom_point_count, atom_times, atom_layout };
+    ERL_NIF_TERM layout_keys[1] = { atom_times };
+    ERL_NIF_TERM channels = enif_make_list(env, 0);
+    for (size_t i = cache->channels.count; i > 0; i--) {
+        const ufbx_cache_channel *channel = &cache->channels.data[i - 1];
+        size_t points = 0;
+        ERL_NIF_TERM values[5];
+        ERL_NIF_TERM layout_values[1];
+        unsigned char *times = enif_make_new_binary(env, channel->frames.count * sizeof(double), &values[3]);
+        for (size_t f = 0; f < channel->frames.count; f++) {
+            size_t frame_points = cache_frame_points(&channel->frames.data[f]);
+            points = frame_points > points ? frame_points : points;
+            store_f64_le(times + f * sizeof(double), channel->frames.data[f].time);
+        }
+        values[0] = make_string(env, channel->name);
+        values[1] = make_cache_interpretation(channel->interpretation);
+        values[2] = enif_make_uint64(env, points);
+        layout_values[0] = make_layout(env, atom_f64, 1, sizeof(double), channel->frames.count);
+        values[4] = make_map(env, layout_keys, layout_values, 1);
+        channels = enif_make_list_cell(env, make_map(env, keys, values, 5), channels);
     }
     
-    // Extract scene data
-    ERL_NIF_TERM scene_data = extract_scene_data(env, scene);
+    ERL_NIF_TERM info_keys[1] = { atom_channels };
+    ERL_NIF_TERM info_values[1] = { channels };
+    return enif_make_tuple2(env,
+        atom_ok,
+        make_map(env, info_keys, info_values, 1));
+}
+
+// Helper: Read `count` vec3s with `read` into %{time, data, layout}, `data`
+// packed in `:precision`. Only this one frame (or the two frames around a
+// sample) is read from disk.
+static ERL_NIF_TERM read_cache_points(ErlNifEnv* env, const ufbx_cache_channel *channel,
+                                      const ufbx_cache_frame *frame, double time, size_t count,
+                                      ERL_NIF_TERM opts_term) {
+    extract_opts opts = { 0 };
+    parse_extract_opts(env, opts_term, &opts);
+    opts.owner = NULL;
+    ufbx_geometry_cache_data_opts data_opts = { 0 };
+    get_opt_bool(env, opts_term, atom_ignore_transform, &data_opts.ignore_transform);
     
-    // Free scene
-    ufbx_free_scene(scene);
+    ufbx_vec3 *points = (ufbx_vec3*)enif_alloc((count + 1) * sizeof(ufbx_vec3));
+    if (!points) {
+        return make_error(env, "out of memory");
+    }
+    size_t num_read = frame ? ufbx_read_geometry_cache_vec3(frame, points, count, &data_opts)
+                            : ufbx_sample_geometry_cache_vec3(channel, time, points, count, &data_opts);
+    if (num_read < count) {
+        enif_free(points);
+        return make_error(env, "failed to read geometry cache");
+    }
     
-    // Return ok tuple with scene data
+    ERL_NIF_TERM layout_keys[1] = { atom_data };
+    ERL_NIF_TERM layout_values[1];
+    ERL_NIF_TERM keys[3] = { atom_time, atom_data, atom_layout };
+    ERL_NIF_TERM values[3];
+    values[0] = enif_make_double(env, time);
+    values[1] = make_packed_reals(env, &points[0].x, count, 3, &opts, &layout_values[0]);
+    values[2] = make_map(env, layout_keys, layout_values, 1);
+    enif_free(points);
     return enif_make_tuple2(env,
-        enif_make_atom(env, "ok"),
-        scene_data);
+        atom_ok,
+        make_map(env, keys, values, 3));
+}
+
+// Read one stored frame of a channel
+static ERL_NIF_TERM read_geometry_cache_frame_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    const ufbx_geometry_cache *cache;
+    unsigned int channel_index, frame_index;
+    if (!get_cache_channel(env, argv, &cache, &channel_index) || !enif_get_uint(env, argv[2], &frame_index)) {
+        return enif_make_badarg(env);
+    }
+    if (channel_index >= cache->channels.count || frame_index >= cache->channels.data[channel_index].frames.count) {
+        return make_not_found(env);
+    }
+    
+    const ufbx_cache_channel *channel = &cache->channels.data[channel_index];
+    const ufbx_cache_frame *frame = &channel->frames.data[frame_index];
+    return read_cache_points(env, channel, frame, frame->time, cache_frame_points(frame), argv[3]);
+}
+
+// Sample a channel at a time in seconds, interpolating between stored frames
+static ERL_NIF_TERM sample_geometry_cache_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    (void)argc;  // Unused parameter
+    const ufbx_geometry_cache *cache;
+    unsigned int channel_index;
+    double time;
+    ErlNifSInt64 integer;
+    if (!get_cache_channel(env, argv, &cache, &channel_index)) {
+        return enif_make_badarg(env);
+    }
+    if (!enif_get_double(env, argv[2], &time)) {
+        if (!enif_get_int64(env, argv[2], &integer)) {
+            return enif_make_badarg(env);
+        }
+        time = (double)integer;
+    }
+    if (channel_index >= cache->channels.count || cache->channels.data[channel_index].frames.count == 0) {
+        return make_not_found(env);
+    }
+    
+    // Frames around `time` may differ in size, so only the common points are sampled
+    const ufbx_cache_channel *channel = &cache->channels.data[channel_index];
+    size_t count = SIZE_MAX;
+    for (size_t f = 0; f < channel->frames.count; f++) {
+        size_t points = cache_frame_points(&channel->frames.data[f]);
+        count = points < count ? points : count;
+    }
+    return read_cache_points(env, channel, NULL, time, count, argv[3]);
 }
 
 // ============================================================================
@@ -680,55 +5445,344 @@ static int parse_string(ErlNifEnv* env, ERL_NIF_TERM term, char **out_str, size_
             *out_len = atom_len;
             return 1;
         }
-        enif_free(atom_str);
+        enif_free(atom_str);
+    }
+    return 0;
+}
+
+// Helper: Get uint from map
+static int get_map_uint(ErlNifEnv* env, ERL_NIF_TERM map, ERL_NIF_TERM key, unsigned int *out) {
+    ERL_NIF_TERM value;
+    if (enif_get_map_value(env, map, key, &value)) {
+        return enif_get_uint(env, value, out);
+    }
+    return 0;
+}
+
+// Helper: Get string from map
+static int get_map_string(ErlNifEnv* env, ERL_NIF_TERM map, ERL_NIF_TERM key, char **out_str, size_t *out_len) {
+    ERL_NIF_TERM value;
+    if (enif_get_map_value(env, map, key, &value)) {
+        return parse_string(env, value, out_str, out_len);
+    }
+    return 0;
+}
+
+// Helper: Get vec3 from map
+static int get_map_vec3(ErlNifEnv* env, ERL_NIF_TERM map, ERL_NIF_TERM key, ufbxw_vec3 *out) {
+    ERL_NIF_TERM value;
+    if (enif_get_map_value(env, map, key, &value)) {
+        return parse_vec3_from_list(env, value, out);
+    }
+    return 0;
+}
+
+// Helper: Get vec4 from map
+static int get_map_vec4(ErlNifEnv* env, ERL_NIF_TERM map, ERL_NIF_TERM key, ufbxw_vec4 *out) {
+    ERL_NIF_TERM value;
+    if (enif_get_map_value(env, map, key, &value)) {
+        return parse_vec4_from_list(env, value, out);
+    }
+    return 0;
+}
+
+// Helper: Get list from map
+static int get_map_list(ErlNifEnv* env, ERL_NIF_TERM map, ERL_NIF_TERM key, ERL_NIF_TERM *out) {
+    return enif_get_map_value(env, map, key, out);
+}
+
+// Mesh attribute in a write map: either a flat list of numbers or a packed
+// little-endian binary as produced by `mesh_format: :packed`. The element
+// type of a binary comes from the mesh's optional `layout` map and defaults
+// to f64 for reals and u32 for indices.
+typedef struct attribute_source {
+    int packed;
+    ERL_NIF_TERM list;
+    ErlNifBinary bin;
+    ERL_NIF_TERM type;
+    size_t count; // Number of scalar values
+} attribute_source;
+
+static int get_attribute_source(ErlNifEnv* env, ERL_NIF_TERM mesh_map, ERL_NIF_TERM key,
+                                ERL_NIF_TERM default_type, attribute_source *out) {
+    ERL_NIF_TERM value;
+    if (!enif_get_map_value(env, mesh_map, key, &value)) {
+        return 0;
+    }
+    
+    if (enif_inspect_binary(env, value, &out->bin)) {
+        ERL_NIF_TERM layout, attribute_layout;
+        out->packed = 1;
+        out->type = default_type;
+        if (enif_get_map_value(env, mesh_map, atom_layout, &layout) && enif_is_map(env, layout) &&
+            enif_get_map_value(env, layout, key, &attribute_layout) && enif_is_map(env, attribute_layout)) {
+            enif_get_map_value(env, attribute_layout, atom_type, &out->type);
+        }
+        
+        size_t elem_size;
+        if (enif_is_identical(out->type, atom_f64)) {
+            elem_size = sizeof(double);
+        } else if (enif_is_identical(out->type, atom_f32) || enif_is_identical(out->type, atom_u32)) {
+            elem_size = sizeof(uint32_t);
+        } else {
+            return 0;
+        }
+        if (out->bin.size % elem_size != 0) {
+            return 0;
+        }
+        out->count = out->bin.size / elem_size;
+        return 1;
+    }
+    
+    unsigned int len;
+    if (!enif_get_list_length(env, value, &len)) {
+        return 0;
+    }
+    out->packed = 0;
+    out->list = value;
+    out->count = len;
+    return 1;
+}
+
+// Helper: Decode reals from an attribute source into a ufbxw buffer
+static int read_attribute_reals(ErlNifEnv* env, const attribute_source *src, ufbxw_real *dst) {
+    if (src->packed) {
+        const unsigned char *data = src->bin.data;
+        if (enif_is_identical(src->type, atom_f32)) {
+            for (size_t i = 0; i < src->count; i++) dst[i] = load_f32_le(data + i * sizeof(float));
+        } else if (enif_is_identical(src->type, atom_f64)) {
+            for (size_t i = 0; i < src->count; i++) dst[i] = load_f64_le(data + i * sizeof(double));
+        } else {
+            return 0;
+        }
+        return 1;
+    }
+    
+    ERL_NIF_TERM head, tail = src->list;
+    for (size_t i = 0; i < src->count; i++) {
+        ErlNifSInt64 int_value;
+        if (!enif_get_list_cell(env, tail, &head, &tail)) return 0;
+        if (enif_get_double(env, head, &dst[i])) continue;
+        if (!enif_get_int64(env, head, &int_value)) return 0;
+        dst[i] = (ufbxw_real)int_value;
+    }
+    return 1;
+}
+
+// Native little-endian f64 data can be referenced in place: the input terms
+// outlive the scene, which is saved and freed within the same NIF call
+static int can_reference_reals(const attribute_source *src) {
+    return src->packed && NATIVE_LITTLE_ENDIAN && enif_is_identical(src->type, atom_f64) &&
+        ((uintptr_t)src->bin.data % sizeof(ufbxw_real)) == 0;
+}
+
+// Helper: Get vec3 buffer from map
+static int get_map_vec3_buffer(ErlNifEnv* env, ufbxw_scene *scene, ERL_NIF_TERM map, ERL_NIF_TERM key,
+                               ufbxw_vec3_buffer *out) {
+    attribute_source src;
+    if (!get_attribute_source(env, map, key, atom_f64, &src) || src.count == 0 || src.count % 3 != 0) {
+        return 0;
+    }
+    if (can_reference_reals(&src)) {
+        *out = ufbxw_external_vec3_array(scene, (const ufbxw_vec3*)src.bin.data, src.count / 3);
+        return 1;
+    }
+    
+    *out = ufbxw_create_vec3_buffer(scene, src.count / 3);
+    ufbxw_vec3_list list = ufbxw_edit_vec3_buffer(scene, *out);
+    if (!list.data || !read_attribute_reals(env, &src, &list.data[0].x)) {
+        ufbxw_free_buffer(scene, out->id);
+        return 0;
+    }
+    return 1;
+}
+
+// Helper: Get vec2 buffer from map
+static int get_map_vec2_buffer(ErlNifEnv* env, ufbxw_scene *scene, ERL_NIF_TERM map, ERL_NIF_TERM key,
+                               ufbxw_vec2_buffer *out) {
+    attribute_source src;
+    if (!get_attribute_source(env, map, key, atom_f64, &src) || src.count == 0 || src.count % 2 != 0) {
+        return 0;
+    }
+    if (can_reference_reals(&src)) {
+        *out = ufbxw_external_vec2_array(scene, (const ufbxw_vec2*)src.bin.data, src.count / 2);
+        return 1;
+    }
+    
+    *out = ufbxw_create_vec2_buffer(scene, src.count / 2);
+    ufbxw_vec2_list list = ufbxw_edit_vec2_buffer(scene, *out);
+    if (!list.data || !read_attribute_reals(env, &src, &list.data[0].x)) {
+        ufbxw_free_buffer(scene, out->id);
+        return 0;
+    }
+    return 1;
+}
+
+// Helper: Get index buffer from map
+static int get_map_int_buffer(ErlNifEnv* env, ufbxw_scene *scene, ERL_NIF_TERM map, ERL_NIF_TERM key,
+                              ufbxw_int_buffer *out) {
+    attribute_source src;
+    if (!get_attribute_source(env, map, key, atom_u32, &src)) {
+        return 0;
+    }
+    if (src.packed && !enif_is_identical(src.type, atom_u32)) {
+        return 0;
+    }
+    if (src.packed && NATIVE_LITTLE_ENDIAN && ((uintptr_t)src.bin.data % sizeof(int32_t)) == 0) {
+        *out = ufbxw_external_int_array(scene, (const int32_t*)src.bin.data, src.count);
+        return 1;
+    }
+    
+    *out = ufbxw_create_int_buffer(scene, src.count);
+    ufbxw_int_list list = ufbxw_edit_int_buffer(scene, *out);
+    if (!list.data && src.count > 0) {
+        ufbxw_free_buffer(scene, out->id);
+        return 0;
+    }
+    if (src.packed) {
+        for (size_t i = 0; i < src.count; i++) {
+            list.data[i] = (int32_t)load_u32_le(src.bin.data + i * sizeof(uint32_t));
+        }
+        return 1;
     }
-    return 0;
+    ERL_NIF_TERM head, tail = src.list;
+    for (size_t i = 0; i < src.count; i++) {
+        unsigned int value;
+        if (!enif_get_list_cell(env, tail, &head, &tail) || !enif_get_uint(env, head, &value)) {
+            ufbxw_free_buffer(scene, out->id);
+            return 0;
+        }
+        list.data[i] = (int32_t)value;
+    }
+    return 1;
 }
 
-// Helper: Get uint from map
-static int get_map_uint(ErlNifEnv* env, ERL_NIF_TERM map, const char* key, unsigned int *out) {
-    ERL_NIF_TERM value;
-    ERL_NIF_TERM key_term = enif_make_atom(env, key);
-    if (enif_get_map_value(env, map, key_term, &value)) {
-        return enif_get_uint(env, value, out);
+// Create a mesh element from its write map
+static ufbxw_mesh build_ufbxw_mesh(ErlNifEnv* env, ufbxw_scene *scene, ERL_NIF_TERM mesh_map) {
+    ufbxw_mesh mesh = ufbxw_create_mesh(scene);
+    
+    // Set name
+    char *name_str;
+    size_t name_len;
+    if (get_map_string(env, mesh_map, atom_name, &name_str, &name_len)) {
+        ufbxw_set_name_len(scene, mesh.id, name_str, name_len);
     }
-    return 0;
+    
+    // Positions are flat [x1, y1, z1, x2, ...] or a packed binary
+    ufbxw_vec3_buffer vertices;
+    if (get_map_vec3_buffer(env, scene, mesh_map, atom_positions, &vertices)) {
+        ufbxw_mesh_set_vertices(scene, mesh, vertices);
+    }
+    
+    // Set indices/triangles
+    ufbxw_int_buffer indices;
+    if (get_map_int_buffer(env, scene, mesh_map, atom_indices, &indices)) {
+        ufbxw_mesh_set_triangles(scene, mesh, indices);
+    }
+    
+    // Set normals
+    ufbxw_vec3_buffer normals;
+    if (get_map_vec3_buffer(env, scene, mesh_map, atom_normals, &normals)) {
+        ufbxw_mesh_set_normals(scene, mesh, normals, UFBXW_ATTRIBUTE_MAPPING_VERTEX);
+    }
+    
+    // Set UVs
+    ufbxw_vec2_buffer uvs;
+    if (get_map_vec2_buffer(env, scene, mesh_map, atom_texcoords, &uvs)) {
+        ufbxw_mesh_set_uvs(scene, mesh, 0, uvs, UFBXW_ATTRIBUTE_MAPPING_VERTEX);
+    }
+    
+    return mesh;
 }
 
-// Helper: Get string from map
-static int get_map_string(ErlNifEnv* env, ERL_NIF_TERM map, const char* key, char **out_str, size_t *out_len) {
-    ERL_NIF_TERM value;
-    ERL_NIF_TERM key_term = enif_make_atom(env, key);
-    if (enif_get_map_value(env, map, key_term, &value)) {
-        return parse_string(env, value, out_str, out_len);
+// Element lookup for the writer: maps (element type, id from the write map)
+// to the created ufbxw element and its write map. Open addressing with linear
+// probing keeps parent, mesh and material resolution O(1) per reference.
+typedef struct id_table_entry {
+    ufbxw_id element; // 0 marks an empty slot
+    ufbxw_element_type type;
+    unsigned int id;
+    ERL_NIF_TERM data;
+} id_table_entry;
+
+typedef struct id_table {
+    id_table_entry *entries;
+    size_t mask;
+} id_table;
+
+static int id_table_init(id_table *table, size_t count) {
+    size_t capacity = 16;
+    while (capacity < count * 2) capacity *= 2;
+    table->entries = (id_table_entry*)enif_alloc(sizeof(id_table_entry) * capacity);
+    if (!table->entries) return 0;
+    memset(table->entries, 0, sizeof(id_table_entry) * capacity);
+    table->mask = capacity - 1;
+    return 1;
+}
+
+static size_t id_table_hash(ufbxw_element_type type, unsigned int id) {
+    uint64_t h = ((uint64_t)type << 32 | id) * UINT64_C(0x9E3779B97F4A7C15);
+    return (size_t)(h >> 32);
+}
+
+static const id_table_entry *id_table_find(const id_table *table, ufbxw_element_type type, unsigned int id) {
+    for (size_t i = id_table_hash(type, id) & table->mask; ; i = (i + 1) & table->mask) {
+        const id_table_entry *entry = &table->entries[i];
+        if (!entry->element) return NULL;
+        if (entry->type == type && entry->id == id) return entry;
     }
-    return 0;
 }
 
-// Helper: Get vec3 from map
-static int get_map_vec3(ErlNifEnv* env, ERL_NIF_TERM map, const char* key, ufbxw_vec3 *out) {
-    ERL_NIF_TERM value;
-    ERL_NIF_TERM key_term = enif_make_atom(env, key);
-    if (enif_get_map_value(env, map, key_term, &value)) {
-        return parse_vec3_from_list(env, value, out);
+// The first element registered with an id wins, later duplicates are ignored
+static void id_table_insert(id_table *table, ufbxw_element_type type, unsigned int id,
+                            ufbxw_id element, ERL_NIF_TERM data) {
+    for (size_t i = id_table_hash(type, id) & table->mask; ; i = (i + 1) & table->mask) {
+        id_table_entry *entry = &table->entries[i];
+        if (entry->element && entry->type == type && entry->id == id) return;
+        if (!entry->element) {
+            entry->element = element;
+            entry->type = type;
+            entry->id = id;
+            entry->data = data;
+            return;
+        }
     }
-    return 0;
 }
 
-// Helper: Get vec4 from map
-static int get_map_vec4(ErlNifEnv* env, ERL_NIF_TERM map, const char* key, ufbxw_vec4 *out) {
-    ERL_NIF_TERM value;
-    ERL_NIF_TERM key_term = enif_make_atom(env, key);
-    if (enif_get_map_value(env, map, key_term, &value)) {
-        return parse_vec4_from_list(env, value, out);
+// Helper: Length of a list in the scene map, 0 if missing
+static unsigned int get_map_list_length(ErlNifEnv* env, ERL_NIF_TERM map, ERL_NIF_TERM key, ERL_NIF_TERM *out) {
+    unsigned int len;
+    if (get_map_list(env, map, key, out) && enif_get_list_length(env, *out, &len)) {
+        return len;
     }
+    *out = enif_make_list(env, 0);
     return 0;
 }
 
-// Helper: Get list from map
-static int get_map_list(ErlNifEnv* env, ERL_NIF_TERM map, const char* key, ERL_NIF_TERM *out) {
-    ERL_NIF_TERM key_term = enif_make_atom(env, key);
-    return enif_get_map_value(env, map, key_term, out);
+// Attach a mesh to a node together with the materials the mesh lists
+static void attach_ufbxw_mesh(ErlNifEnv* env, ufbxw_scene *scene, const id_table *table,
+                              ufbxw_node node, const id_table_entry *mesh) {
+    ufbxw_node_set_attribute(scene, node, mesh->element);
+    
+    ERL_NIF_TERM material_ids;
+    if (!get_map_list(env, mesh->data, atom_material_ids, &material_ids)) {
+        return;
+    }
+    ERL_NIF_TERM head, tail = material_ids;
+    int has_material = 0;
+    while (enif_get_list_cell(env, tail, &head, &tail)) {
+        unsigned int material_id;
+        if (!enif_get_uint(env, head, &material_id)) continue;
+        const id_table_entry *material = id_table_find(table, UFBXW_ELEMENT_MATERIAL, material_id);
+        if (material) {
+            ufbxw_connect(scene, material->element, node.id);
+            has_material = 1;
+        }
+    }
+    if (has_material) {
+        ufbxw_mesh mesh_handle = { mesh->element };
+        ufbxw_mesh_set_single_material(scene, mesh_handle, 0);
+    }
 }
 
 // Build ufbxw_scene from Elixir map data
@@ -739,410 +5793,192 @@ static ufbxw_scene* build_ufbxw_scene_from_map(ErlNifEnv* env, ERL_NIF_TERM scen
         return NULL;
     }
     
+    ERL_NIF_TERM nodes_list, meshes_list, materials_list;
+    unsigned int nodes_len = get_map_list_length(env, scene_data_map, atom_nodes, &nodes_list);
+    unsigned int meshes_len = get_map_list_length(env, scene_data_map, atom_meshes, &meshes_list);
+    unsigned int materials_len = get_map_list_length(env, scene_data_map, atom_materials, &materials_list);
+    
+    id_table table;
+    ufbxw_node *node_handles = (ufbxw_node*)enif_alloc(sizeof(ufbxw_node) * (nodes_len + 1));
+    if (!node_handles || !id_table_init(&table, (size_t)nodes_len + meshes_len + materials_len)) {
+        if (node_handles) enif_free(node_handles);
+        ufbxw_free_scene(scene);
+        return NULL;
+    }
+    
+    ERL_NIF_TERM head, tail;
+    unsigned int id;
+    
     // Parse nodes
-    ERL_NIF_TERM nodes_list;
-    if (get_map_list(env, scene_data_map, "nodes", &nodes_list)) {
-        unsigned int nodes_len;
-        if (enif_get_list_length(env, nodes_list, &nodes_len)) {
-            // Store node IDs for parent/child relationships
-            ufbxw_node *node_handles = (ufbxw_node*)enif_alloc(sizeof(ufbxw_node) * nodes_len);
-            unsigned int *node_ids = (unsigned int*)enif_alloc(sizeof(unsigned int) * nodes_len);
-            
-            ERL_NIF_TERM head, tail = nodes_list;
-            for (unsigned int i = 0; i < nodes_len; i++) {
-                if (!enif_get_list_cell(env, tail, &head, &tail)) break;
-                
-                // Create node
-                ufbxw_node node = ufbxw_create_node(scene);
-                node_handles[i] = node;
-                
-                // Get node ID
-                unsigned int node_id;
-                if (get_map_uint(env, head, "id", &node_id)) {
-                    node_ids[i] = node_id;
-                }
-                
-                // Set name
-                char *name_str;
-                size_t name_len;
-                if (get_map_string(env, head, "name", &name_str, &name_len)) {
-                    ufbxw_set_name_len(scene, node.id, name_str, name_len);
-                }
-                
-                // Set translation
-                ufbxw_vec3 translation = {0.0, 0.0, 0.0};
-                if (get_map_vec3(env, head, "translation", &translation)) {
-                    ufbxw_node_set_translation(scene, node, translation);
-                }
-                
-                // Set rotation (as quaternion)
-                ufbxw_vec4 rotation_vec4;
-                if (get_map_vec4(env, head, "rotation", &rotation_vec4)) {
-                    ufbxw_quat rotation_quat;
-                    rotation_quat.x = rotation_vec4.x;
-                    rotation_quat.y = rotation_vec4.y;
-                    rotation_quat.z = rotation_vec4.z;
-                    rotation_quat.w = rotation_vec4.w;
-                    ufbxw_node_set_rotation_quat(scene, node, rotation_quat, UFBXW_ROTATION_ORDER_XYZ);
-                }
-                
-                // Set scale
-                ufbxw_vec3 scale = {1.0, 1.0, 1.0};
-                if (get_map_vec3(env, head, "scale", &scale)) {
-                    ufbxw_node_set_scaling(scene, node, scale);
-                }
-            }
-            
-            // Store node mesh_ids for later connection
-            unsigned int *node_mesh_ids = (unsigned int*)enif_alloc(sizeof(unsigned int) * nodes_len);
-            for (unsigned int i = 0; i < nodes_len; i++) {
-                node_mesh_ids[i] = 0; // 0 = no mesh
-            }
-            
-            // Set parent-child relationships and collect mesh_ids
-            tail = nodes_list;
-            for (unsigned int i = 0; i < nodes_len; i++) {
-                if (!enif_get_list_cell(env, tail, &head, &tail)) break;
-                
-                // Get parent_id
-                unsigned int parent_id;
-                if (get_map_uint(env, head, "parent_id", &parent_id)) {
-                    // Find parent node
-                    for (unsigned int j = 0; j < nodes_len; j++) {
-                        if (node_ids[j] == parent_id) {
-                            ufbxw_node_set_parent(scene, node_handles[i], node_handles[j]);
-                            break;
-                        }
-                    }
-                }
-                
-                // Get mesh_id for later connection
-                unsigned int mesh_id;
-                if (get_map_uint(env, head, "mesh_id", &mesh_id)) {
-                    node_mesh_ids[i] = mesh_id;
-                }
-            }
-            
-            // Parse meshes first (need mesh handles to connect to nodes)
-            ERL_NIF_TERM meshes_list;
-            ufbxw_mesh *mesh_handles = NULL;
-            unsigned int *mesh_ids = NULL;
-            unsigned int meshes_len = 0;
-            
-            if (get_map_list(env, scene_data_map, "meshes", &meshes_list)) {
-                if (enif_get_list_length(env, meshes_list, &meshes_len)) {
-                    mesh_handles = (ufbxw_mesh*)enif_alloc(sizeof(ufbxw_mesh) * meshes_len);
-                    mesh_ids = (unsigned int*)enif_alloc(sizeof(unsigned int) * meshes_len);
-                    
-                    ERL_NIF_TERM head, tail = meshes_list;
-                    for (unsigned int i = 0; i < meshes_len; i++) {
-                if (!enif_get_list_cell(env, tail, &head, &tail)) break;
-                
-                // Create mesh
-                ufbxw_mesh mesh = ufbxw_create_mesh(scene);
-                mesh_handles[i] = mesh;
-                
-                // Get mesh ID
-                unsigned int mesh_id;
-                if (get_map_uint(env, head, "id", &mesh_id)) {
-                    mesh_ids[i] = mesh_id;
-                }
-                
-                // Set name
-                char *name_str;
-                size_t name_len;
-                if (get_map_string(env, head, "name", &name_str, &name_len)) {
-                    ufbxw_set_name_len(scene, mesh.id, name_str, name_len);
-                }
-                
-                // Set vertices
-                // Positions are flattened list [x1, y1, z1, x2, y2, z2, ...]
-                ERL_NIF_TERM positions_list;
-                if (get_map_list(env, head, "positions", &positions_list)) {
-                    unsigned int positions_len;
-                    if (enif_get_list_length(env, positions_list, &positions_len)) {
-                        size_t vertex_count = positions_len / 3;
-                        if (vertex_count > 0 && positions_len % 3 == 0) {
-                            ufbxw_vec3 *vertices = (ufbxw_vec3*)enif_alloc(sizeof(ufbxw_vec3) * vertex_count);
-                            
-                            ERL_NIF_TERM pos_head, pos_tail = positions_list;
-                            for (size_t v = 0; v < vertex_count; v++) {
-                                double x = 0.0, y = 0.0, z = 0.0;
-                                // Get x
-                                if (enif_get_list_cell(env, pos_tail, &pos_head, &pos_tail)) {
-                                    enif_get_double(env, pos_head, &x);
-                                }
-                                // Get y
-                                if (enif_get_list_cell(env, pos_tail, &pos_head, &pos_tail)) {
-                                    enif_get_double(env, pos_head, &y);
-                                }
-                                // Get z
-                                if (enif_get_list_cell(env, pos_tail, &pos_head, &pos_tail)) {
-                                    enif_get_double(env, pos_head, &z);
-                                }
-                                vertices[v].x = x;
-                                vertices[v].y = y;
-                                vertices[v].z = z;
-                            }
-                            
-                            ufbxw_vec3_buffer vertices_buf = ufbxw_copy_vec3_array(scene, vertices, vertex_count);
-                            ufbxw_mesh_set_vertices(scene, mesh, vertices_buf);
-                            
-                            enif_free(vertices);
-                        }
-                    }
-                }
-                
-                // Set indices/triangles
-                ERL_NIF_TERM indices_list;
-                if (get_map_list(env, head, "indices", &indices_list)) {
-                    unsigned int indices_len;
-                    if (enif_get_list_length(env, indices_list, &indices_len)) {
-                        int32_t *indices = (int32_t*)enif_alloc(sizeof(int32_t) * indices_len);
-                        
-                        ERL_NIF_TERM idx_head, idx_tail = indices_list;
-                        for (unsigned int j = 0; j < indices_len; j++) {
-                            if (!enif_get_list_cell(env, idx_tail, &idx_head, &idx_tail)) break;
-                            unsigned int idx_val;
-                            if (enif_get_uint(env, idx_head, &idx_val)) {
-                                indices[j] = (int32_t)idx_val;
-                            }
-                        }
-                        
-                        ufbxw_int_buffer indices_buf = ufbxw_copy_int_array(scene, indices, indices_len);
-                        ufbxw_mesh_set_triangles(scene, mesh, indices_buf);
-                        
-                        enif_free(indices);
-                    }
-                }
-                
-                // Set normals
-                // Normals are flattened list [nx1, ny1, nz1, nx2, ny2, nz2, ...]
-                ERL_NIF_TERM normals_list;
-                if (get_map_list(env, head, "normals", &normals_list)) {
-                    unsigned int normals_len;
-                    if (enif_get_list_length(env, normals_list, &normals_len)) {
-                        size_t normal_count = normals_len / 3;
-                        if (normal_count > 0 && normals_len % 3 == 0) {
-                            ufbxw_vec3 *normals = (ufbxw_vec3*)enif_alloc(sizeof(ufbxw_vec3) * normal_count);
-                            
-                            ERL_NIF_TERM norm_head, norm_tail = normals_list;
-                            for (size_t n = 0; n < normal_count; n++) {
-                                double x = 0.0, y = 0.0, z = 1.0;
-                                // Get x
-                                if (enif_get_list_cell(env, norm_tail, &norm_head, &norm_tail)) {
-                                    enif_get_double(env, norm_head, &x);
-                                }
-                                // Get y
-                                if (enif_get_list_cell(env, norm_tail, &norm_head, &norm_tail)) {
-                                    enif_get_double(env, norm_head, &y);
-                                }
-                                // Get z
-                                if (enif_get_list_cell(env, norm_tail, &norm_head, &norm_tail)) {
-                                    enif_get_double(env, norm_head, &z);
-                                }
-                                normals[n].x = x;
-                                normals[n].y = y;
-                                normals[n].z = z;
-                            }
-                            
-                            ufbxw_vec3_buffer normals_buf = ufbxw_copy_vec3_array(scene, normals, normal_count);
-                            ufbxw_mesh_set_normals(scene, mesh, normals_buf, UFBXW_ATTRIBUTE_MAPPING_VERTEX);
-                            
-                            enif_free(normals);
-                        }
-                    }
-                }
-                
-                // Set UVs
-                // Texcoords are flattened list [u1, v1, u2, v2, ...]
-                ERL_NIF_TERM texcoords_list;
-                if (get_map_list(env, head, "texcoords", &texcoords_list)) {
-                    unsigned int texcoords_len;
-                    if (enif_get_list_length(env, texcoords_list, &texcoords_len)) {
-                        size_t uv_count = texcoords_len / 2;
-                        if (uv_count > 0 && texcoords_len % 2 == 0) {
-                            ufbxw_vec2 *uvs = (ufbxw_vec2*)enif_alloc(sizeof(ufbxw_vec2) * uv_count);
-                            
-                            ERL_NIF_TERM uv_head, uv_tail = texcoords_list;
-                            for (size_t u = 0; u < uv_count; u++) {
-                                double u_val = 0.0, v_val = 0.0;
-                                // Get u
-                                if (enif_get_list_cell(env, uv_tail, &uv_head, &uv_tail)) {
-                                    enif_get_double(env, uv_head, &u_val);
-                                }
-                                // Get v
-                                if (enif_get_list_cell(env, uv_tail, &uv_head, &uv_tail)) {
-                                    enif_get_double(env, uv_head, &v_val);
-                                }
-                                uvs[u].x = u_val;
-                                uvs[u].y = v_val;
-                            }
-                            
-                            ufbxw_vec2_buffer uvs_buf = ufbxw_copy_vec2_array(scene, uvs, uv_count);
-                            ufbxw_mesh_set_uvs(scene, mesh, 0, uvs_buf, UFBXW_ATTRIBUTE_MAPPING_VERTEX);
-                            
-                            enif_free(uvs);
-                        }
-                    }
-                }
-                }
-            }
-            }
-            
-            // Connect meshes to nodes
-            if (mesh_handles && node_handles) {
-                for (unsigned int i = 0; i < nodes_len; i++) {
-                    if (node_mesh_ids[i] != 0) {
-                        // Find mesh with matching ID
-                        for (unsigned int j = 0; j < meshes_len; j++) {
-                            if (mesh_ids[j] == node_mesh_ids[i]) {
-                                // Connect mesh to node
-                                ufbxw_node_set_attribute(scene, node_handles[i], mesh_handles[j].id);
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-            
-            if (mesh_handles) enif_free(mesh_handles);
-            if (mesh_ids) enif_free(mesh_ids);
-            enif_free(node_mesh_ids);
-            enif_free(node_handles);
-            enif_free(node_ids);
+    tail = nodes_list;
+    for (unsigned int i = 0; i < nodes_len; i++) {
+        if (!enif_get_list_cell(env, tail, &head, &tail)) break;
+        
+        // Create node
+        ufbxw_node node = ufbxw_create_node(scene);
+        node_handles[i] = node;
+        if (get_map_uint(env, head, atom_id, &id)) {
+            id_table_insert(&table, UFBXW_ELEMENT_NODE, id, node.id, head);
         }
-    } else {
-        // No nodes, but still parse meshes
-        ERL_NIF_TERM meshes_list;
-        if (get_map_list(env, scene_data_map, "meshes", &meshes_list)) {
-            unsigned int meshes_len;
-            if (enif_get_list_length(env, meshes_list, &meshes_len)) {
-                ufbxw_mesh *mesh_handles = (ufbxw_mesh*)enif_alloc(sizeof(ufbxw_mesh) * meshes_len);
-                unsigned int *mesh_ids = (unsigned int*)enif_alloc(sizeof(unsigned int) * meshes_len);
-                
-                ERL_NIF_TERM head, tail = meshes_list;
-                for (unsigned int i = 0; i < meshes_len; i++) {
-                    if (!enif_get_list_cell(env, tail, &head, &tail)) break;
-                    
-                    // Create mesh
-                    ufbxw_mesh mesh = ufbxw_create_mesh(scene);
-                    mesh_handles[i] = mesh;
-                    
-                    // Get mesh ID
-                    unsigned int mesh_id;
-                    if (get_map_uint(env, head, "id", &mesh_id)) {
-                        mesh_ids[i] = mesh_id;
-                    }
-                    
-                    // Set name
-                    char *name_str;
-                    size_t name_len;
-                    if (get_map_string(env, head, "name", &name_str, &name_len)) {
-                        ufbxw_set_name_len(scene, mesh.id, name_str, name_len);
-                    }
-                    
-                    // Set vertices (same code as above)
-                    ERL_NIF_TERM positions_list;
-                    if (get_map_list(env, head, "positions", &positions_list)) {
-                        unsigned int positions_len;
-                        if (enif_get_list_length(env, positions_list, &positions_len)) {
-                            size_t vertex_count = positions_len / 3;
-                            if (vertex_count > 0 && positions_len % 3 == 0) {
-                                ufbxw_vec3 *vertices = (ufbxw_vec3*)enif_alloc(sizeof(ufbxw_vec3) * vertex_count);
-                                
-                                ERL_NIF_TERM pos_head, pos_tail = positions_list;
-                                for (size_t v = 0; v < vertex_count; v++) {
-                                    double x = 0.0, y = 0.0, z = 0.0;
-                                    if (enif_get_list_cell(env, pos_tail, &pos_head, &pos_tail)) {
-                                        enif_get_double(env, pos_head, &x);
-                                    }
-                                    if (enif_get_list_cell(env, pos_tail, &pos_head, &pos_tail)) {
-                                        enif_get_double(env, pos_head, &y);
-                                    }
-                                    if (enif_get_list_cell(env, pos_tail, &pos_head, &pos_tail)) {
-                                        enif_get_double(env, pos_head, &z);
-                                    }
-                                    vertices[v].x = x;
-                                    vertices[v].y = y;
-                                    vertices[v].z = z;
-                                }
-                                
-                                ufbxw_vec3_buffer vertices_buf = ufbxw_copy_vec3_array(scene, vertices, vertex_count);
-                                ufbxw_mesh_set_vertices(scene, mesh, vertices_buf);
-                                
-                                enif_free(vertices);
-                            }
-                        }
-                    }
-                    
-                    // Set indices
-                    ERL_NIF_TERM indices_list;
-                    if (get_map_list(env, head, "indices", &indices_list)) {
-                        unsigned int indices_len;
-                        if (enif_get_list_length(env, indices_list, &indices_len)) {
-                            int32_t *indices = (int32_t*)enif_alloc(sizeof(int32_t) * indices_len);
-                            
-                            ERL_NIF_TERM idx_head, idx_tail = indices_list;
-                            for (unsigned int j = 0; j < indices_len; j++) {
-                                if (!enif_get_list_cell(env, idx_tail, &idx_head, &idx_tail)) break;
-                                unsigned int idx_val;
-                                if (enif_get_uint(env, idx_head, &idx_val)) {
-                                    indices[j] = (int32_t)idx_val;
-                                }
-                            }
-                            
-                            ufbxw_int_buffer indices_buf = ufbxw_copy_int_array(scene, indices, indices_len);
-                            ufbxw_mesh_set_triangles(scene, mesh, indices_buf);
-                            
-                            enif_free(indices);
-                        }
-                    }
-                }
-                
-                enif_free(mesh_handles);
-                enif_free(mesh_ids);
-            }
+        
+        // Set name
+        char *name_str;
+        size_t name_len;
+        if (get_map_string(env, head, atom_name, &name_str, &name_len)) {
+            ufbxw_set_name_len(scene, node.id, name_str, name_len);
+        }
+        
+        // Set translation
+        ufbxw_vec3 translation = {0.0, 0.0, 0.0};
+        if (get_map_vec3(env, head, atom_translation, &translation)) {
+            ufbxw_node_set_translation(scene, node, translation);
+        }
+        
+        // Set rotation (as quaternion)
+        ufbxw_vec4 rotation_vec4;
+        if (get_map_vec4(env, head, atom_rotation, &rotation_vec4)) {
+            ufbxw_quat rotation_quat;
+            rotation_quat.x = rotation_vec4.x;
+            rotation_quat.y = rotation_vec4.y;
+            rotation_quat.z = rotation_vec4.z;
+            rotation_quat.w = rotation_vec4.w;
+            ufbxw_node_set_rotation_quat(scene, node, rotation_quat, UFBXW_ROTATION_ORDER_XYZ);
+        }
+        
+        // Set scale
+        ufbxw_vec3 scale = {1.0, 1.0, 1.0};
+        if (get_map_vec3(env, head, atom_scale, &scale)) {
+            ufbxw_node_set_scaling(scene, node, scale);
+        }
+    }
+    
+    // Parse meshes
+    tail = meshes_list;
+    for (unsigned int i = 0; i < meshes_len; i++) {
+        if (!enif_get_list_cell(env, tail, &head, &tail)) break;
+        
+        ufbxw_mesh mesh = build_ufbxw_mesh(env, scene, head);
+        if (get_map_uint(env, head, atom_id, &id)) {
+            id_table_insert(&table, UFBXW_ELEMENT_MESH, id, mesh.id, head);
         }
     }
     
     // Parse materials (basic support)
-    ERL_NIF_TERM materials_list;
-    if (get_map_list(env, scene_data_map, "materials", &materials_list)) {
-        unsigned int materials_len;
-        if (enif_get_list_length(env, materials_list, &materials_len)) {
-            ERL_NIF_TERM head, tail = materials_list;
-            for (unsigned int i = 0; i < materials_len; i++) {
-                if (!enif_get_list_cell(env, tail, &head, &tail)) break;
-                
-                // Create material element
-                ufbxw_id material_id = ufbxw_create_element(scene, UFBXW_ELEMENT_MATERIAL);
-                
-                // Set name
-                char *name_str;
-                size_t name_len;
-                if (get_map_string(env, head, "name", &name_str, &name_len)) {
-                    ufbxw_set_name_len(scene, material_id, name_str, name_len);
-                }
-                
-                // Set diffuse color
-                ufbxw_vec3 diffuse = {1.0, 1.0, 1.0};
-                if (get_map_vec3(env, head, "diffuse_color", &diffuse)) {
-                    ufbxw_set_vec3(scene, material_id, "DiffuseColor", diffuse);
-                }
+    tail = materials_list;
+    for (unsigned int i = 0; i < materials_len; i++) {
+        if (!enif_get_list_cell(env, tail, &head, &tail)) break;
+        
+        // Create material element
+        ufbxw_id material_id = ufbxw_create_element(scene, UFBXW_ELEMENT_MATERIAL);
+        if (get_map_uint(env, head, atom_id, &id)) {
+            id_table_insert(&table, UFBXW_ELEMENT_MATERIAL, id, material_id, head);
+        }
+        
+        // Set name
+        char *name_str;
+        size_t name_len;
+        if (get_map_string(env, head, atom_name, &name_str, &name_len)) {
+            ufbxw_set_name_len(scene, material_id, name_str, name_len);
+        }
+        
+        // Set diffuse color
+        ufbxw_vec3 diffuse = {1.0, 1.0, 1.0};
+        if (get_map_vec3(env, head, atom_diffuse_color, &diffuse)) {
+            ufbxw_set_vec3(scene, material_id, "DiffuseColor", diffuse);
+        }
+    }
+    
+    // Resolve parent and mesh references now that every element exists
+    tail = nodes_list;
+    for (unsigned int i = 0; i < nodes_len; i++) {
+        if (!enif_get_list_cell(env, tail, &head, &tail)) break;
+        
+        if (get_map_uint(env, head, atom_parent_id, &id)) {
+            const id_table_entry *parent = id_table_find(&table, UFBXW_ELEMENT_NODE, id);
+            if (parent) {
+                ufbxw_node parent_node = { parent->element };
+                ufbxw_node_set_parent(scene, node_handles[i], parent_node);
+            }
+        }
+        
+        if (get_map_uint(env, head, atom_mesh_id, &id)) {
+            const id_table_entry *mesh = id_table_find(&table, UFBXW_ELEMENT_MESH, id);
+            if (mesh) {
+                attach_ufbxw_mesh(env, scene, &table, node_handles[i], mesh);
             }
         }
     }
     
+    enif_free(table.entries);
+    enif_free(node_handles);
     return scene;
 }
 
+// Read a NaiveDateTime-shaped map (year, month, day, hour, minute, second and
+// a {microseconds, precision} tuple) into a ufbxw timestamp
+static int get_datetime(ErlNifEnv* env, ERL_NIF_TERM term, ufbxw_datetime *out) {
+    ERL_NIF_TERM keys[6] = { atom_year, atom_month, atom_day, atom_hour, atom_minute, atom_second };
+    int32_t *fields[6] = { &out->year, &out->month, &out->day, &out->hour, &out->minute, &out->second };
+    ERL_NIF_TERM value;
+    for (int i = 0; i < 6; i++) {
+        int field;
+        if (!enif_get_map_value(env, term, keys[i], &value) || !enif_get_int(env, value, &field)) {
+            return 0;
+        }
+        *fields[i] = field;
+    }
+    
+    out->millisecond = 0;
+    int arity;
+    const ERL_NIF_TERM *microsecond;
+    int us;
+    if (enif_get_map_value(env, term, atom_microsecond, &value) &&
+        enif_get_tuple(env, value, &arity, &microsecond) && arity == 2 &&
+        enif_get_int(env, microsecond[0], &us)) {
+        out->millisecond = us / 1000;
+    }
+    return 1;
+}
+
+// Save options shared by write_fbx/3 and write_fbx_binary/2. The file
+// timestamp comes from the scene's `creation_time`, or the wall clock
+static ufbxw_save_opts make_save_opts(ErlNifEnv* env, ERL_NIF_TERM scene_data_map, ERL_NIF_TERM format_atom)
+{
+    ufbxw_save_opts opts = {0};
+    opts.format = UFBXW_SAVE_FORMAT_BINARY;
+    if (enif_is_identical(format_atom, atom_ascii)) {
+        opts.format = UFBXW_SAVE_FORMAT_ASCII;
+    }
+    opts.version = 7400; // FBX 7.4
+    
+    ERL_NIF_TERM creation_time;
+    if (enif_get_map_value(env, scene_data_map, atom_creation_time, &creation_time) &&
+        get_datetime(env, creation_time, &opts.local_timestamp)) {
+        opts.no_default_timestamp = true;
+    }
+    return opts;
+}
+
+static ERL_NIF_TERM make_save_error(ErlNifEnv* env, const ufbxw_error *error)
+{
+    char error_msg[256];
+    // ufbxw_error.description is a char array, not a struct with .data
+    // Ensure null termination and handle truncation safely
+    int written = snprintf(error_msg, sizeof(error_msg), "Failed to save FBX: %s",
+                           error->description);
+    if (written >= (int)sizeof(error_msg)) {
+        error_msg[sizeof(error_msg) - 1] = '\0';
+    }
+    return enif_make_tuple2(env,
+        atom_error,
+        enif_make_string(env, error_msg, ERL_NIF_LATIN1));
+}
+
 // Write FBX file NIF
-static ERL_NIF_TERM write_fbx_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+static ERL_NIF_TERM write_fbx_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
 {
     ErlNifBinary file_path_bin;
     ERL_NIF_TERM scene_data_map;
-    ERL_NIF_TERM format_atom;
     ufbxw_error error = {0};
     ufbxw_scene *scene;
     
@@ -1161,9 +5997,6 @@ static ERL_NIF_TERM write_fbx_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM a
     
     scene_data_map = argv[1];
     
-    // Get format (binary or ascii)
-    format_atom = argv[2];
-    
     // Null-terminate file path
     char file_path[file_path_bin.size + 1];
     memcpy(file_path, file_path_bin.data, file_path_bin.size);
@@ -1173,54 +6006,312 @@ static ERL_NIF_TERM write_fbx_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM a
     scene = build_ufbxw_scene_from_map(env, scene_data_map);
     if (!scene) {
         return enif_make_tuple2(env,
-            enif_make_atom(env, "error"),
+            atom_error,
             enif_make_string(env, "Failed to create ufbxw_scene", ERL_NIF_LATIN1));
     }
     
-    // Determine format
-    ufbxw_save_format format = UFBXW_SAVE_FORMAT_BINARY;
-    char atom_buf[256];
-    if (enif_get_atom(env, format_atom, atom_buf, sizeof(atom_buf), ERL_NIF_LATIN1)) {
-        if (strcmp(atom_buf, "ascii") == 0) {
-            format = UFBXW_SAVE_FORMAT_ASCII;
-        }
-    }
-    
-    // Save options
-    ufbxw_save_opts opts = {0};
-    opts.format = format;
-    opts.version = 7400; // FBX 7.4
-    
     // Save file
+    ufbxw_save_opts opts = make_save_opts(env, scene_data_map, argv[2]);
     bool success = ufbxw_save_file(scene, file_path, &opts, &error);
     
     // Free scene
     ufbxw_free_scene(scene);
     
     if (!success) {
-        char error_msg[256];
-        // ufbxw_error.description is a char array, not a struct with .data
-        // Ensure null termination and handle truncation safely
-        int written = snprintf(error_msg, sizeof(error_msg), "Failed to save FBX: %s", 
-                               error.description);
-        if (written >= (int)sizeof(error_msg)) {
-            error_msg[sizeof(error_msg) - 1] = '\0';
-        }
-        return enif_make_tuple2(env,
-            enif_make_atom(env, "error"),
-            enif_make_string(env, error_msg, ERL_NIF_LATIN1));
+        return make_save_error(env, &error);
     }
     
     // Return success
     return enif_make_tuple2(env,
-        enif_make_atom(env, "ok"),
+        atom_ok,
         enif_make_string(env, file_path, ERL_NIF_LATIN1));
 }
 
+// In-memory target for ufbxw_save_stream(). The writer emits data at file
+// offsets and may flush later chunks before earlier ones while it resolves
+// node offsets, so the output is kept in fixed-size blocks addressed by
+// offset. The blocks are handed to the VM as-is once saving finishes.
+#define MEMORY_STREAM_BLOCK_SIZE ((size_t)1 << 20)
+
+typedef struct memory_stream {
+    ErlNifBinary *blocks;
+    size_t num_blocks;
+    size_t block_capacity;
+    uint64_t size; // One past the furthest byte written
+} memory_stream;
+
+static bool memory_stream_reserve(memory_stream *stream, size_t num_blocks)
+{
+    if (num_blocks > stream->block_capacity) {
+        size_t capacity = stream->block_capacity ? stream->block_capacity * 2 : 8;
+        while (capacity < num_blocks) capacity *= 2;
+        ErlNifBinary *blocks = enif_realloc(stream->blocks, capacity * sizeof(ErlNifBinary));
+        if (!blocks) return false;
+        stream->blocks = blocks;
+        stream->block_capacity = capacity;
+    }
+    while (stream->num_blocks < num_blocks) {
+        ErlNifBinary *block = &stream->blocks[stream->num_blocks];
+        if (!enif_alloc_binary(MEMORY_STREAM_BLOCK_SIZE, block)) return false;
+        memset(block->data, 0, block->size);
+        stream->num_blocks++;
+    }
+    return true;
+}
+
+static bool memory_stream_write(void *user, uint64_t offset, const void *data, size_t size)
+{
+    memory_stream *stream = (memory_stream*)user;
+    uint64_t end = offset + size;
+    if (!memory_stream_reserve(stream, (size_t)((end + MEMORY_STREAM_BLOCK_SIZE - 1) / MEMORY_STREAM_BLOCK_SIZE))) {
+        return false;
+    }
+    
+    const unsigned char *src = (const unsigned char*)data;
+    while (size > 0) {
+        size_t block = (size_t)(offset / MEMORY_STREAM_BLOCK_SIZE);
+        size_t pos = (size_t)(offset % MEMORY_STREAM_BLOCK_SIZE);
+        size_t len = MEMORY_STREAM_BLOCK_SIZE - pos;
+        if (len > size) len = size;
+        memcpy(stream->blocks[block].data + pos, src, len);
+        src += len;
+        offset += len;
+        size -= len;
+    }
+    
+    if (end > stream->size) stream->size = end;
+    return true;
+}
+
+static void memory_stream_free(memory_stream *stream)
+{
+    for (size_t i = 0; i < stream->num_blocks; i++) {
+        enif_release_binary(&stream->blocks[i]);
+    }
+    enif_free(stream->blocks);
+    memset(stream, 0, sizeof(*stream));
+}
+
+// Transfer the written data to the VM: a single binary if it fits in one
+// block, otherwise an iolist of the block binaries so nothing is copied again.
+static ERL_NIF_TERM memory_stream_to_iodata(ErlNifEnv* env, memory_stream *stream)
+{
+    ERL_NIF_TERM result;
+    if (stream->num_blocks == 0) {
+        enif_make_new_binary(env, 0, &result);
+        memory_stream_free(stream);
+        return result;
+    }
+    
+    // Shrink the last block to the bytes written; if that fails keep the
+    // block and cut the unused end off with a sub-binary instead
+    ErlNifBinary *last = &stream->blocks[stream->num_blocks - 1];
+    size_t tail = (size_t)(stream->size - (uint64_t)(stream->num_blocks - 1) * MEMORY_STREAM_BLOCK_SIZE);
+    int trim = tail < last->size && !enif_realloc_binary(last, tail);
+    ERL_NIF_TERM last_term = enif_make_binary(env, last);
+    if (trim) {
+        last_term = enif_make_sub_binary(env, last_term, 0, tail);
+    }
+    
+    if (stream->num_blocks == 1) {
+        result = last_term;
+    } else {
+        result = enif_make_list_cell(env, last_term, enif_make_list(env, 0));
+        for (size_t i = stream->num_blocks - 1; i > 0; i--) {
+            result = enif_make_list_cell(env, enif_make_binary(env, &stream->blocks[i - 1]), result);
+        }
+    }
+    
+    // Ownership of every block moved to the terms above
+    stream->num_blocks = 0;
+    memory_stream_free(stream);
+    return result;
+}
+
+// Write FBX to memory NIF: returns the file contents as iodata
+static ERL_NIF_TERM write_fbx_binary_dirty(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    if (argc != 2 || !enif_is_map(env, argv[0])) {
+        return enif_make_badarg(env);
+    }
+    
+    ufbxw_scene *scene = build_ufbxw_scene_from_map(env, argv[0]);
+    if (!scene) {
+        return enif_make_tuple2(env,
+            atom_error,
+            enif_make_string(env, "Failed to create ufbxw_scene", ERL_NIF_LATIN1));
+    }
+    
+    memory_stream stream = {0};
+    ufbxw_write_stream ws = {0};
+    ws.write_fn = memory_stream_write;
+    ws.user = &stream;
+    
+    ufbxw_error error = {0};
+    ufbxw_save_opts opts = make_save_opts(env, argv[0], argv[1]);
+    bool success = ufbxw_save_stream(scene, &ws, &opts, &error);
+    
+    ufbxw_free_scene(scene);
+    
+    if (!success) {
+        memory_stream_free(&stream);
+        return make_save_error(env, &error);
+    }
+    
+    return enif_make_tuple2(env, atom_ok, memory_stream_to_iodata(env, &stream));
+}
+
+// ============================================================================
+// NIF Entry Points
+// ============================================================================
+
+// Parsing and writing can take seconds for large files, so the entry points
+// below only hand the work over to the dirty CPU schedulers.
+
+static ERL_NIF_TERM load_fbx_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_cpu(env, "load_fbx", load_fbx_dirty, argc, argv);
+}
+
+static ERL_NIF_TERM load_fbx_binary_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_cpu(env, "load_fbx_binary", load_fbx_binary_dirty, argc, argv);
+}
+
+static ERL_NIF_TERM write_fbx_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_cpu(env, "write_fbx", write_fbx_dirty, argc, argv);
+}
+
+static ERL_NIF_TERM write_fbx_binary_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_cpu(env, "write_fbx_binary", write_fbx_binary_dirty, argc, argv);
+}
+
+static ERL_NIF_TERM open_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_cpu(env, "open", open_dirty, argc, argv);
+}
+
+static ERL_NIF_TERM mesh_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_cpu(env, "mesh", mesh_dirty, argc, argv);
+}
+
+static ERL_NIF_TERM anim_stack_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_cpu(env, "anim_stack", anim_stack_dirty, argc, argv);
+}
+
+static ERL_NIF_TERM bounds_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_cpu(env, "bounds", bounds_dirty, argc, argv);
+}
+
+static ERL_NIF_TERM evaluate_skinning_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_cpu(env, "evaluate_skinning", evaluate_skinning_dirty, argc, argv);
+}
+
+static ERL_NIF_TERM bake_vertex_animation_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_cpu(env, "bake_vertex_animation", bake_vertex_animation_dirty, argc, argv);
+}
+
+static ERL_NIF_TERM open_geometry_cache_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_io(env, "open_geometry_cache", open_geometry_cache_dirty, argc, argv);
+}
+
+static ERL_NIF_TERM read_geometry_cache_frame_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_io(env, "read_geometry_cache_frame", read_geometry_cache_frame_dirty, argc, argv);
+}
+
+static ERL_NIF_TERM sample_geometry_cache_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_io(env, "sample_geometry_cache", sample_geometry_cache_dirty, argc, argv);
+}
+
+static ERL_NIF_TERM evaluate_blend_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
+{
+    return schedule_dirty_cpu(env, "evaluate_blend", evaluate_blend_dirty, argc, argv);
+}
+
+// Load callback: open resource types and read options from the `load_info` map
+static int nif_load(ErlNifEnv* env, void** priv_data, ERL_NIF_TERM load_info)
+{
+    (void)priv_data;  // Unused parameter
+    
+    init_atoms(env);
+    
+    scene_resource_type = enif_open_resource_type(env, NULL, "ufbx_scene",
+        scene_resource_dtor, ERL_NIF_RT_CREATE, NULL);
+    if (!scene_resource_type) {
+        return 1;
+    }
+    cache_resource_type = enif_open_resource_type(env, NULL, "ufbx_geometry_cache",
+        cache_resource_dtor, ERL_NIF_RT_CREATE, NULL);
+    if (!cache_resource_type) {
+        return 1;
+    }
+    
+    ERL_NIF_TERM value;
+    if (enif_is_map(env, load_info) &&
+        enif_get_map_value(env, load_info, atom_dirty_schedulers, &value)) {
+        use_dirty_schedulers = enif_is_identical(value, atom_false) ? 0 : 1;
+    }
+    
+    // load_info carries one thread per dirty CPU scheduler. Without it, fall
+    // back to the scheduler count, which is what the dirty CPU scheduler
+    // count defaults to (the NIF API does not expose the latter)
+    ErlNifSysInfo sys_info;
+    enif_system_info(&sys_info, sizeof(sys_info));
+    size_t pool_size = (size_t)sys_info.scheduler_threads;
+    if (enif_is_map(env, load_info)) {
+        get_opt_size(env, load_info, atom_thread_pool_size, &pool_size);
+        get_opt_size(env, load_info, atom_thread_num_tasks, &thread_num_tasks);
+        get_opt_size(env, load_info, atom_thread_memory_limit, &thread_memory_limit);
+    }
+    if (pool_size > 0 && !thread_pool) {
+        ufbx_os_thread_pool_opts pool_opts = { 0 };
+        pool_opts.max_threads = pool_size;
+        thread_pool = ufbx_os_create_thread_pool(&pool_opts);
+    }
+    
+    return 0;
+}
+
+static void nif_unload(ErlNifEnv* env, void* priv_data)
+{
+    (void)env;  // Unused parameter
+    (void)priv_data;  // Unused parameter
+    
+    ufbx_os_free_thread_pool(thread_pool);
+    thread_pool = NULL;
+}
+
 static ErlNifFunc nif_funcs[] = {
-    {"load_fbx", 1, load_fbx_nif, 0},
-    {"load_fbx_binary", 1, load_fbx_binary_nif, 0},
-    {"write_fbx", 3, write_fbx_nif, 0}
+    {"load_fbx", 2, load_fbx_nif, 0},
+    {"load_fbx_binary", 2, load_fbx_binary_nif, 0},
+    {"write_fbx", 3, write_fbx_nif, 0},
+    {"write_fbx_binary", 2, write_fbx_binary_nif, 0},
+    {"open", 2, open_nif, 0},
+    {"scene_info", 1, scene_info_nif, 0},
+    {"node", 2, node_nif, 0},
+    {"mesh", 3, mesh_nif, 0},
+    {"material", 2, material_nif, 0},
+    {"texture", 2, texture_nif, 0},
+    {"anim_stack", 3, anim_stack_nif, 0},
+    {"bounds", 2, bounds_nif, 0},
+    {"evaluate_skinning", 5, evaluate_skinning_nif, 0},
+    {"evaluate_blend", 3, evaluate_blend_nif, 0},
+    {"bake_vertex_animation", 4, bake_vertex_animation_nif, 0},
+    {"open_geometry_cache", 2, open_geometry_cache_nif, 0},
+    {"geometry_cache", 2, geometry_cache_nif, 0},
+    {"geometry_cache_info", 1, geometry_cache_info_nif, 0},
+    {"read_geometry_cache_frame", 4, read_geometry_cache_frame_nif, 0},
+    {"sample_geometry_cache", 4, sample_geometry_cache_nif, 0}
 };
 
-ERL_NIF_INIT(Elixir.AriaFbx.Nif, nif_funcs, NULL, NULL, NULL, NULL)
+ERL_NIF_INIT(Elixir.AriaFbx.Nif, nif_funcs, nif_load, NULL, NULL, nif_unload)
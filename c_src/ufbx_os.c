@@ -0,0 +1,11 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (c) 2025-present K. S. Ernest (iFire) Lee
+ */
+
+// Implementation of the thread pool bundled with ufbx (extra/ufbx_os.h).
+// Kept in its own translation unit as it needs POSIX threads and semaphores.
+
+#include "ufbx.h"
+
+#define UFBX_OS_IMPLEMENTATION
+#include "ufbx_os.h"
@@ -1,5 +1,13 @@
 import Config
 
+# Run load_fbx/load_fbx_binary/write_fbx on the dirty CPU schedulers.
+# Set to false to run them on the calling scheduler (only sensible for tiny files).
+config :aria_fbx, dirty_schedulers: true
+
+# Native thread pool used by ufbx to parse large arrays in parallel.
+# Defaults to one thread per dirty CPU scheduler; 0 disables it.
+# config :aria_fbx, thread_pool_size: 16, thread_num_tasks: 2048, thread_memory_limit: 32_000_000
+
 # Pythonx configuration for uv-based Python dependency management
 # This initializes Pythonx with the pyproject.toml configuration at compile time
 # ufbx-python is installed from git repository
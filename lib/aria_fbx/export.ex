@@ -42,6 +42,8 @@ defmodule AriaFbx.Export do
   @doc """
   Exports an FBXDocument to binary data.
 
+  The file is written in memory; no temporary file is involved.
+
   ## Options
 
   - `:format` - FBX format: `:binary` (default) or `:ascii`
@@ -53,37 +55,44 @@ defmodule AriaFbx.Export do
   """
   @spec to_binary(Document.t(), keyword()) :: {:ok, binary()} | {:error, term()}
   def to_binary(%Document{} = document, opts \\ []) do
-    format = Keyword.get(opts, :format, :binary)
-    version = Keyword.get(opts, :version, document.version)
-
-    # For binary export, we'll write to a temporary file and read it back
-    {:ok, temp_file} = Briefly.create(extname: ".fbx")
-
-    try do
-      case to_file(document, temp_file, format: format, version: version) do
-        {:ok, _} ->
-          case File.read(temp_file) do
-            {:ok, binary_data} -> {:ok, binary_data}
-            {:error, reason} -> {:error, "Failed to read exported FBX: #{inspect(reason)}"}
-          end
-
-        error ->
-          error
-      end
-    after
-      File.rm(temp_file)
+    case to_iodata(document, opts) do
+      {:ok, iodata} -> {:ok, IO.iodata_to_binary(iodata)}
+      error -> error
     end
   end
 
-  # Build scene data structure for ufbx_write from FBXDocument
+  @doc """
+  Exports an FBXDocument to iodata.
+
+  Like `to_binary/2`, but large files are returned as a list of binary
+  chunks straight from the writer, which can be passed to `File.write/2`
+  or a socket without joining them first.
+
+  ## Examples
+
+      {:ok, iodata} = AriaFbx.Export.to_iodata(document)
+      :ok = File.write("/path/to/output.fbx", iodata)
+  """
+  @spec to_iodata(Document.t(), keyword()) :: {:ok, iodata()} | {:error, term()}
+  def to_iodata(%Document{} = document, opts \\ []) do
+    format = Keyword.get(opts, :format, :binary)
+    _version = Keyword.get(opts, :version, document.version)
+
+    document
+    |> build_scene_data_for_write()
+    |> Nif.write_fbx_binary(format)
+  end
+
+  # Build scene data structure for ufbx_write from FBXDocument. The NIF reads
+  # atom keys only; string keys are ignored.
   defp build_scene_data_for_write(%Document{} = document) do
     %{
-      "version" => document.version,
-      "nodes" => encode_nodes_for_write(document.nodes),
-      "meshes" => encode_meshes_for_write(document.meshes),
-      "materials" => encode_materials_for_write(document.materials),
-      "textures" => encode_textures_for_write(document.textures),
-      "animations" => encode_animations_for_write(document.animations)
+      version: document.version,
+      nodes: encode_nodes_for_write(document.nodes),
+      meshes: encode_meshes_for_write(document.meshes),
+      materials: encode_materials_for_write(document.materials),
+      textures: encode_textures_for_write(document.textures),
+      animations: encode_animations_for_write(document.animations)
     }
   end
 
@@ -92,14 +101,14 @@ defmodule AriaFbx.Export do
   defp encode_nodes_for_write(nodes) when is_list(nodes) do
     Enum.map(nodes, fn node ->
       %{
-        "id" => node.id,
-        "name" => node.name || "",
-        "parent_id" => node.parent_id,
-        "children" => node.children || [],
-        "translation" => encode_vec3(node.translation),
-        "rotation" => encode_vec4(node.rotation),
-        "scale" => encode_vec3(node.scale),
-        "mesh_id" => node.mesh_id
+        id: node.id,
+        name: node.name || "",
+        parent_id: node.parent_id,
+        children: node.children || [],
+        translation: encode_vec3(node.translation),
+        rotation: encode_vec4(node.rotation),
+        scale: encode_vec3(node.scale),
+        mesh_id: node.mesh_id
       }
     end)
   end
@@ -109,13 +118,14 @@ defmodule AriaFbx.Export do
   defp encode_meshes_for_write(meshes) when is_list(meshes) do
     Enum.map(meshes, fn mesh ->
       %{
-        "id" => mesh.id,
-        "name" => mesh.name,
-        "positions" => flatten_positions(mesh.positions),
-        "normals" => flatten_normals(mesh.normals),
-        "texcoords" => flatten_texcoords(mesh.texcoords),
-        "indices" => mesh.indices || [],
-        "material_ids" => mesh.material_ids || []
+        id: mesh.id,
+        name: mesh.name || "",
+        positions: encode_attribute(mesh.positions, &flatten_positions/1),
+        normals: encode_attribute(mesh.normals, &flatten_normals/1),
+        texcoords: encode_attribute(mesh.texcoords, &flatten_texcoords/1),
+        indices: mesh.indices || [],
+        layout: mesh.layout,
+        material_ids: mesh.material_ids || []
       }
     end)
   end
@@ -125,11 +135,11 @@ defmodule AriaFbx.Export do
   defp encode_materials_for_write(materials) when is_list(materials) do
     Enum.map(materials, fn material ->
       %{
-        "id" => material.id,
-        "name" => material.name,
-        "diffuse_color" => encode_vec3(material.diffuse_color),
-        "specular_color" => encode_vec3(material.specular_color),
-        "emissive_color" => encode_vec3(material.emissive_color)
+        id: material.id,
+        name: material.name || "",
+        diffuse_color: encode_vec3(material.diffuse_color),
+        specular_color: encode_vec3(material.specular_color),
+        emissive_color: encode_vec3(material.emissive_color)
       }
     end)
   end
@@ -139,9 +149,9 @@ defmodule AriaFbx.Export do
   defp encode_textures_for_write(textures) when is_list(textures) do
     Enum.map(textures, fn texture ->
       %{
-        "id" => texture.id,
-        "name" => texture.name,
-        "file_path" => texture.file_path
+        id: texture.id,
+        name: texture.name || "",
+        file_path: texture.file_path
       }
     end)
   end
@@ -151,10 +161,10 @@ defmodule AriaFbx.Export do
   defp encode_animations_for_write(animations) when is_list(animations) do
     Enum.map(animations, fn animation ->
       %{
-        "id" => animation.id,
-        "name" => animation.name,
-        "node_id" => animation.node_id,
-        "keyframes" => encode_keyframes(animation.keyframes)
+        id: animation.id,
+        name: animation.name || "",
+        node_id: animation.node_id,
+        keyframes: encode_keyframes(animation.keyframes)
       }
     end)
   end
@@ -164,10 +174,10 @@ defmodule AriaFbx.Export do
   defp encode_keyframes(keyframes) when is_list(keyframes) do
     Enum.map(keyframes, fn keyframe ->
       %{
-        "time" => keyframe.time,
-        "translation" => encode_vec3(keyframe.translation),
-        "rotation" => encode_vec4(keyframe.rotation),
-        "scale" => encode_vec3(keyframe.scale)
+        time: keyframe.time,
+        translation: encode_vec3(keyframe.translation),
+        rotation: encode_vec4(keyframe.rotation),
+        scale: encode_vec3(keyframe.scale)
       }
     end)
   end
@@ -217,4 +227,9 @@ defmodule AriaFbx.Export do
       _ -> []
     end)
   end
+
+  # Packed meshes (`mesh_format: :packed`) carry binaries, which the NIF reads
+  # directly using `layout`; only list attributes need flattening.
+  defp encode_attribute(data, _flatten) when is_binary(data), do: data
+  defp encode_attribute(data, flatten), do: flatten.(data)
 end
@@ -19,6 +19,10 @@ defmodule AriaFbx.Import do
 
   - `:validate` - Whether to validate the FBX file (default: `true`)
 
+  All other options are passed to `AriaFbx.Nif.load_fbx/2`, e.g.
+  `mesh_format: :packed` to keep vertex data as binaries, or `:anim_stacks`
+  and `:bake` to control which animation stacks are baked and how.
+
   ## Examples
 
       {:ok, document} = AriaFbx.Import.from_file("/path/to/model.fbx")
@@ -26,6 +30,16 @@ defmodule AriaFbx.Import do
 
       # Skip validation
       {:ok, document} = AriaFbx.Import.from_file("/path/to/model.fbx", validate: false)
+
+      # Geometry only, no animation loaded or baked
+      {:ok, document} = AriaFbx.Import.from_file("/path/to/model.fbx", anim_stacks: :none)
+
+      # Bake one take at 60 FPS with key reduction
+      {:ok, document} =
+        AriaFbx.Import.from_file("/path/to/model.fbx",
+          anim_stacks: ["Walk"],
+          bake: [resample_rate: 60.0, key_reduction_enabled: true]
+        )
   """
   @spec from_file(String.t(), keyword()) :: {:ok, Document.t()} | {:error, term()}
   def from_file(file_path, opts \\ []) when is_binary(file_path) do
@@ -33,7 +47,7 @@ defmodule AriaFbx.Import do
 
     # Handle pythonx errors gracefully
     try do
-      case Nif.load_fbx(file_path) do
+      case Nif.load_fbx(file_path, Keyword.delete(opts, :validate)) do
         {:ok, ufbx_data} ->
           case Parser.from_ufbx_scene(ufbx_data) do
             {:ok, document} ->
@@ -165,6 +179,8 @@ defmodule AriaFbx.Import do
 
   - `:validate` - Whether to validate the FBX file (default: `true`)
 
+  All other options are passed to `AriaFbx.Nif.load_fbx_binary/2`.
+
   ## Examples
 
       {:ok, document} = AriaFbx.Import.from_binary(binary_data)
@@ -173,7 +189,7 @@ defmodule AriaFbx.Import do
   def from_binary(binary_data, opts \\ []) when is_binary(binary_data) do
     validate? = Keyword.get(opts, :validate, true)
 
-    case Nif.load_fbx_binary(binary_data) do
+    case Nif.load_fbx_binary(binary_data, Keyword.delete(opts, :validate)) do
       {:ok, ufbx_data} ->
         case Parser.from_ufbx_scene(ufbx_data) do
           {:ok, document} ->
@@ -6,13 +6,57 @@ defmodule AriaFbx.Nif do
   C NIF bindings for ufbx FBX loading functionality.
 
   This module provides Elixir bindings to the ufbx C library via NIFs.
+
+  ## Configuration
+
+  Loading and writing FBX files runs on the dirty CPU schedulers by default,
+  so large files do not block the normal schedulers. Applications that only
+  handle tiny files can opt back into running on the calling scheduler:
+
+      config :aria_fbx, dirty_schedulers: false
+
+  ufbx decompresses and parses large arrays on a native thread pool that is
+  shared by all loads. It has one thread per dirty CPU scheduler unless
+  configured otherwise (`0` disables it):
+
+      config :aria_fbx,
+        thread_pool_size: 16,
+        # Maximum in-flight tasks and memory for batched work (ufbx defaults: 2048, 32 MB)
+        thread_num_tasks: 4096,
+        thread_memory_limit: 64 * 1024 * 1024
+
+  These settings are read once, when the NIF library is loaded. That happens
+  when this module is first loaded, which can be before the `:aria_fbx`
+  application is started, so `load_nifs/0` loads the application spec itself
+  to see `config/*.exs` values. Changing them later with `Application.put_env/3`
+  has no effect; set them with `persistent: true` before the module is loaded
+  if they must be chosen at runtime.
   """
 
   @on_load :load_nifs
 
   def load_nifs do
+    # @on_load can run before the application env is loaded; an
+    # {:error, {:already_loaded, _}} result just means it already was
+    _ = Application.load(:aria_fbx)
+
     nif_path = :filename.join(:code.priv_dir(:aria_fbx), "ufbx_nif")
-    :erlang.load_nif(nif_path, 0)
+    :erlang.load_nif(nif_path, load_info())
+  end
+
+  # Options passed to the NIF load callback
+  defp load_info do
+    %{
+      dirty_schedulers: Application.get_env(:aria_fbx, :dirty_schedulers, true),
+      thread_pool_size:
+        Application.get_env(
+          :aria_fbx,
+          :thread_pool_size,
+          :erlang.system_info(:dirty_cpu_schedulers)
+        ),
+      thread_num_tasks: Application.get_env(:aria_fbx, :thread_num_tasks, 0),
+      thread_memory_limit: Application.get_env(:aria_fbx, :thread_memory_limit, 0)
+    }
   end
 
   @doc """
@@ -21,6 +65,167 @@ defmodule AriaFbx.Nif do
   ## Parameters
 
   - `file_path`: Path to the FBX file
+  - `opts`: Keyword list of extraction options
+    - `:mesh_format` - `:lists` (default) returns vertex data as nested lists,
+      `:packed` returns positions, normals, texcoords and indices as
+      little-endian binaries described by the mesh `layout` map, `:render`
+      returns GPU-ready meshes (see "Render meshes" below)
+    - `:precision` - Float type of packed attributes: `:f64` (default) or `:f32`.
+      Packed indices are always `u32`
+    - `:animation_format` - `:keyframes` (default) returns one map per baked
+      sample, `:channels` returns per-node `channels` with a `times` binary
+      (f64) and `translation` / `rotation` / `scale` binaries sampled at those
+      times (3, 4 and 3 components in `:precision`)
+    - `:anim_stacks` - Which animation stacks to bake: `:all` (default), `:none`,
+      or a list of stack names (strings) and/or indices. `:none` also skips
+      loading animation curves (`ignore_animation`)
+    - `:bake` - Keyword list of `ufbx_bake_opts` fields: `:resample_rate`
+      (default `30.0`), `:minimum_sample_rate`, `:maximum_sample_rate`,
+      `:trim_start_time`, `:key_reduction_enabled`, `:key_reduction_rotation`,
+      `:key_reduction_threshold`, `:key_reduction_passes`, `:step_handling`
+      (`:default`, `:custom_duration`, `:identical_time`, `:adjacent_double`
+      or `:ignore`), `:step_custom_duration`, `:step_custom_epsilon`,
+      `:max_keyframe_segments`, `:bake_transform_props`, `:skip_node_transforms`,
+      `:no_resample_rotation` and `:ignore_layer_weight_animation`
+    - `:ignore_geometry`, `:ignore_animation`, `:ignore_embedded` - Skip parts
+      of the file while loading
+    - `:generate_missing_normals` - Compute smooth normals (respecting
+      smoothing groups) for meshes that have none, so `normals` is always set
+    - `:normalize_normals`, `:normalize_tangents` - Rescale normals, and
+      tangents and bitangents, to unit length while loading
+    - `:load_external_files` - Open the geometry caches referenced by the
+      file (see "Geometry Caches" below). Only their structure is loaded;
+      missing files are skipped
+    - `:subdivide` - Catmull-Clark subdivide meshes before extraction, in any
+      `:mesh_format`: a number of levels, or `:preview` / `:render` for the
+      levels authored in the file (none unless the mesh is displayed
+      smoothed). Edge creases and the mesh's boundary rules are honored.
+      Levels are capped at 5, as each one quadruples the faces. Meshes are
+      subdivided in parallel on the native thread pool; if one fails the
+      load returns `{:error, reason}`. Skin weights are interpolated onto the
+      new vertices
+    - `:span_subdivision` - Segments per knot span when tessellating NURBS
+      (see "NURBS" below): an integer (default `4`) or `:authored` for the
+      surface's own rate, capped at 64
+    - `:max_influences` - Joint influences kept per skinned vertex, `1` to `8`
+      (default `4`, see "Skinning" below)
+
+  ## Render meshes
+
+  With `mesh_format: :render` every face is triangulated and vertices are
+  unified across attributes, so each vertex has a single index and identical
+  vertices are shared. A mesh then has:
+
+    - `vertices` - One interleaved binary of positions, normals, texcoords,
+      colors and tangents (those present, in that order) in `:precision`.
+      Tangents have 4 components, `w` being the bitangent handedness
+    - `indices` - Triangle list binary, `u16` if every vertex fits, else `u32`.
+      Triangles are grouped by material
+    - `draw_ranges` - `u32` triples `[material_id, index_offset, index_count]`,
+      one per material in use, so each material is a single draw call.
+      `material_id` is `0xFFFFFFFF` for faces without a material
+    - `layout` - `vertices`, `indices` and `draw_ranges` describe the whole
+      buffers; each attribute has its `offset` and `stride` in bytes within
+      `vertices`
+
+  `generate_tangents: :mikktspace` (or `true`) computes MikkTSpace tangents
+  natively for render meshes with UVs, replacing any tangents in the file, so
+  normal maps baked by MikkTSpace tools (Blender, Substance, xNormal) line
+  up. Triangles and quads are tangent space faces of their own and ngons are
+  split into triangles first, like Blender does. Meshes without normals get
+  smooth normals (respecting smoothing groups) for the tangent frame as well.
+
+  Render meshes come out in FBX authoring order unless `optimize: true` is
+  given. The triangles of each draw range are then reordered for the GPU's
+  post-transform vertex cache (Tipsify), and vertices are renumbered in
+  first-use order so vertex fetches are sequential. `:vertex_cache_size`
+  (default `16`) sets the cache size optimized for. The mesh reports
+  `cache_stats` with the average cache miss ratio per triangle (`acmr_before`,
+  `acmr_after`) and per vertex (`atvr_before`, `atvr_after`), simulated with a
+  FIFO cache of that size.
+
+  `quantize: true` packs render mesh vertices as normalized integers instead
+  of floats, each attribute 4-byte aligned, and `layout.vertices` has type
+  `:u8` with the vertex size in bytes as components:
+
+    - `positions` - `:snorm16` x3 (padded to 8 bytes) relative to the mesh bounds
+    - `normals` - `:snorm16` x2, octahedral encoding
+    - `texcoords` - `:unorm16` x2 relative to the mesh's UV range
+    - `colors` - `:unorm8` x4
+    - `tangents` - `:snorm8` x3, octahedral encoding followed by the handedness
+
+  Each attribute layout names its `encoding`, `:linear` or `:octahedral`. The
+  mesh's `dequantize` map holds `bias` and `scale` lists for `positions` and
+  `texcoords`: the original value is `bias + normalized * scale`.
+
+  `lods: [0.5, 0.25]` adds simplified levels of detail, each keeping at most
+  that fraction of the triangles. Edges are collapsed cheapest quadric error
+  first; mesh borders and material boundaries stay in place, UV and normal
+  seams only move along themselves, and skinned vertices only collapse onto
+  vertices dominated by the same joint. A level may keep more triangles when
+  nothing more can be collapsed, e.g. on flat-shaded meshes. `lods` is a list
+  of `%{ratio, error, indices, draw_ranges, layout}` maps in decreasing ratio,
+  indexing the mesh's own `vertices`; `error` is the largest collapse distance
+  relative to the mesh's bounding box diagonal. With `optimize: true` the LOD
+  triangles are reordered for the vertex cache as well.
+
+  ## Skinning
+
+  Meshes bound to a skin deformer have a `skin` map in every `:mesh_format`:
+
+    - `joints` - Node id of each joint (`nil` if its bone is missing)
+    - `inverse_bind_matrices` - 4x4 column-major matrix per joint taking mesh
+      geometry to the joint's bind space, in `:precision`
+    - `joint_indices` - `:max_influences` indices into `joints` per vertex,
+      `u8`, or `u16` for more than 256 joints
+    - `weights` - The matching weights, `f32`, or `unorm8` with
+      `quantize: true`, strongest first and summing to one (255); unused slots
+      have zero weight
+    - `layout` - Layouts of the three binaries
+
+  Only the strongest influences are kept and renormalized. There is one entry
+  per `positions` vertex, or per render vertex with `mesh_format: :render`, so
+  the buffers line up with `vertices`. Subdivided meshes carry weights
+  interpolated across the new vertices.
+
+  ## Blend Shapes
+
+  Meshes with blend shapes (morph targets) have a `blend_channels` list, one
+  `%{id, name, weight, shapes}` map per channel of every blend deformer.
+  `weight` is the channel's current weight (`1.0` at full strength) and
+  `shapes` lists the channel's in-between targets in increasing
+  `target_weight`, each a sparse morph:
+
+    - `vertex_indices` - `u32` index of each moved vertex
+    - `position_offsets` - `f32` xyz offset of each moved vertex
+    - `normal_offsets` - `f32` xyz normal offsets, if the shape has them
+    - `layout` - Layouts of the binaries
+
+  Indices refer to `positions`, or to `vertices` with `mesh_format: :render`,
+  where a source vertex split into several render vertices moves all of them.
+  Subdivided meshes have no blend shapes. Use `evaluate_blend/3` to apply
+  channel weights natively.
+
+  ## Geometry Caches
+
+  Meshes driven by geometry caches (.mc/.mcx/.pc2) have a `cache_deformers`
+  list of `%{id, name, channel, file_path}` maps, `file_path` being resolved
+  relative to the FBX file. Frames are never loaded with the scene: open the
+  file with `open_geometry_cache/2`, or call `geometry_cache/2` on a scene
+  opened with `load_external_files: true`, and read frames on demand.
+
+  ## NURBS
+
+  NURBS geometry is tessellated natively. `nurbs_surfaces` holds one mesh per
+  surface in the requested `:mesh_format`, with the surface's `id`, `name`
+  and material; surfaces are tessellated in parallel on the native thread
+  pool. `nurbs_curves` holds one polyline per curve: `%{id, name, positions,
+  indices, layout}` with `positions` in `:precision` and `u32` `indices`
+  tracing the line (closed curves end on their first point), always as
+  binaries. A surface or curve whose NURBS data is invalid comes out as
+  `%{id, name, error}` instead, `error` describing the problem.
+  Nodes carrying NURBS geometry have a `nurbs_surface_id` or
+  `nurbs_curve_id`.
 
   ## Returns
 
@@ -30,9 +235,12 @@ defmodule AriaFbx.Nif do
   ## Examples
 
       {:ok, scene} = AriaFbx.Nif.load_fbx("/path/to/model.fbx")
+
+      {:ok, scene} = AriaFbx.Nif.load_fbx("/path/to/model.fbx", mesh_format: :packed, precision: :f32)
+      [%{positions: <<_::binary>>, layout: %{positions: %{stride: 12}}} | _] = scene.meshes
   """
-  @spec load_fbx(String.t()) :: {:ok, map()} | {:error, String.t()}
-  def load_fbx(_file_path) do
+  @spec load_fbx(String.t(), keyword()) :: {:ok, map()} | {:error, String.t()}
+  def load_fbx(_file_path, _opts \\ []) do
     :erlang.nif_error(:nif_not_loaded)
   end
 
@@ -42,6 +250,7 @@ defmodule AriaFbx.Nif do
   ## Parameters
 
   - `binary_data`: Binary data containing the FBX file content
+  - `opts`: Keyword list of extraction options, see `load_fbx/2`
 
   ## Returns
 
@@ -52,8 +261,8 @@ defmodule AriaFbx.Nif do
 
       {:ok, scene} = AriaFbx.Nif.load_fbx_binary(binary_data)
   """
-  @spec load_fbx_binary(binary()) :: {:ok, map()} | {:error, String.t()}
-  def load_fbx_binary(_binary_data) do
+  @spec load_fbx_binary(binary(), keyword()) :: {:ok, map()} | {:error, String.t()}
+  def load_fbx_binary(_binary_data, _opts \\ []) do
     :erlang.nif_error(:nif_not_loaded)
   end
 
@@ -66,6 +275,17 @@ defmodule AriaFbx.Nif do
   - `scene_data`: Map containing scene data (nodes, meshes, materials, etc.)
   - `format`: Format atom - `:binary` (default) or `:ascii`
 
+  Mesh `positions`, `normals`, `texcoords` and `indices` may be flat lists or
+  packed little-endian binaries. Binaries are read without decoding any terms:
+  their element type comes from the mesh's `layout` map (the one returned by
+  `mesh_format: :packed`) and defaults to `:f64` for reals and `:u32` for
+  indices. Aligned `:f64` and `:u32` binaries are written straight from the
+  binary without copying.
+
+  The file's creation timestamp is the current local time unless
+  `scene_data` has a `creation_time` `NaiveDateTime`. Setting it makes the
+  output reproducible byte for byte.
+
   ## Returns
 
   - `{:ok, file_path}` - On successful write
@@ -84,4 +304,357 @@ defmodule AriaFbx.Nif do
   def write_fbx(_file_path, _scene_data, _format) do
     :erlang.nif_error(:nif_not_loaded)
   end
+
+  @doc """
+  Writes an FBX file to memory using the ufbx_write C library.
+
+  Takes the same `scene_data` and `format` as `write_fbx/3`. Files that fit
+  in a single 1 MiB block are returned as one binary; larger files are
+  returned as a list of block binaries so the data is never copied into one
+  contiguous buffer.
+
+  ## Returns
+
+  - `{:ok, iodata}` - The file contents
+  - `{:error, reason}` - On failure
+
+  ## Examples
+
+      {:ok, iodata} = AriaFbx.Nif.write_fbx_binary(scene_data, :binary)
+      data = IO.iodata_to_binary(iodata)
+  """
+  @spec write_fbx_binary(map(), atom()) :: {:ok, iodata()} | {:error, String.t()}
+  def write_fbx_binary(_scene_data, _format) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @typedoc "Opaque handle to a loaded ufbx scene, freed when garbage collected."
+  @type scene :: reference()
+
+  @typedoc "Opaque handle to an open geometry cache, closed when garbage collected."
+  @type geometry_cache :: reference()
+
+  @doc """
+  Opens an FBX file and keeps the parsed scene alive as a resource.
+
+  Unlike `load_fbx/1`, no Elixir terms are built up front. Use the accessors
+  (`scene_info/1`, `node/2`, `mesh/2`, `material/2`, `texture/2`,
+  `anim_stack/2`) to extract only the elements you need. The scene is freed
+  when the returned handle is garbage collected.
+
+  ## Parameters
+
+  - `file_path`: Path to the FBX file
+  - `opts`: Keyword list of load options
+    - `:ignore_geometry` - Do not load vertices, indices, etc. (default: `false`)
+    - `:ignore_animation` - Do not load animation curves (default: `false`)
+    - `:ignore_embedded` - Do not load embedded content (default: `false`)
+    - `:generate_missing_normals`, `:normalize_normals`, `:normalize_tangents` -
+      Normal and tangent fixups, see `load_fbx/2`
+    - `:load_external_files` - Open referenced geometry caches for
+      `geometry_cache/2` (default: `false`)
+
+  ## Returns
+
+  - `{:ok, scene}` - On successful load
+  - `{:error, reason}` - On failure
+
+  ## Examples
+
+      {:ok, scene} = AriaFbx.Nif.open("/path/to/model.fbx", ignore_animation: true)
+      {:ok, %{mesh_count: count}} = AriaFbx.Nif.scene_info(scene)
+  """
+  @spec open(String.t(), keyword()) :: {:ok, scene()} | {:error, String.t()}
+  def open(_file_path, _opts) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Returns the FBX version and element counts of an opened scene.
+  """
+  @spec scene_info(scene()) :: {:ok, map()}
+  def scene_info(_scene) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Extracts a single node by index (its `id` in `load_fbx/1` output).
+
+  Returns `{:error, :not_found}` if the index is out of range.
+  """
+  @spec node(scene(), non_neg_integer()) :: {:ok, map()} | {:error, :not_found}
+  def node(_scene, _index) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Extracts a single mesh by index (its `id` in `load_fbx/1` output).
+
+  Accepts the same extraction options as `load_fbx/2`.
+  Returns `{:error, :not_found}` if the index is out of range, or
+  `{:error, reason}` if the mesh fails to subdivide.
+
+  With `mesh_format: :packed`, attributes whose requested layout matches
+  ufbx's in-memory layout (`f64` reals, `u32` indices on little-endian hosts)
+  are returned as binaries pointing directly into the loaded scene rather
+  than copies. The scene stays allocated until both the `scene` handle and
+  every such binary have been garbage collected.
+  """
+  @spec mesh(scene(), non_neg_integer(), keyword()) ::
+          {:ok, map()} | {:error, :not_found | String.t()}
+  def mesh(_scene, _index, _opts \\ []) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Extracts a single material by index (its `id` in `load_fbx/1` output).
+
+  Returns `{:error, :not_found}` if the index is out of range.
+  """
+  @spec material(scene(), non_neg_integer()) :: {:ok, map()} | {:error, :not_found}
+  def material(_scene, _index) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Extracts a single texture by index (its `id` in `load_fbx/1` output).
+
+  Returns `{:error, :not_found}` if the index is out of range.
+  """
+  @spec texture(scene(), non_neg_integer()) :: {:ok, map()} | {:error, :not_found}
+  def texture(_scene, _index) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Bakes and extracts a single animation stack by index.
+
+  Accepts `:animation_format`, `:precision` and `:bake` as in `load_fbx/2`.
+  Returns `{:error, :not_found}` if the index is out of range.
+  """
+  @spec anim_stack(scene(), non_neg_integer(), keyword()) ::
+          {:ok, map()} | {:error, :not_found | String.t()}
+  def anim_stack(_scene, _index, _opts \\ []) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Computes axis-aligned bounding boxes for an opened scene in one pass.
+
+  Each box is 6 reals `[min_x, min_y, min_z, max_x, max_y, max_z]` packed in
+  a little-endian binary in `:precision` (`:f64` by default, or `:f32`):
+
+    - `meshes` - One box per mesh, in the mesh's local space
+    - `nodes` - One box per node: the world-space bounds of its mesh
+      (including geometric transforms)
+    - `subtrees` - One box per node: its own box merged with every
+      descendant's, for hierarchical culling
+    - `scene` - A single box around all mesh instances
+
+  Nodes without a mesh, and subtrees without any, get a zero-size box at the
+  node's world position. Boxes are indexed by mesh and node `id`, and
+  `layout` describes each binary.
+
+  ## Examples
+
+      {:ok, scene} = AriaFbx.Nif.open("/path/to/model.fbx", [])
+      {:ok, %{scene: <<min_x::little-float-64, _::binary>>}} = AriaFbx.Nif.bounds(scene, [])
+  """
+  @spec bounds(scene(), keyword()) :: {:ok, map()} | {:error, String.t()}
+  def bounds(_scene, _opts \\ []) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Skins a mesh on the CPU at a batch of times from an animation stack.
+
+  `times` is either a list of times in seconds or a `Range` of frame numbers
+  at the scene's frame rate. Each frame evaluates the stack and blends every
+  skin influence (linear blend skinning) into world-space positions and
+  normals. Normals are transformed by the blended matrix and renormalized.
+  Blend shapes are not applied. Frames are evaluated in parallel.
+
+  Returns a map with:
+
+    - `times` - The sampled times in seconds as `f64`
+    - `positions` - Skinned positions, frame-major
+    - `normals` - Skinned normals, frame-major (if the mesh has normals)
+    - `layout` - Per-frame `count` and component type of each binary
+
+  By default positions are per mesh vertex and normals per face corner. With
+  `mesh_format: :render` (and `:optimize`), both follow the vertex order of
+  `mesh/3` with the same options. `:precision` selects `:f64` or `:f32`.
+  Returns `{:error, :not_found}` if the mesh or stack index is out of range,
+  and `{:error, reason}` for more than 16384 times.
+
+  ## Examples
+
+      {:ok, scene} = AriaFbx.Nif.open("/path/to/character.fbx", [])
+      {:ok, %{positions: positions}} = AriaFbx.Nif.evaluate_skinning(scene, 0, 0, 0..29)
+  """
+  @spec evaluate_skinning(
+          scene(),
+          non_neg_integer(),
+          non_neg_integer(),
+          [number()] | Range.t(),
+          keyword()
+        ) ::
+          {:ok, map()} | {:error, :not_found | String.t()}
+  def evaluate_skinning(_scene, _mesh_index, _anim_stack_index, _times, _opts \\ []) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Applies blend shape channel weights to a mesh of an opened scene.
+
+  `weights` has one weight per entry of the mesh's `blend_channels`, as a
+  list of numbers or a binary of little-endian `f32`s; missing trailing
+  channels stay at zero. Each channel blends between its in-between shapes
+  like FBX does, and the sparse offsets are accumulated natively.
+
+  Returns `f32` `positions` per mesh vertex, matching `positions` of
+  `mesh/3`, and renormalized `normals` per face corner if the mesh has
+  normals, with their `layout`. Returns `{:error, :not_found}` if the index is
+  out of range.
+
+  ## Examples
+
+      {:ok, scene} = AriaFbx.Nif.open("/path/to/face.fbx", [])
+      {:ok, %{positions: positions}} = AriaFbx.Nif.evaluate_blend(scene, 0, [1.0, 0.25])
+  """
+  @spec evaluate_blend(scene(), non_neg_integer(), [number()] | binary()) ::
+          {:ok, map()} | {:error, :not_found | String.t()}
+  def evaluate_blend(_scene, _mesh_index, _weights) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Bakes a mesh's animation into vertex animation textures (VATs).
+
+  Evaluates the animation stack from its start to its end at `:frame_rate`
+  (the scene's frame rate by default), morphing each frame by the animated
+  blend shapes and skinning it like `evaluate_skinning/5`. Frames are
+  evaluated in parallel on the native thread pool.
+
+  Each texture has one row per frame and one texel per render vertex, in
+  the vertex order of `mesh/3` with `mesh_format: :render` and the same
+  `:optimize` and `:generate_tangents` options:
+
+    - `positions` - World-space positions in `rgb`, `a = 1`
+    - `normals` - Renormalized normals in `rgb`, `a = 0` (if the mesh has
+      normals)
+    - `min`, `max` - Bounds of every position over all frames, `[x, y, z]`
+    - `times` - The sampled time of each row in seconds as `f64`
+    - `frame_rate` - Rows per second
+    - `layout` - Layout of each binary; textures add `width` and `height`
+
+  Options:
+
+    - `:frame_rate` - Samples per second, a positive finite number
+    - `:texture_format` - `:rgba16f` (default, half floats) or `:rgba32f`
+    - `:normalize` - Store positions remapped from `min..max` to `0..1` per
+      axis, restored with `min + texel * (max - min)` (default: `false`)
+
+  Returns `{:error, :not_found}` if the mesh or stack index is out of range,
+  and `{:error, reason}` for an invalid `:frame_rate` or if the stack would
+  bake more than 16384 rows.
+
+  ## Examples
+
+      {:ok, scene} = AriaFbx.Nif.open("/path/to/character.fbx", [])
+      {:ok, vat} = AriaFbx.Nif.bake_vertex_animation(scene, 0, 0, frame_rate: 30, normalize: true)
+      %{width: vertices, height: frames} = vat.layout.positions
+  """
+  @spec bake_vertex_animation(scene(), non_neg_integer(), non_neg_integer(), keyword()) ::
+          {:ok, map()} | {:error, :not_found | String.t()}
+  def bake_vertex_animation(_scene, _mesh_index, _anim_stack_index, _opts \\ []) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Opens a geometry cache file (`.xml` with `.mc`/`.mcx` frames, or `.pc2`).
+
+  Only the channel and frame structure is read; frame data stays on disk
+  until requested with `read_geometry_cache_frame/4` or
+  `sample_geometry_cache/4`, so caches of any size can be streamed. Runs on a
+  dirty I/O scheduler. The cache is closed when the handle is garbage
+  collected.
+
+  Options:
+
+    - `:frame_rate` - Frames per second used to convert frame numbers to
+      seconds, for caches that do not specify one
+  """
+  @spec open_geometry_cache(String.t(), keyword()) ::
+          {:ok, geometry_cache()} | {:error, String.t()}
+  def open_geometry_cache(_file_path, _opts \\ []) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Returns the geometry cache of a cache deformer (its `id` in a mesh's
+  `cache_deformers`) in a scene opened with `load_external_files: true`.
+
+  The handle keeps the scene alive. Returns `{:error, :not_found}` if the
+  index is out of range or the cache file could not be opened.
+  """
+  @spec geometry_cache(scene(), non_neg_integer()) ::
+          {:ok, geometry_cache()} | {:error, :not_found}
+  def geometry_cache(_scene, _cache_deformer_index) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Describes the channels of a geometry cache without reading any frames.
+
+  Returns `%{channels: [channel]}`, each channel a map with `name`,
+  `interpretation` (`:points`, `:vertex_position`, `:vertex_normal` or
+  `:unknown`), `point_count` (the largest frame's xyz count), `times` (the
+  time of each stored frame in seconds as `f64`) and `layout`. Channels and
+  frames are addressed by their index.
+  """
+  @spec geometry_cache_info(geometry_cache()) :: {:ok, map()}
+  def geometry_cache_info(_cache) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Reads one stored frame of a geometry cache channel from disk.
+
+  Returns `%{time, data, layout}` with the frame's xyz values packed in
+  `:precision` (`:f64` by default, or `:f32`). Scale and mirroring recorded
+  in the cache are applied unless `ignore_transform: true`. Runs on a dirty
+  I/O scheduler and reads only this frame. Returns `{:error, :not_found}` if
+  the channel or frame index is out of range.
+
+  ## Examples
+
+      {:ok, cache} = AriaFbx.Nif.open_geometry_cache("/path/to/cache.xml")
+      {:ok, %{data: <<x::little-float-64, _::binary>>}} =
+        AriaFbx.Nif.read_geometry_cache_frame(cache, 0, 10, [])
+  """
+  @spec read_geometry_cache_frame(
+          geometry_cache(),
+          non_neg_integer(),
+          non_neg_integer(),
+          keyword()
+        ) ::
+          {:ok, map()} | {:error, :not_found | String.t()}
+  def read_geometry_cache_frame(_cache, _channel_index, _frame_index, _opts \\ []) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
+
+  @doc """
+  Samples a geometry cache channel at `time` seconds.
+
+  Times between stored frames are interpolated linearly from the two frames
+  around them, which are the only ones read; times outside the cache clamp
+  to its first or last frame. Returns the same map and accepts the same
+  options as `read_geometry_cache_frame/4`. Runs on a dirty I/O scheduler.
+  """
+  @spec sample_geometry_cache(geometry_cache(), non_neg_integer(), number(), keyword()) ::
+          {:ok, map()} | {:error, :not_found | String.t()}
+  def sample_geometry_cache(_cache, _channel_index, _time, _opts \\ []) do
+    :erlang.nif_error(:nif_not_loaded)
+  end
 end
@@ -20,12 +20,13 @@ defmodule AriaFbx.Parser do
   @spec from_ufbx_scene(map()) :: {:ok, Document.t()} | {:error, term()}
   def from_ufbx_scene(ufbx_data) when is_map(ufbx_data) do
     # Extract nodes, meshes, materials, textures, and animations from ufbx_data
-    document = Document.new(ufbx_data["version"] || "FBX 7.4")
+    document = Document.new(to_string_or_nil(get(ufbx_data, :version)) || "FBX 7.4")
 
     document =
       document
       |> parse_nodes(ufbx_data)
       |> parse_meshes(ufbx_data)
+      |> parse_nurbs_surfaces(ufbx_data)
       |> parse_materials(ufbx_data)
       |> parse_textures(ufbx_data)
       |> parse_animations(ufbx_data)
@@ -36,110 +37,179 @@ defmodule AriaFbx.Parser do
   def from_ufbx_scene(_), do: {:error, :invalid_ufbx_data}
 
   defp parse_nodes(document, data) do
-    nodes = data["nodes"] || []
+    nodes = get(data, :nodes) || []
     parsed_nodes = Enum.map(nodes, &parse_node/1)
     %{document | nodes: parsed_nodes}
   end
 
   defp parse_node(node_data) when is_map(node_data) do
     %Scene.Node{
-      id: node_data["id"] || 0,
-      name: node_data["name"] || "",
-      parent_id: node_data["parent_id"],
-      children: node_data["children"] || [],
-      translation: parse_vec3(node_data["translation"]),
-      rotation: parse_vec4(node_data["rotation"]),
-      scale: parse_vec3(node_data["scale"]),
-      mesh_id: node_data["mesh_id"],
-      extensions: node_data["extensions"],
-      extras: node_data["extras"]
+      id: get(node_data, :id) || 0,
+      name: to_string_or_nil(get(node_data, :name)) || "",
+      parent_id: get(node_data, :parent_id),
+      children: get(node_data, :children) || [],
+      translation: parse_vec3(get(node_data, :translation)),
+      rotation: parse_vec4(get(node_data, :rotation)),
+      scale: parse_vec3(get(node_data, :scale)),
+      mesh_id: get(node_data, :mesh_id),
+      extensions: get(node_data, :extensions),
+      extras: get(node_data, :extras)
     }
   end
 
   defp parse_meshes(document, data) do
-    meshes = data["meshes"] || []
+    meshes = get(data, :meshes) || []
     parsed_meshes = Enum.map(meshes, &parse_mesh/1)
     %{document | meshes: parsed_meshes}
   end
 
+  # Tessellated NURBS surfaces become meshes numbered after the polygon
+  # meshes, and the nodes holding them point at those meshes. Surfaces that
+  # could not be tessellated only carry an `error` and are left out.
+  defp parse_nurbs_surfaces(document, data) do
+    base_id = length(get(data, :meshes) || [])
+
+    surfaces =
+      for surface <- get(data, :nurbs_surfaces) || [], not Map.has_key?(surface, :error) do
+        %{parse_mesh(surface) | id: base_id + (get(surface, :id) || 0)}
+      end
+
+    mesh_ids = MapSet.new(surfaces, & &1.id)
+
+    node_mesh_ids =
+      for node <- get(data, :nodes) || [],
+          surface_id = get(node, :nurbs_surface_id),
+          is_integer(surface_id),
+          MapSet.member?(mesh_ids, base_id + surface_id),
+          into: %{},
+          do: {get(node, :id), base_id + surface_id}
+
+    nodes =
+      Enum.map(document.nodes, fn node ->
+        %{node | mesh_id: Map.get(node_mesh_ids, node.id, node.mesh_id)}
+      end)
+
+    %{document | meshes: document.meshes ++ surfaces, nodes: nodes}
+  end
+
   defp parse_mesh(mesh_data) when is_map(mesh_data) do
     %Scene.Mesh{
-      id: mesh_data["id"] || 0,
-      name: mesh_data["name"],
-      positions: mesh_data["positions"],
-      normals: mesh_data["normals"],
-      texcoords: mesh_data["texcoords"],
-      indices: mesh_data["indices"],
-      material_ids: mesh_data["material_ids"] || [],
-      extensions: mesh_data["extensions"],
-      extras: mesh_data["extras"]
+      id: get(mesh_data, :id) || 0,
+      name: to_string_or_nil(get(mesh_data, :name)),
+      positions: get(mesh_data, :positions),
+      normals: get(mesh_data, :normals),
+      texcoords: get(mesh_data, :texcoords),
+      vertices: get(mesh_data, :vertices),
+      indices: get(mesh_data, :indices),
+      draw_ranges: get(mesh_data, :draw_ranges),
+      cache_stats: get(mesh_data, :cache_stats),
+      dequantize: get(mesh_data, :dequantize),
+      lods: get(mesh_data, :lods),
+      skin: get(mesh_data, :skin),
+      blend_channels: get(mesh_data, :blend_channels),
+      cache_deformers: get(mesh_data, :cache_deformers),
+      layout: get(mesh_data, :layout),
+      material_ids: get(mesh_data, :material_ids) || [],
+      extensions: get(mesh_data, :extensions),
+      extras: get(mesh_data, :extras)
     }
   end
 
   defp parse_materials(document, data) do
-    materials = data["materials"] || []
+    materials = get(data, :materials) || []
     parsed_materials = Enum.map(materials, &parse_material/1)
     %{document | materials: parsed_materials}
   end
 
   defp parse_material(material_data) when is_map(material_data) do
     %Scene.Material{
-      id: material_data["id"] || 0,
-      name: material_data["name"],
-      diffuse_color: parse_vec3(material_data["diffuse_color"]),
-      specular_color: parse_vec3(material_data["specular_color"]),
-      emissive_color: parse_vec3(material_data["emissive_color"]),
-      extensions: material_data["extensions"],
-      extras: material_data["extras"]
+      id: get(material_data, :id) || 0,
+      name: to_string_or_nil(get(material_data, :name)),
+      diffuse_color: parse_vec3(get(material_data, :diffuse_color)),
+      specular_color: parse_vec3(get(material_data, :specular_color)),
+      emissive_color: parse_vec3(get(material_data, :emissive_color)),
+      extensions: get(material_data, :extensions),
+      extras: get(material_data, :extras)
     }
   end
 
   defp parse_textures(document, data) do
-    textures = data["textures"] || []
+    textures = get(data, :textures) || []
     parsed_textures = Enum.map(textures, &parse_texture/1)
     %{document | textures: parsed_textures}
   end
 
   defp parse_texture(texture_data) when is_map(texture_data) do
     %Scene.Texture{
-      id: texture_data["id"] || 0,
-      name: texture_data["name"],
-      file_path: texture_data["file_path"],
-      extensions: texture_data["extensions"],
-      extras: texture_data["extras"]
+      id: get(texture_data, :id) || 0,
+      name: to_string_or_nil(get(texture_data, :name)),
+      file_path: to_string_or_nil(get(texture_data, :file_path)),
+      extensions: get(texture_data, :extensions),
+      extras: get(texture_data, :extras)
     }
   end
 
   defp parse_animations(document, data) do
-    animations = data["animations"] || []
+    animations = get(data, :animations) || []
     parsed_animations = Enum.map(animations, &parse_animation/1)
     %{document | animations: parsed_animations}
   end
 
   defp parse_animation(animation_data) when is_map(animation_data) do
     keyframes =
-      (animation_data["keyframes"] || [])
+      (get(animation_data, :keyframes) || [])
       |> Enum.map(&parse_keyframe/1)
 
+    channels =
+      case get(animation_data, :channels) do
+        nil -> nil
+        channels -> Enum.map(channels, &parse_channel/1)
+      end
+
     %Scene.Animation{
-      id: animation_data["id"] || 0,
-      name: animation_data["name"],
-      node_id: animation_data["node_id"] || 0,
+      id: get(animation_data, :id) || 0,
+      name: to_string_or_nil(get(animation_data, :name)),
+      node_id: get(animation_data, :node_id) || 0,
       keyframes: keyframes,
-      extensions: animation_data["extensions"],
-      extras: animation_data["extras"]
+      channels: channels,
+      extensions: get(animation_data, :extensions),
+      extras: get(animation_data, :extras)
+    }
+  end
+
+  defp parse_channel(channel_data) when is_map(channel_data) do
+    %Scene.Animation.Channel{
+      node_id: get(channel_data, :node_id) || 0,
+      times: get(channel_data, :times),
+      translation: get(channel_data, :translation),
+      rotation: get(channel_data, :rotation),
+      scale: get(channel_data, :scale),
+      precision: get(channel_data, :precision) || :f64
     }
   end
 
   defp parse_keyframe(keyframe_data) when is_map(keyframe_data) do
     %Scene.Animation.Keyframe{
-      time: keyframe_data["time"] || 0.0,
-      translation: parse_vec3(keyframe_data["translation"]),
-      rotation: parse_vec4(keyframe_data["rotation"]),
-      scale: parse_vec3(keyframe_data["scale"])
+      time: get(keyframe_data, :time) || 0.0,
+      translation: parse_vec3(get(keyframe_data, :translation)),
+      rotation: parse_vec4(get(keyframe_data, :rotation)),
+      scale: parse_vec3(get(keyframe_data, :scale))
     }
   end
 
+  # The NIF emits atom keys; maps decoded from JSON or built by hand use
+  # string keys. Accept either.
+  defp get(map, key) when is_atom(key) do
+    case Map.fetch(map, key) do
+      {:ok, value} -> value
+      :error -> Map.get(map, Atom.to_string(key))
+    end
+  end
+
+  defp to_string_or_nil(nil), do: nil
+  defp to_string_or_nil(value) when is_binary(value), do: value
+  defp to_string_or_nil(value) when is_list(value), do: List.to_string(value)
+
   defp parse_vec3(nil), do: nil
   defp parse_vec3([x, y, z]) when is_number(x) and is_number(y) and is_number(z), do: {x, y, z}
   defp parse_vec3(_), do: nil
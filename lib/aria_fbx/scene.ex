@@ -63,14 +63,47 @@ defmodule AriaFbx.Scene do
   defmodule Mesh do
     @moduledoc """
     Represents an FBX mesh with geometry data.
+
+    Vertex attributes are lists, or little-endian binaries when loaded with
+    `mesh_format: :packed`; `layout` then describes each packed attribute.
+    Meshes loaded with `mesh_format: :render` have an interleaved `vertices`
+    binary instead of separate attributes, a triangle list `indices` sorted
+    by material and `draw_ranges` to draw each material with one call, plus
+    simplified `lods` over the same vertices when requested.
+
+    Skinned meshes have a `skin` map with the `joints` (node ids), their
+    `inverse_bind_matrices` and per-vertex `joint_indices` and `weights`
+    binaries, one entry per position or render vertex. Meshes with blend
+    shapes have `blend_channels`, each with sparse `shapes` offsetting those
+    same vertices. Meshes driven by geometry caches list their
+    `cache_deformers`.
     """
+    @type attribute_layout :: %{
+            required(:type) =>
+              :f32 | :f64 | :u8 | :u16 | :u32 | :snorm8 | :snorm16 | :unorm8 | :unorm16,
+            required(:components) => pos_integer(),
+            required(:stride) => pos_integer(),
+            required(:count) => non_neg_integer(),
+            optional(:offset) => non_neg_integer(),
+            optional(:encoding) => :linear | :octahedral
+          }
+
     @type t :: %__MODULE__{
             id: non_neg_integer(),
             name: String.t() | nil,
-            positions: [float()] | nil,
-            normals: [float()] | nil,
-            texcoords: [float()] | nil,
-            indices: [non_neg_integer()] | nil,
+            positions: [float()] | binary() | nil,
+            normals: [float()] | binary() | nil,
+            texcoords: [float()] | binary() | nil,
+            vertices: binary() | nil,
+            indices: [non_neg_integer()] | binary() | nil,
+            draw_ranges: binary() | nil,
+            cache_stats: map() | nil,
+            dequantize: map() | nil,
+            lods: [map()] | nil,
+            skin: map() | nil,
+            blend_channels: [map()] | nil,
+            cache_deformers: [map()] | nil,
+            layout: %{optional(atom()) => attribute_layout()} | nil,
             material_ids: [non_neg_integer()] | nil,
             extensions: map() | nil,
             extras: any() | nil
@@ -82,7 +115,16 @@ defmodule AriaFbx.Scene do
       :positions,
       :normals,
       :texcoords,
+      :vertices,
       :indices,
+      :draw_ranges,
+      :cache_stats,
+      :dequantize,
+      :lods,
+      :skin,
+      :blend_channels,
+      :cache_deformers,
+      :layout,
       :material_ids,
       :extensions,
       :extras
@@ -92,10 +134,19 @@ defmodule AriaFbx.Scene do
       %{
         "id" => mesh.id,
         "name" => mesh.name,
-        "positions" => mesh.positions,
-        "normals" => mesh.normals,
-        "texcoords" => mesh.texcoords,
-        "indices" => mesh.indices,
+        "positions" => encode_attribute(mesh.positions),
+        "normals" => encode_attribute(mesh.normals),
+        "texcoords" => encode_attribute(mesh.texcoords),
+        "vertices" => encode_attribute(mesh.vertices),
+        "indices" => encode_attribute(mesh.indices),
+        "drawRanges" => encode_attribute(mesh.draw_ranges),
+        "cacheStats" => mesh.cache_stats,
+        "dequantize" => mesh.dequantize,
+        "lods" => encode_lods(mesh.lods),
+        "skin" => encode_skin(mesh.skin),
+        "blendChannels" => encode_blend_channels(mesh.blend_channels),
+        "cacheDeformers" => encode_cache_deformers(mesh.cache_deformers),
+        "layout" => mesh.layout,
         "materialIds" => mesh.material_ids,
         "extensions" => mesh.extensions,
         "extras" => mesh.extras
@@ -103,6 +154,90 @@ defmodule AriaFbx.Scene do
       |> Enum.reject(fn {_key, value} -> is_nil(value) end)
       |> Enum.into(%{})
     end
+
+    @doc """
+    Decodes `draw_ranges` into `{material_id, index_offset, index_count}`
+    tuples. `material_id` is `nil` for faces without a material.
+    """
+    @spec draw_range_list(t()) :: [
+            {non_neg_integer() | nil, non_neg_integer(), non_neg_integer()}
+          ]
+    def draw_range_list(%__MODULE__{draw_ranges: nil}), do: []
+
+    def draw_range_list(%__MODULE__{draw_ranges: ranges}) do
+      for <<material_id::little-32, offset::little-32, count::little-32 <- ranges>> do
+        {if(material_id == 0xFFFFFFFF, do: nil, else: material_id), offset, count}
+      end
+    end
+
+    defp encode_attribute(data) when is_binary(data), do: Base.encode64(data)
+    defp encode_attribute(data), do: data
+
+    defp encode_lods(nil), do: nil
+
+    defp encode_lods(lods) do
+      Enum.map(lods, fn lod ->
+        %{
+          "ratio" => lod.ratio,
+          "error" => lod.error,
+          "indices" => encode_attribute(lod.indices),
+          "drawRanges" => encode_attribute(lod.draw_ranges),
+          "layout" => lod.layout
+        }
+      end)
+    end
+
+    defp encode_skin(nil), do: nil
+
+    defp encode_skin(skin) do
+      %{
+        "joints" => skin.joints,
+        "inverseBindMatrices" => encode_attribute(skin.inverse_bind_matrices),
+        "jointIndices" => encode_attribute(skin.joint_indices),
+        "weights" => encode_attribute(skin.weights),
+        "layout" => skin.layout
+      }
+    end
+
+    defp encode_blend_channels(nil), do: nil
+
+    defp encode_blend_channels(channels) do
+      Enum.map(channels, fn channel ->
+        %{
+          "id" => channel.id,
+          "name" => channel.name,
+          "weight" => channel.weight,
+          "shapes" => Enum.map(channel.shapes, &encode_blend_shape/1)
+        }
+      end)
+    end
+
+    defp encode_cache_deformers(nil), do: nil
+
+    defp encode_cache_deformers(deformers) do
+      Enum.map(deformers, fn deformer ->
+        %{
+          "id" => deformer.id,
+          "name" => deformer.name,
+          "channel" => deformer.channel,
+          "filePath" => deformer.file_path
+        }
+      end)
+    end
+
+    defp encode_blend_shape(shape) do
+      %{
+        "id" => shape.id,
+        "name" => shape.name,
+        "targetWeight" => shape.target_weight,
+        "vertexIndices" => encode_attribute(shape.vertex_indices),
+        "positionOffsets" => encode_attribute(shape.position_offsets),
+        "normalOffsets" => encode_attribute(Map.get(shape, :normal_offsets)),
+        "layout" => shape.layout
+      }
+      |> Enum.reject(fn {_key, value} -> is_nil(value) end)
+      |> Enum.into(%{})
+    end
   end
 
   defmodule Material do
@@ -183,12 +318,16 @@ defmodule AriaFbx.Scene do
   defmodule Animation do
     @moduledoc """
     Represents an FBX animation.
+
+    Baked samples are either a list of `keyframes` or, when loaded with
+    `animation_format: :channels`, one `Channel` of flat arrays per node.
     """
     @type t :: %__MODULE__{
             id: non_neg_integer(),
             name: String.t() | nil,
             node_id: non_neg_integer(),
             keyframes: [Keyframe.t()] | nil,
+            channels: [Channel.t()] | nil,
             extensions: map() | nil,
             extras: any() | nil
           }
@@ -226,11 +365,73 @@ defmodule AriaFbx.Scene do
       defp encode_vec4({x, y, z, w}), do: [x, y, z, w]
     end
 
+    defmodule Channel do
+      @moduledoc """
+      Baked transform samples of one node in columnar form.
+
+      `times` is a little-endian f64 binary of `sample_count/1` entries.
+      `translation` and `scale` hold 3 and `rotation` 4 (quaternion x, y, z, w)
+      little-endian floats per sample, of type `precision`.
+      """
+      @type t :: %__MODULE__{
+              node_id: non_neg_integer(),
+              times: binary(),
+              translation: binary(),
+              rotation: binary(),
+              scale: binary(),
+              precision: :f32 | :f64
+            }
+
+      defstruct [:node_id, :times, :translation, :rotation, :scale, precision: :f64]
+
+      @doc "Number of samples in the channel."
+      @spec sample_count(t()) :: non_neg_integer()
+      def sample_count(%__MODULE__{times: times}), do: div(byte_size(times), 8)
+
+      @doc "Expands the channel into per-sample keyframes."
+      @spec to_keyframes(t()) :: [Keyframe.t()]
+      def to_keyframes(%__MODULE__{} = channel) do
+        times = for <<t::little-float-64 <- channel.times>>, do: t
+
+        [
+          times,
+          decode(channel.translation, 3, channel.precision),
+          decode(channel.rotation, 4, channel.precision),
+          decode(channel.scale, 3, channel.precision)
+        ]
+        |> Enum.zip_with(fn [time, translation, rotation, scale] ->
+          %Keyframe{time: time, translation: translation, rotation: rotation, scale: scale}
+        end)
+      end
+
+      def to_json(%__MODULE__{} = channel) do
+        %{
+          "nodeId" => channel.node_id,
+          "precision" => Atom.to_string(channel.precision),
+          "times" => Base.encode64(channel.times),
+          "translation" => Base.encode64(channel.translation),
+          "rotation" => Base.encode64(channel.rotation),
+          "scale" => Base.encode64(channel.scale)
+        }
+      end
+
+      defp decode(data, components, :f32),
+        do: for(<<v::little-float-32 <- data>>, do: v) |> to_tuples(components)
+
+      defp decode(data, components, :f64),
+        do: for(<<v::little-float-64 <- data>>, do: v) |> to_tuples(components)
+
+      defp to_tuples(values, components) do
+        values |> Enum.chunk_every(components) |> Enum.map(&List.to_tuple/1)
+      end
+    end
+
     defstruct [
       :id,
       :name,
       :node_id,
       :keyframes,
+      :channels,
       :extensions,
       :extras
     ]
@@ -241,6 +442,7 @@ defmodule AriaFbx.Scene do
         "name" => animation.name,
         "nodeId" => animation.node_id,
         "keyframes" => encode_optional_list(animation.keyframes, &Keyframe.to_json/1),
+        "channels" => encode_optional_list(animation.channels, &Channel.to_json/1),
         "extensions" => animation.extensions,
         "extras" => animation.extras
       }
@@ -3,7 +3,14 @@
 
 defmodule AriaFbx.NifTest do
   use ExUnit.Case
-  alias AriaFbx.Nif
+  alias AriaFbx.{Nif, Scene}
+
+  @cube_fbx "thirdparty/ufbx/data/maya_cube_7500_binary.fbx"
+  @sausage_fbx "thirdparty/ufbx/data/blender_279_sausage_7400_binary.fbx"
+  @blend_fbx "thirdparty/ufbx/data/maya_blend_shape_cube_7700_binary.fbx"
+  @morph_fbx "thirdparty/ufbx/data/blender440_shape_weight_anim_7400_binary.fbx"
+  @barbarian_fbx "thirdparty/ufbx/data/blender_293_barbarian_7400_binary.fbx"
+  @pc2_cache "thirdparty/ufbx/data/max_cache_box_7500_binary_fpc/max_cache_box.pc2"
 
   describe "load_fbx/1" do
     test "returns error for non-existent file" do
@@ -20,6 +27,498 @@ defmodule AriaFbx.NifTest do
     end
   end
 
+  describe "load options" do
+    test "NIFs work on the calling scheduler with dirty_schedulers: false" do
+      path = Path.expand(@cube_fbx)
+      result = call_with_load_env([dirty_schedulers: false], :load_fbx, [path, []])
+
+      assert {:ok, %{meshes: [_]}} = result
+      assert result == Nif.load_fbx(path, [])
+    end
+
+    test "parses compressed arrays the same with and without the thread pool" do
+      path = Path.expand(@barbarian_fbx)
+      opts = [mesh_format: :packed, anim_stacks: :none]
+
+      {:ok, pooled} = Nif.load_fbx(path, opts)
+      assert {:ok, ^pooled} = call_with_load_env([thread_pool_size: 0], :load_fbx, [path, opts])
+      assert [_ | _] = pooled.meshes
+    end
+  end
+
+  describe "open/2" do
+    test "returns error for non-existent file" do
+      assert {:error, _reason} = Nif.open("/nonexistent/file.fbx", [])
+    end
+
+    test "extracts only the requested elements" do
+      {:ok, scene} = Nif.open(@cube_fbx, [])
+
+      assert {:ok, %{node_count: 2, mesh_count: 1, material_count: 1}} = Nif.scene_info(scene)
+      assert {:ok, %{id: 1, mesh_id: 0}} = Nif.node(scene, 1)
+      assert {:ok, %{id: 0, positions: positions}} = Nif.mesh(scene, 0)
+      assert length(positions) == 8
+      assert {:ok, %{id: 0}} = Nif.material(scene, 0)
+      assert {:ok, %{id: 0}} = Nif.anim_stack(scene, 0)
+    end
+
+    test "returns not_found for out of range indices" do
+      {:ok, scene} = Nif.open(@cube_fbx, [])
+
+      assert {:error, :not_found} = Nif.node(scene, 100)
+      assert {:error, :not_found} = Nif.mesh(scene, 1)
+      assert {:error, :not_found} = Nif.texture(scene, 0)
+    end
+
+    test "bounds/2 returns mesh, node, subtree and scene boxes" do
+      {:ok, scene} = Nif.open(@cube_fbx, [])
+      {:ok, bounds} = Nif.bounds(scene, precision: :f32)
+
+      cube = for _ <- 1..3, into: <<>>, do: <<-0.5::little-float-32>>
+      cube = cube <> for(_ <- 1..3, into: <<>>, do: <<0.5::little-float-32>>)
+
+      assert bounds.meshes == cube
+      assert bounds.scene == cube
+      assert %{type: :f32, components: 6, count: 2} = bounds.layout.nodes
+
+      # The root has no mesh of its own, but its subtree holds the cube
+      assert <<root::binary-size(24), ^cube::binary>> = bounds.nodes
+      assert root == <<0::size(192)>>
+      assert bounds.subtrees == cube <> cube
+    end
+
+    test "generate_missing_normals fills in normals at load time" do
+      path = "thirdparty/ufbx/data/synthetic_missing_normals_7400_ascii.fbx"
+      {:ok, plain} = Nif.open(path, [])
+      {:ok, scene} = Nif.open(path, generate_missing_normals: true)
+
+      refute Map.has_key?(elem(Nif.mesh(plain, 0), 1), :normals)
+      assert {:ok, %{normals: [_ | _]}} = Nif.mesh(scene, 0)
+    end
+  end
+
+  describe "load_fbx/2 with mesh_format: :packed" do
+    test "returns vertex and index data as binaries" do
+      {:ok, data} = Nif.load_fbx(@cube_fbx, mesh_format: :packed, precision: :f32)
+      [mesh] = data.meshes
+
+      assert byte_size(mesh.positions) == 8 * 3 * 4
+      assert %{type: :f32, components: 3, stride: 12, count: 8} = mesh.layout.positions
+      assert %{type: :u32, stride: 4, count: count} = mesh.layout.indices
+      assert byte_size(mesh.indices) == count * 4
+    end
+
+    test "mesh/3 binaries outlive the scene handle" do
+      {:ok, mesh} =
+        Nif.open(@cube_fbx, [])
+        |> then(fn {:ok, scene} -> Nif.mesh(scene, 0, mesh_format: :packed) end)
+
+      :erlang.garbage_collect()
+
+      assert byte_size(mesh.positions) == 8 * 3 * 8
+      assert <<-0.5::little-float-64, _::binary>> = mesh.positions
+    end
+  end
+
+  describe "mesh/3 with mesh_format: :render" do
+    test "returns triangulated vertices with a single shared index" do
+      {:ok, scene} = Nif.open(@cube_fbx, [])
+      {:ok, mesh} = Nif.mesh(scene, 0, mesh_format: :render, precision: :f32)
+
+      # 6 quads with split normals: 4 unique vertices per side, 2 triangles each
+      assert %{type: :u16, count: 36} = mesh.layout.indices
+      assert %{type: :f32, count: 24, stride: stride} = mesh.layout.vertices
+      assert byte_size(mesh.vertices) == 24 * stride
+      assert %{offset: 0, components: 3, stride: ^stride} = mesh.layout.positions
+      assert %{offset: 12} = mesh.layout.normals
+
+      indices = for <<i::little-16 <- mesh.indices>>, do: i
+      assert Enum.max(indices) == 23
+    end
+
+    test "groups triangles into one draw range per material" do
+      path = "thirdparty/ufbx/data/blender_suzanne_multimaterial_7400_binary.fbx"
+      {:ok, scene} = Nif.open(path, [])
+      {:ok, mesh} = Nif.mesh(scene, 0, mesh_format: :render)
+      ranges = Scene.Mesh.draw_range_list(%Scene.Mesh{draw_ranges: mesh.draw_ranges})
+
+      assert length(ranges) == length(mesh.material_ids)
+      assert Enum.map(ranges, &elem(&1, 0)) == mesh.material_ids
+
+      # Ranges tile the index buffer in order
+      end_offset =
+        Enum.reduce(ranges, 0, fn {_material, offset, count}, expected ->
+          assert offset == expected
+          offset + count
+        end)
+
+      assert end_offset == mesh.layout.indices.count
+    end
+
+    test "optimize: true reorders for the vertex cache" do
+      path = "thirdparty/ufbx/data/maya_kenney_character_7700_binary.fbx"
+      {:ok, scene} = Nif.open(path, [])
+      {:ok, plain} = Nif.mesh(scene, 0, mesh_format: :render)
+      {:ok, mesh} = Nif.mesh(scene, 0, mesh_format: :render, optimize: true)
+
+      assert %{cache_size: 16, acmr_before: acmr_before, acmr_after: acmr_after} =
+               mesh.cache_stats
+      assert acmr_after < acmr_before
+      assert mesh.layout.vertices.count == plain.layout.vertices.count
+      assert mesh.draw_ranges == plain.draw_ranges
+
+      # Vertices are numbered in first-use order
+      indices = for <<i::little-16 <- mesh.indices>>, do: i
+      assert Enum.uniq(indices) == Enum.to_list(0..(mesh.layout.vertices.count - 1))
+    end
+
+    test "quantize: true packs vertices as normalized integers" do
+      {:ok, scene} = Nif.open(@cube_fbx, [])
+      {:ok, mesh} = Nif.mesh(scene, 0, mesh_format: :render, quantize: true)
+
+      assert %{type: :u8, count: 24, stride: stride} = mesh.layout.vertices
+      assert byte_size(mesh.vertices) == 24 * stride
+      assert %{type: :snorm16, offset: 0, encoding: :linear} = mesh.layout.positions
+      assert %{type: :snorm16, components: 2, encoding: :octahedral} = mesh.layout.normals
+
+      # The cube spans [-0.5, 0.5] on every axis
+      %{positions: %{bias: bias, scale: scale}} = mesh.dequantize
+      <<x::little-signed-16, _::binary>> = mesh.vertices
+
+      for {b, s} <- Enum.zip(bias, scale) do
+        assert_in_delta b, 0.0, 1.0e-6
+        assert_in_delta s, 0.5, 1.0e-6
+      end
+
+      assert abs(x) == 32767
+    end
+
+    test "generate_tangents: :mikktspace adds tangents to meshes with UVs" do
+      path = "thirdparty/ufbx/data/synthetic_missing_normals_7400_ascii.fbx"
+      {:ok, scene} = Nif.open(path, [])
+      opts = [mesh_format: :render, generate_tangents: :mikktspace]
+      {:ok, mesh} = Nif.mesh(scene, 0, opts)
+
+      # Normals are generated for the tangent frame too
+      assert %{components: 3} = mesh.layout.normals
+      assert %{components: 4, offset: offset, stride: stride} = mesh.layout.tangents
+
+      for <<_::binary-size(offset), x::little-float-64, y::little-float-64, z::little-float-64,
+            w::little-float-64, _::binary-size(stride - offset - 32) <- mesh.vertices>> do
+        assert_in_delta x * x + y * y + z * z, 1.0, 1.0e-9
+        assert w in [1.0, -1.0]
+      end
+    end
+
+    test "generated tangents match Blender's on flat quads with mirrored and rotated UVs" do
+      # Single quads with tangents written by Blender, so this checks the
+      # handedness and UV orientation but not the smoothing across triangles
+      {:ok, scene} = Nif.open("thirdparty/ufbx/data/blender340_tangent_sign_7400_binary.fbx", [])
+
+      for index <- 0..3 do
+        {:ok, authored} = Nif.mesh(scene, index, mesh_format: :render)
+        {:ok, generated} =
+          Nif.mesh(scene, index, mesh_format: :render, generate_tangents: :mikktspace)
+
+        assert generated.layout.tangents == authored.layout.tangents
+
+        for {a, b} <- Enum.zip(tangents(authored), tangents(generated)) do
+          {ax, ay, az, aw} = a
+          {bx, by, bz, bw} = b
+          len = :math.sqrt(ax * ax + ay * ay + az * az)
+
+          assert_in_delta bx, ax / len, 1.0e-6
+          assert_in_delta by, ay / len, 1.0e-6
+          assert_in_delta bz, az / len, 1.0e-6
+          assert bw == aw
+        end
+      end
+    end
+
+    test "generated tangents on a curved, UV-seamed mesh are unit and orthogonal" do
+      # Suzanne subdivided once: smooth normals and UV islands split at seams
+      path = "thirdparty/ufbx/data/blender_282_suzanne_7400_binary.fbx"
+      {:ok, scene} = Nif.open(path, [])
+      opts = [mesh_format: :render, subdivide: 1, generate_tangents: :mikktspace]
+      {:ok, mesh} = Nif.mesh(scene, 0, opts)
+
+      %{normals: %{offset: normal_offset}, tangents: %{offset: tangent_offset}} = mesh.layout
+      stride = mesh.layout.tangents.stride
+
+      for <<vertex::binary-size(stride) <- mesh.vertices>> do
+        <<_::binary-size(normal_offset), nx::little-float-64, ny::little-float-64,
+          nz::little-float-64, _::binary>> = vertex
+
+        <<_::binary-size(tangent_offset), tx::little-float-64, ty::little-float-64,
+          tz::little-float-64, w::little-float-64, _::binary>> = vertex
+
+        normal_length = :math.sqrt(nx * nx + ny * ny + nz * nz)
+        assert_in_delta tx * tx + ty * ty + tz * tz, 1.0, 1.0e-5
+        assert_in_delta (nx * tx + ny * ty + nz * tz) / normal_length, 0.0, 1.0e-5
+        assert w in [1.0, -1.0]
+      end
+    end
+
+    test "subdivide: :render applies the authored subdivision levels" do
+      path = "thirdparty/ufbx/data/blender_293x_subsurf_max_crease_7400_binary.fbx"
+      {:ok, scene} = Nif.open(path, [])
+      {:ok, plain} = Nif.mesh(scene, 0, mesh_format: :render)
+      {:ok, mesh} = Nif.mesh(scene, 0, mesh_format: :render, subdivide: :render)
+
+      # A single quad subdivided twice
+      assert plain.layout.indices.count == 2 * 3
+      assert mesh.layout.indices.count == 32 * 3
+      assert mesh.layout.vertices.count == 25
+    end
+
+    test "skinned meshes carry joint buffers per render vertex" do
+      path = "thirdparty/ufbx/data/maya_kenney_character_7700_binary.fbx"
+      {:ok, scene} = Nif.open(path, [])
+      {:ok, mesh} = Nif.mesh(scene, 0, mesh_format: :render, quantize: true, max_influences: 4)
+      %{skin: skin} = mesh
+
+      count = mesh.layout.vertices.count
+      assert %{type: :u8, components: 4, count: ^count} = skin.layout.joint_indices
+      assert %{type: :unorm8, components: 4, count: ^count} = skin.layout.weights
+      assert %{components: 16, count: joints} = skin.layout.inverse_bind_matrices
+      assert length(skin.joints) == joints
+
+      for <<a, b, c, d <- skin.weights>> do
+        assert a + b + c + d == 255
+        assert a >= b and b >= c and c >= d
+      end
+
+      assert Enum.all?(:binary.bin_to_list(skin.joint_indices), &(&1 < joints))
+    end
+
+    test "lods adds simplified index buffers over the same vertices" do
+      path = "thirdparty/ufbx/data/maya_kenney_character_7700_binary.fbx"
+      {:ok, scene} = Nif.open(path, [])
+      {:ok, mesh} = Nif.mesh(scene, 0, mesh_format: :render, lods: [0.25, 0.5])
+
+      triangles = div(mesh.layout.indices.count, 3)
+      assert [%{ratio: 0.5} = half, %{ratio: 0.25} = quarter] = mesh.lods
+
+      for lod <- [half, quarter] do
+        assert div(lod.layout.indices.count, 3) <= lod.ratio * triangles
+        assert lod.error >= 0.0
+
+        indices = for <<i::little-16 <- lod.indices>>, do: i
+        assert Enum.all?(indices, &(&1 < mesh.layout.vertices.count))
+      end
+
+      assert quarter.error >= half.error
+    end
+  end
+
+  describe "load_fbx/2 with NURBS geometry" do
+    test "tessellates surfaces into meshes at the requested span subdivision" do
+      path = "thirdparty/ufbx/data/maya_nurbs_surface_plane_7500_binary.fbx"
+      {:ok, data} = Nif.load_fbx(path, mesh_format: :render)
+      {:ok, coarse} = Nif.load_fbx(path, mesh_format: :render, span_subdivision: 2)
+
+      assert [%{id: 0, layout: %{indices: %{count: count}}}] = data.nurbs_surfaces
+      assert [%{layout: %{indices: %{count: coarse_count}}}] = coarse.nurbs_surfaces
+      assert coarse_count < count
+      assert Enum.any?(data.nodes, &(&1[:nurbs_surface_id] == 0))
+    end
+
+    test "tessellates curves into polylines" do
+      path = "thirdparty/ufbx/data/maya_nurbs_curve_form_7700_binary.fbx"
+      {:ok, data} = Nif.load_fbx(path, [])
+
+      assert [_, _, _] = data.nurbs_curves
+
+      for curve <- data.nurbs_curves do
+        %{positions: %{count: count}, indices: %{type: :u32}} = curve.layout
+        assert byte_size(curve.positions) == count * 3 * 8
+
+        indices = for <<i::little-32 <- curve.indices>>, do: i
+        assert Enum.all?(indices, &(&1 < count))
+      end
+    end
+
+    test "reports invalid NURBS geometry as an error entry" do
+      path = "thirdparty/ufbx/data/synthetic_nurbs_invalid_7700_ascii.fbx"
+      {:ok, data} = Nif.load_fbx(path, mesh_format: :render)
+
+      assert [%{id: 0, error: reason}] = data.nurbs_surfaces
+      assert is_binary(reason)
+      assert [%{id: 0, error: ^reason}] = data.nurbs_curves
+
+      assert {:ok, %{meshes: []}} = AriaFbx.Parser.from_ufbx_scene(data)
+    end
+  end
+
+  describe "anim_stack/3 with animation_format: :channels" do
+    test "returns one columnar channel per baked node" do
+      {:ok, scene} = Nif.open("thirdparty/ufbx/data/max2009_cube_anim_5800_ascii.fbx", [])
+      {:ok, %{channels: [channel | _]}} = Nif.anim_stack(scene, 0, animation_format: :channels)
+
+      count = div(byte_size(channel.times), 8)
+      assert count > 1
+      assert byte_size(channel.translation) == count * 3 * 8
+      assert byte_size(channel.rotation) == count * 4 * 8
+      assert byte_size(channel.scale) == count * 3 * 8
+    end
+
+    test "load_fbx/2 bakes only the selected stacks" do
+      path = "thirdparty/ufbx/data/max2009_cube_anim_5800_ascii.fbx"
+
+      assert {:ok, %{animations: []}} = Nif.load_fbx(path, anim_stacks: :none)
+      assert {:ok, %{animations: []}} = Nif.load_fbx(path, anim_stacks: [5])
+      assert {:ok, %{animations: [_]}} = Nif.load_fbx(path, anim_stacks: [0])
+    end
+  end
+
+  describe "evaluate_skinning/5" do
+    test "returns frame-major skinned buffers for a range of frames" do
+      {:ok, scene} = Nif.open(@sausage_fbx, [])
+      {:ok, skinned} = Nif.evaluate_skinning(scene, 0, 0, 0..4, precision: :f32)
+
+      assert byte_size(skinned.times) == 5 * 8
+      %{positions: %{type: :f32, count: count}} = skinned.layout
+      assert byte_size(skinned.positions) == 5 * count * 3 * 4
+      assert byte_size(skinned.normals) == 5 * skinned.layout.normals.count * 3 * 4
+    end
+
+    test "render meshes skin the vertices returned by mesh/3" do
+      {:ok, scene} = Nif.open(@sausage_fbx, [])
+      opts = [mesh_format: :render, optimize: true]
+      {:ok, mesh} = Nif.mesh(scene, 0, opts)
+      {:ok, skinned} = Nif.evaluate_skinning(scene, 0, 0, [0.0, 0.5], opts)
+
+      assert skinned.layout.positions.count == mesh.layout.vertices.count
+      assert byte_size(skinned.positions) == 2 * mesh.layout.vertices.count * 3 * 8
+    end
+
+    test "returns not_found for out of range indices" do
+      {:ok, scene} = Nif.open(@sausage_fbx, [])
+
+      assert {:error, :not_found} = Nif.evaluate_skinning(scene, 5, 0, [0.0])
+      assert {:error, :not_found} = Nif.evaluate_skinning(scene, 0, 5, [0.0])
+    end
+
+    test "rejects ranges with too many frames" do
+      {:ok, scene} = Nif.open(@sausage_fbx, [])
+
+      assert {:error, "too many frames"} =
+               Nif.evaluate_skinning(scene, 0, 0, 0..2_305_843_009_213_693_952)
+
+      {min, max} = {-9_223_372_036_854_775_808, 9_223_372_036_854_775_807}
+      assert {:error, "too many frames"} = Nif.evaluate_skinning(scene, 0, 0, min..max)
+
+      assert {:ok, _} = Nif.evaluate_skinning(scene, 0, 0, 0..16_383//4096)
+    end
+  end
+
+  describe "blend shapes" do
+    test "mesh/3 returns sparse offsets per channel" do
+      {:ok, scene} = Nif.open(@blend_fbx, [])
+      {:ok, mesh} = Nif.mesh(scene, 0, mesh_format: :packed)
+
+      assert [_, _] = mesh.blend_channels
+
+      for channel <- mesh.blend_channels, shape <- channel.shapes do
+        %{vertex_indices: %{type: :u32, count: count}} = shape.layout
+        assert byte_size(shape.position_offsets) == count * 3 * 4
+
+        indices = for <<i::little-32 <- shape.vertex_indices>>, do: i
+        assert Enum.all?(indices, &(&1 < mesh.layout.positions.count))
+      end
+    end
+
+    test "evaluate_blend/3 moves vertices by the weighted offsets" do
+      {:ok, scene} = Nif.open(@blend_fbx, [])
+      {:ok, mesh} = Nif.mesh(scene, 0, mesh_format: :packed, precision: :f32)
+
+      assert {:ok, %{positions: base}} = Nif.evaluate_blend(scene, 0, [])
+      assert base == mesh.positions
+
+      assert {:ok, %{positions: moved}} = Nif.evaluate_blend(scene, 0, [1.0, 0.5])
+      assert byte_size(moved) == byte_size(base)
+      assert moved != base
+
+      assert {:ok, %{positions: ^moved}} =
+               Nif.evaluate_blend(scene, 0, <<1.0::little-float-32, 0.5::little-float-32>>)
+    end
+  end
+
+  describe "bake_vertex_animation/4" do
+    test "bakes one texture row per frame over the render vertices" do
+      {:ok, scene} = Nif.open(@morph_fbx, [])
+      {:ok, mesh} = Nif.mesh(scene, 0, mesh_format: :render)
+      {:ok, vat} = Nif.bake_vertex_animation(scene, 0, 0)
+
+      width = mesh.layout.vertices.count
+      assert %{type: :f16, width: ^width, height: frames} = vat.layout.positions
+      assert frames == div(byte_size(vat.times), 8)
+      assert byte_size(vat.positions) == frames * width * 4 * 2
+      assert byte_size(vat.normals) == byte_size(vat.positions)
+    end
+
+    test "normalize remaps positions into the returned bounds" do
+      {:ok, scene} = Nif.open(@morph_fbx, [])
+      {:ok, vat} =
+        Nif.bake_vertex_animation(scene, 0, 0, texture_format: :rgba32f, normalize: true)
+
+      assert %{type: :f32} = vat.layout.positions
+      assert Enum.zip_with(vat.min, vat.max, &(&1 <= &2)) |> Enum.all?()
+
+      for <<texel::binary-size(16) <- vat.positions>> do
+        <<x::little-float-32, y::little-float-32, z::little-float-32, w::little-float-32>> = texel
+        assert Enum.all?([x, y, z], &(&1 >= 0.0 and &1 <= 1.0))
+        assert w == 1.0
+      end
+    end
+
+    test "rejects invalid frame rates and oversized bakes" do
+      {:ok, scene} = Nif.open(@morph_fbx, [])
+
+      assert {:error, "invalid frame rate"} =
+               Nif.bake_vertex_animation(scene, 0, 0, frame_rate: 0)
+      assert {:error, "invalid frame rate"} =
+               Nif.bake_vertex_animation(scene, 0, 0, frame_rate: -24.0)
+      assert {:error, "too many frames"} =
+               Nif.bake_vertex_animation(scene, 0, 0, frame_rate: 1.0e300)
+    end
+  end
+
+  describe "geometry caches" do
+    test "reads single frames and samples from a cache file" do
+      {:ok, cache} = Nif.open_geometry_cache(@pc2_cache)
+      {:ok, %{channels: [channel]}} = Nif.geometry_cache_info(cache)
+
+      %{point_count: points, layout: %{times: %{count: frames}}} = channel
+      assert frames > 1
+
+      {:ok, frame} = Nif.read_geometry_cache_frame(cache, 0, 1, precision: :f32)
+      assert byte_size(frame.data) == points * 3 * 4
+      assert %{type: :f32, count: ^points} = frame.layout.data
+
+      # Sampling exactly at a stored frame returns that frame
+      assert {:ok, %{data: data}} =
+               Nif.sample_geometry_cache(cache, 0, frame.time, precision: :f32)
+      assert data == frame.data
+
+      assert {:error, :not_found} = Nif.read_geometry_cache_frame(cache, 0, frames)
+    end
+
+    test "scenes expose their cache deformers" do
+      path = "thirdparty/ufbx/data/maya_cache_sine_7500_binary.fbx"
+      {:ok, scene} = Nif.open(path, load_external_files: true)
+      {:ok, mesh} = Nif.mesh(scene, 0)
+
+      assert [%{id: id, file_path: file_path} | _] = mesh.cache_deformers
+      assert file_path != ""
+      assert {:ok, cache} = Nif.geometry_cache(scene, id)
+      assert {:ok, %{channels: [_ | _]}} = Nif.geometry_cache_info(cache)
+
+      {:ok, plain} = Nif.open(path, [])
+      assert {:error, :not_found} = Nif.geometry_cache(plain, id)
+    end
+  end
+
   describe "write_fbx/3" do
     test "writes a minimal FBX file with a single mesh" do
       {:ok, temp_file} = Briefly.create(extname: ".fbx")
@@ -237,4 +736,139 @@ defmodule AriaFbx.NifTest do
       end
     end
   end
+
+  describe "write_fbx_binary/2" do
+    test "returns the same bytes write_fbx/3 puts on disk" do
+      {:ok, temp_file} = Briefly.create(extname: ".fbx")
+
+      # A fixed creation_time keeps the timestamp fields from differing
+      # between the two saves
+      scene_data = %{
+        creation_time: ~N[2025-01-01 00:00:00],
+        meshes: [
+          %{
+            id: 1,
+            name: "Tri",
+            positions: [0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0, 0.0],
+            indices: [0, 1, 2]
+          }
+        ]
+      }
+
+      assert {:ok, _} = Nif.write_fbx(temp_file, scene_data, :binary)
+      assert {:ok, iodata} = Nif.write_fbx_binary(scene_data, :binary)
+      assert IO.iodata_to_binary(iodata) == File.read!(temp_file)
+      assert {:ok, _scene} = Nif.load_fbx_binary(IO.iodata_to_binary(iodata))
+    end
+
+    test "reads and returns the atom keys interned at load" do
+      scene_data = %{
+        nodes: [%{id: 1, name: "Root", mesh_id: 2}],
+        meshes: [
+          %{
+            id: 2,
+            name: "Tri",
+            positions: [0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0, 0.0],
+            indices: [0, 1, 2]
+          }
+        ]
+      }
+
+      {:ok, iodata} = Nif.write_fbx_binary(scene_data, :binary)
+      {:ok, loaded} = Nif.load_fbx_binary(IO.iodata_to_binary(iodata))
+
+      assert [%{name: "Tri", positions: [_, _, _]}] = loaded.meshes
+      assert %{mesh_id: mesh_id} = Enum.find(loaded.nodes, &(&1.name == "Root"))
+      assert is_integer(mesh_id)
+
+      # Only atom keys are read; string keys are not looked up
+      {:ok, iodata} = Nif.write_fbx_binary(%{"meshes" => scene_data.meshes}, :binary)
+      assert {:ok, %{meshes: []}} = Nif.load_fbx_binary(IO.iodata_to_binary(iodata))
+    end
+
+    test "resolves sparse, unordered and colliding ids declared after their users" do
+      tri = [0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0, 0.0]
+      mesh = fn id, name -> %{id: id, name: name, positions: tri, indices: [0, 1, 2]} end
+
+      # Node ids 103, 7, 71, 39 and mesh ids 70, 38 all start probing at the
+      # same writer id-table slot; mesh 7 shares its number with a node.
+      # Children are listed before their parents.
+      scene_data = %{
+        nodes: [
+          %{id: 39, name: "Leaf", parent_id: 71, mesh_id: 7},
+          %{id: 71, name: "Arm", parent_id: 103, mesh_id: 38},
+          %{id: 103, name: "Body", parent_id: 7, mesh_id: 70},
+          %{id: 7, name: "Root"}
+        ],
+        meshes: [mesh.(38, "ArmMesh"), mesh.(7, "LeafMesh"), mesh.(70, "BodyMesh")]
+      }
+
+      {:ok, iodata} = Nif.write_fbx_binary(scene_data, :binary)
+      {:ok, loaded} = Nif.load_fbx_binary(IO.iodata_to_binary(iodata))
+
+      nodes = Map.new(loaded.nodes, &{&1.id, &1})
+      meshes = Map.new(loaded.meshes, &{&1.id, &1.name})
+      by_name = Map.new(loaded.nodes, &{&1.name, &1})
+
+      expected = [
+        {"Leaf", "Arm", "LeafMesh"},
+        {"Arm", "Body", "ArmMesh"},
+        {"Body", "Root", "BodyMesh"}
+      ]
+
+      for {child, parent, mesh_name} <- expected do
+        node = by_name[child]
+        assert nodes[node.parent_id].name == parent
+        assert meshes[node.mesh_id] == mesh_name
+      end
+
+      refute Map.has_key?(by_name["Root"], :mesh_id)
+    end
+
+    test "accepts packed binaries for mesh attributes" do
+      positions = [0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0, 0.0]
+      list_mesh = %{id: 1, name: "Tri", positions: positions, indices: [0, 1, 2]}
+
+      packed_mesh = %{
+        list_mesh
+        | positions: for(v <- positions, into: <<>>, do: <<v::little-float-32>>),
+          indices: <<0::little-32, 1::little-32, 2::little-32>>
+      }
+
+      packed_mesh = Map.put(packed_mesh, :layout, %{positions: %{type: :f32}})
+
+      # Fixed timestamp, so the two saves can only differ in mesh data
+      creation_time = ~N[2025-01-01 00:00:00]
+      from_lists = %{creation_time: creation_time, meshes: [list_mesh]}
+      from_binaries = %{creation_time: creation_time, meshes: [packed_mesh]}
+
+      assert {:ok, from_lists} = Nif.write_fbx_binary(from_lists, :binary)
+      assert {:ok, from_binaries} = Nif.write_fbx_binary(from_binaries, :binary)
+      assert IO.iodata_to_binary(from_lists) == IO.iodata_to_binary(from_binaries)
+    end
+  end
+
+  # Tangents of an f64 render mesh as {x, y, z, w} tuples
+  defp tangents(%{vertices: vertices, layout: %{tangents: %{offset: offset, stride: stride}}}) do
+    for <<_::binary-size(offset), x::little-float-64, y::little-float-64, z::little-float-64,
+          w::little-float-64, _::binary-size(stride - offset - 32) <- vertices>>,
+        do: {x, y, z, w}
+  end
+
+  # Load options are only read when the NIF library is loaded, so run the call
+  # in a fresh peer VM that loads AriaFbx.Nif with `env` already set
+  defp call_with_load_env(env, fun, args) do
+    code_paths = Enum.flat_map(:code.get_path(), &[~c"-pa", &1])
+    {:ok, peer} = :peer.start_link(%{connection: :standard_io, args: code_paths})
+
+    try do
+      for {key, value} <- env do
+        :ok = :peer.call(peer, Application, :put_env, [:aria_fbx, key, value, [persistent: true]])
+      end
+
+      :peer.call(peer, Nif, fun, args, 60_000)
+    after
+      :peer.stop(peer)
+    end
+  end
 end